@@ -0,0 +1,122 @@
+#ifndef CHISEL_CLIENT_LATENCY_HISTOGRAM_H
+#define CHISEL_CLIENT_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace chisel {
+
+/**
+ * @brief HDR-style log-linear histogram of non-negative integer values
+ * (microseconds in practice).
+ *
+ * Values below SUB_BUCKETS are exact, above that every power of two is split
+ * into SUB_BUCKETS / 2 linear slots, so any recorded value is reported within
+ * 1/64 (~1.6%) of itself over the whole 64-bit range in a fixed ~30 KiB.
+ *
+ * Not thread-safe by design: give each worker its own and `merge` at the end.
+ *
+ * Rule of zero.
+ */
+class LatencyHistogram {
+public:
+  // NOLINTNEXTLINE
+  static constexpr std::uint64_t SUB_BUCKETS = 128;
+  // NOLINTNEXTLINE
+  static constexpr std::size_t BUCKETS =
+      SUB_BUCKETS + ((64 - 7) * (SUB_BUCKETS / 2));
+
+  void record(std::uint64_t value) noexcept {
+    ++m_counts[index_of(value)];
+    ++m_total;
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+    m_sum += static_cast<double>(value);
+  }
+
+  void merge(const LatencyHistogram &other) noexcept {
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+      m_counts[i] += other.m_counts[i];
+    }
+    m_total += other.m_total;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+  }
+
+  [[nodiscard]] std::uint64_t count() const noexcept { return m_total; }
+  [[nodiscard]] std::uint64_t min() const noexcept {
+    return m_total == 0 ? 0 : m_min;
+  }
+  [[nodiscard]] std::uint64_t max() const noexcept { return m_max; }
+  [[nodiscard]] double mean() const noexcept {
+    return m_total == 0 ? 0.0 : m_sum / static_cast<double>(m_total);
+  }
+
+  /**
+   * @param quantile in [0, 1]
+   * @return highest value equivalent to the bucket holding that rank,
+   * clamped to the recorded max
+   */
+  [[nodiscard]] std::uint64_t percentile(double quantile) const noexcept {
+    if (m_total == 0) {
+      return 0;
+    }
+    const double clamped = std::clamp(quantile, 0.0, 1.0);
+    const auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(
+               clamped * static_cast<double>(m_total) + 0.5));
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+      seen += m_counts[i];
+      if (seen >= rank) {
+        return std::min(highest_equivalent(i), m_max);
+      }
+    }
+    return m_max;
+  }
+
+  [[nodiscard]] static constexpr std::size_t
+  index_of(std::uint64_t value) noexcept {
+    if (value < SUB_BUCKETS) {
+      return static_cast<std::size_t>(value);
+    }
+    // shift so the top 7 bits remain, i.e. (value >> shift) in [64, 128)
+    const auto shift = static_cast<unsigned>(std::bit_width(value)) - 7U;
+    const auto slot = (value >> shift) - (SUB_BUCKETS / 2);
+    return static_cast<std::size_t>(SUB_BUCKETS +
+                                    ((shift - 1) * (SUB_BUCKETS / 2)) + slot);
+  }
+
+  [[nodiscard]] static constexpr std::uint64_t
+  highest_equivalent(std::size_t index) noexcept {
+    if (index < SUB_BUCKETS) {
+      return index;
+    }
+    const std::uint64_t above = index - SUB_BUCKETS;
+    const std::uint64_t shift = (above / (SUB_BUCKETS / 2)) + 1;
+    const std::uint64_t slot = (above % (SUB_BUCKETS / 2)) + (SUB_BUCKETS / 2);
+    const std::uint64_t low = slot << shift;
+    const std::uint64_t width = std::uint64_t{1} << shift;
+    if (low > std::numeric_limits<std::uint64_t>::max() - width) {
+      return std::numeric_limits<std::uint64_t>::max();
+    }
+    return low + width - 1;
+  }
+
+private:
+  std::array<std::uint64_t, BUCKETS> m_counts{};
+  std::uint64_t m_total = 0;
+  std::uint64_t m_min = std::numeric_limits<std::uint64_t>::max();
+  std::uint64_t m_max = 0;
+  double m_sum = 0.0;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_CLIENT_LATENCY_HISTOGRAM_H
@@ -0,0 +1,27 @@
+#ifndef CHISEL_ENGINE_BAR_H
+#define CHISEL_ENGINE_BAR_H
+
+#include <cstdint>
+
+namespace chisel {
+
+/**
+ * Rule of zero - one aggregate bar, the unit the engine steps over.
+ *
+ * Trivially copyable and 64 bytes, so a series is one contiguous array that
+ * streams through the cache a line per bar.
+ */
+struct Bar {
+  std::int64_t t;
+  double open;
+  double high;
+  double low;
+  double close;
+  double volume;
+  double vwap;
+  std::int64_t transactions;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_ENGINE_BAR_H
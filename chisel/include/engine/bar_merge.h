@@ -0,0 +1,96 @@
+#ifndef CHISEL_ENGINE_BAR_MERGE_H
+#define CHISEL_ENGINE_BAR_MERGE_H
+
+#include "engine/bar.h"
+#include "engine/order.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace chisel {
+
+/// one symbol's bar within a same-timestamp batch
+struct SymbolBar {
+  SymbolId symbol;
+  // position of `bar` in its own series
+  std::uint32_t index;
+  const Bar *bar;
+};
+
+/**
+ * @brief K-way merge of per-symbol bar series into timestamp order, handed
+ * out one timestamp at a time.
+ *
+ * Each symbol's next timestamp sits in one flat array. While batches are
+ * wide, as with symbols sharing a bar grid, a batch is one linear pass over
+ * that array that also finds the next timestamp, so a bar costs a fraction
+ * of a comparison. When batches turn sparse relative to the symbol count the
+ * merge switches to a binary heap of 16-byte {t, symbol} keys, one
+ * sift-down per bar, and back again once they widen.
+ *
+ * Either way bars come out ordered by (t, symbol): a batch lists its symbols
+ * in ascending order, and symbols with no bar at that timestamp are absent.
+ *
+ * The series are borrowed and must outlive the merge; each must be strictly
+ * increasing in `t`.
+ *
+ * Rule of zero.
+ */
+class BarMerge {
+public:
+  /// symbol i is series[i]; throws std::invalid_argument on unordered bars
+  explicit BarMerge(std::vector<std::span<const Bar>> series);
+
+  /// rewinds every series to its first bar
+  void reset();
+
+  /// the next timestamp's bars, empty once every series is drained
+  [[nodiscard]] std::span<const SymbolBar> next();
+
+  [[nodiscard]] std::size_t symbols() const noexcept {
+    return m_series.size();
+  }
+
+  /// `symbol`'s bars up to and including the last one handed out
+  [[nodiscard]] std::span<const Bar> history(SymbolId symbol) const noexcept {
+    return m_series[symbol].first(m_cursors[symbol]);
+  }
+
+  /// whether the last batch came off the heap rather than a scan
+  [[nodiscard]] bool heap_mode() const noexcept { return m_heap_mode; }
+
+private:
+  struct Key {
+    std::int64_t t;
+    SymbolId symbol;
+  };
+
+  static bool before(const Key &a, const Key &b) noexcept {
+    return a.t < b.t || (a.t == b.t && a.symbol < b.symbol);
+  }
+
+  /// hands out `symbol`'s next bar and moves its cursor on
+  void take(SymbolId symbol);
+  void scan();
+  void pop();
+  /// picks scan or heap from the batch widths of the last window
+  void adapt();
+  /// places `key` at `at` or below, keeping the heap ordered
+  void sift_down(std::size_t at, Key key) noexcept;
+
+  std::vector<std::span<const Bar>> m_series;
+  std::vector<std::uint32_t> m_cursors;
+  // each symbol's next timestamp, DRAINED past its last bar
+  std::vector<std::int64_t> m_next;
+  std::vector<Key> m_heap;
+  std::vector<SymbolBar> m_batch;
+  std::int64_t m_t = 0;
+  bool m_heap_mode = false;
+  std::size_t m_window_bars = 0;
+  std::size_t m_window_batches = 0;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_ENGINE_BAR_MERGE_H
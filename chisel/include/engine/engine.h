@@ -1,14 +1,220 @@
 #ifndef CHISEL_ENGINE_ENGINE_H
 #define CHISEL_ENGINE_ENGINE_H
 
+#include "engine/account.h"
+#include "engine/bar.h"
+#include "engine/execution_model.h"
+#include "engine/metrics.h"
+#include "engine/order.h"
+#include "engine/snapshot.h"
+#include "strategy/i_strategy.h"
+#include "strategy/strategy.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+
 namespace chisel {
 
-class BacktestEngine {
+// NOLINTNEXTLINE
+inline constexpr std::uint64_t STOP_CHECK_STEPS = 1024;
+
+struct EngineConfig {
+  double starting_cash = 100'000.0;
+  // snapshots handed to the sink at a time, 0 records none
+  std::size_t snapshot_batch = 0;
+  // which steps are recorded when snapshot_batch is set
+  SnapshotSampling sampling{};
+  // steps a year, annualizes the Sharpe ratio; US regular-hours minutes
+  double periods_per_year = 252.0 * 390.0;
+};
+
+struct RunStats {
+  std::uint64_t steps = 0;
+  std::uint64_t orders = 0;
+  // placed but never queued, a symbol already had MAX_ORDERS_PER_BAR waiting
+  std::uint64_t dropped_orders = 0;
+  std::uint64_t fills = 0;
+  double final_equity = 0.0;
+  RunMetrics metrics;
+};
+
+/**
+ * @brief Everything in a backtest but the strategy and fill model: account,
+ * pending orders, fills and snapshot batching, shared by every
+ * BacktestEngine<S, E>.
+ *
+ * Rule of 5: non-copyable, non-movable (engines hand out references to its
+ * account).
+ */
+class BacktestEngineBase {
 public:
-  BacktestEngine();
-  ~BacktestEngine();
+  using snapshot_sink = std::function<void(std::span<const Snapshot>)>;
+  /// true once the run should end early
+  using stop_check = std::function<bool()>;
+
+  BacktestEngineBase(BacktestEngineBase &&) noexcept = delete;
+  BacktestEngineBase &operator=(BacktestEngineBase &&) noexcept = delete;
+
+  BacktestEngineBase(const BacktestEngineBase &) = delete;
+  BacktestEngineBase &operator=(const BacktestEngineBase &) = delete;
+
+  void on_snapshots(snapshot_sink sink) { m_sink = std::move(sink); }
+
+  /// polled every STOP_CHECK_STEPS steps; a stopped run reports the steps it
+  /// got through
+  void stop_when(stop_check check) { m_stop = std::move(check); }
+
+  [[nodiscard]] const Account &account() const noexcept { return m_account; }
+
+protected:
+  explicit BacktestEngineBase(EngineConfig config);
+  ~BacktestEngineBase();
+
+  void begin_run();
+
+  /// fills the orders still pending, keeps what the bar couldn't fill, then
+  /// marks the account
+  template <execution_model_c E>
+  void execute(const E &execution, const Bar &bar, std::uint64_t step) {
+    m_fills.clear();
+    m_pending.retain([&](Order &order) {
+      Fill fill{};
+      if (execution.fill(order, bar, step, fill)) {
+        book(fill);
+        m_fills.push(fill);
+        order.quantity -= fill.quantity;
+      }
+      return order.quantity > 0;
+    });
+    m_account.mark(0, bar.close);
+    m_metrics.on_step(static_cast<double>(m_account.equity_fixed()));
+  }
+
+  /// queues `placed`, each cancelling opposite pending orders first
+  /// @return how many didn't fit
+  std::size_t place(const OrderBuffer &placed) noexcept {
+    std::size_t dropped = 0;
+    for (const Order &order : placed) {
+      cancel_opposite(m_pending, order);
+      dropped += m_pending.push(order) ? 0U : 1U;
+    }
+    return dropped;
+  }
+
+  /// applies `fill`, tallying it as a trade if it closed anything
+  void book(const Fill &fill) noexcept {
+    const Booked booked = m_account.apply(fill);
+    if (booked.closed != 0) {
+      m_metrics.on_trade(from_fixed(booked.realized));
+    }
+  }
+
+  /// records the step if snapshots are on and the sampler keeps it
+  void sample(std::uint64_t step, const Bar &bar, Action action,
+              std::span<const double> indicators) {
+    if (m_config.snapshot_batch != 0 &&
+        m_sampler.keep(step, bar.t,
+                       action != Action::hold || !m_fills.empty())) {
+      record(step, bar, action, indicators);
+    }
+  }
+
+  [[nodiscard]] bool stop_requested(std::uint64_t step) const {
+    return step % STOP_CHECK_STEPS == 0 && m_stop && m_stop();
+  }
+
+  void record(std::uint64_t step, const Bar &bar, Action action,
+              std::span<const double> indicators);
+  void flush_snapshots();
+
+  EngineConfig m_config;
+  Account m_account;
+  RunMetrics m_metrics;
+  OrderBuffer m_pending;
+  // what the strategy placed this step, before it joins m_pending
+  OrderBuffer m_placed;
+  FillBuffer m_fills;
+
+private:
+  std::vector<Snapshot> m_snapshots;
+  SnapshotSampler m_sampler;
+  snapshot_sink m_sink;
+  stop_check m_stop;
 };
 
+/**
+ * @brief Replays a bar series through a strategy, execution model and
+ * account.
+ *
+ * Each step fills the orders placed on the previous bar, marks the account,
+ * then asks the strategy for new orders. An order the execution model only
+ * partly fills keeps its remainder pending for the next bar; strategies don't
+ * see pending orders, so a new order cancels whatever is left of pending ones
+ * on the other side (an exit drops the unfilled rest of its entry). Order,
+ * fill and snapshot storage is sized once at construction, so a run does no
+ * heap allocation per step; snapshots go to the sink a full batch at a time.
+ *
+ * `S` is the strategy's own type where it is known, so its on_bar inlines
+ * into the loop, or IStrategy for one picked at runtime. `E` is the fill
+ * model's type, inlined the same way.
+ *
+ * Rule of 5: non-copyable, non-movable (holds references to its parts).
+ */
+template <strategy_c S, execution_model_c E = ExecutionModel>
+class BacktestEngine : public BacktestEngineBase {
+public:
+  BacktestEngine(EngineConfig config, S &strategy, const E &execution)
+      : BacktestEngineBase(config), m_strategy(strategy),
+        m_execution(execution) {}
+
+  /// starts from `EngineConfig::starting_cash` and a reset strategy, ends
+  /// early if the stop check says so
+  RunStats run(std::span<const Bar> bars) {
+    begin_run();
+    m_strategy.reset();
+
+    RunStats stats;
+    std::size_t i = 0;
+    for (; i < bars.size(); ++i) {
+      const Bar &bar = bars[i];
+      const auto step = static_cast<std::uint64_t>(i);
+      if (stop_requested(step)) {
+        break;
+      }
+
+      // orders from the previous bar execute against this one
+      execute(m_execution, bar, step);
+      m_placed.clear();
+      const Action action = m_strategy.on_bar(
+          BarContext{.step = step,
+                     .history = bars.first(i + 1),
+                     .account = m_account},
+          m_placed);
+      stats.dropped_orders += place(m_placed);
+
+      stats.fills += m_fills.size();
+      stats.orders += m_placed.size();
+      sample(step, bar, action, m_strategy.indicator_values());
+    }
+
+    flush_snapshots();
+    stats.steps = i;
+    stats.final_equity = m_account.equity();
+    stats.metrics = m_metrics;
+    return stats;
+  }
+
+private:
+  S &m_strategy;
+  const E &m_execution;
+};
+
+/// the engine for strategies chosen by name, see make_strategy()
+using DynamicBacktestEngine = BacktestEngine<IStrategy>;
+
 } // namespace chisel
 
 #endif // CHISEL_ENGINE_ENGINE_H
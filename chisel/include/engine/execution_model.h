@@ -1,14 +1,189 @@
 #ifndef CHISEL_ENGINE_EXECUTION_MODEL_H
 #define CHISEL_ENGINE_EXECUTION_MODEL_H
 
+#include "engine/bar.h"
+#include "engine/order.h"
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+
 namespace chisel {
 
-class ExecutionModel {
+// NOLINTNEXTLINE
+inline constexpr double BPS = 1e-4;
+
+/**
+ * What the engines fill orders through. fill() writes the execution of
+ * `order` on `bar` into `out` and returns true, or returns false and leaves
+ * `out` alone when nothing fills on this bar. A fill for less than the
+ * order's quantity leaves the rest pending for the symbol's next bar.
+ *
+ * Engines take the model's own type, so a fill is an inlined call.
+ */
+template <typename E>
+concept execution_model_c =
+    requires(const E &model, const Order &order, const Bar &bar,
+             std::uint64_t step, Fill &out) {
+      { model.fill(order, bar, step, out) } -> std::same_as<bool>;
+    };
+
+// Reference prices, the bar's price an order would fill at for free. The
+// engines execute an order on the bar after the one it was placed on.
+
+/// the open
+struct AtOpen {
+  [[nodiscard]] double price(const Bar &bar) const noexcept {
+    return bar.open;
+  }
+};
+
+/// the close
+struct AtClose {
+  [[nodiscard]] double price(const Bar &bar) const noexcept {
+    return bar.close;
+  }
+};
+
+/// the bar's VWAP, its typical price for bars that don't carry one
+struct AtVwap {
+  [[nodiscard]] double price(const Bar &bar) const noexcept {
+    const double typical = (bar.high + bar.low + bar.close) / 3.0;
+    return bar.vwap > 0.0 ? bar.vwap : typical;
+  }
+};
+
+// Slippage, signed by `direction` (+1 buying, -1 selling) so it always moves
+// the price against the trader.
+
+/// a fixed fraction of the reference price
+struct BpsSlippage {
+  double bps = 0.0;
+
+  [[nodiscard]] double slippage(const Bar & /*bar*/, double reference,
+                                double direction) const noexcept {
+    return direction * reference * (bps * BPS);
+  }
+};
+
+/**
+ * A fraction of the bar's high-low range, a stand-in for half the spread
+ * when no quotes are at hand: wide bars cost more to cross.
+ */
+struct RangeSlippage {
+  double fraction = 0.5;
+
+  [[nodiscard]] double slippage(const Bar &bar, double /*reference*/,
+                                double direction) const noexcept {
+    return direction * fraction * (bar.high - bar.low);
+  }
+};
+
+// Sizes, how much of an order a bar can absorb.
+
+/// all of it
+struct FullSize {
+  [[nodiscard]] std::int32_t quantity(const Order &order,
+                                      const Bar & /*bar*/) const noexcept {
+    return order.quantity;
+  }
+};
+
+/**
+ * At most `participation` of the bar's volume, rounded down; the rest waits
+ * for the next bar.
+ */
+struct VolumeCap {
+  double participation = 0.1;
+
+  [[nodiscard]] std::int32_t quantity(const Order &order,
+                                      const Bar &bar) const noexcept {
+    const double cap = std::min(participation * bar.volume,
+                                static_cast<double>(order.quantity));
+    return static_cast<std::int32_t>(std::max(cap, 0.0));
+  }
+};
+
+// Commissions, charged per fill on top of its price.
+
+struct NoCommission {
+  [[nodiscard]] double commission(std::int32_t /*quantity*/,
+                                  double /*price*/) const noexcept {
+    return 0.0;
+  }
+};
+
+/// `per_share` a share, never less than `minimum` a fill
+struct PerShareCommission {
+  double per_share = 0.005;
+  double minimum = 1.0;
+
+  [[nodiscard]] double commission(std::int32_t quantity,
+                                  double /*price*/) const noexcept {
+    return std::max(minimum, per_share * static_cast<double>(quantity));
+  }
+};
+
+/// a fraction of the traded value
+struct BpsCommission {
+  double bps = 0.0;
+
+  [[nodiscard]] double commission(std::int32_t quantity,
+                                  double price) const noexcept {
+    return static_cast<double>(quantity) * price * (bps * BPS);
+  }
+};
+
+/**
+ * @brief A fill model put together from a reference price, slippage, size
+ * and commission policy.
+ *
+ * Every policy is a small value type with one inline, branch-free method, so
+ * the whole fill compiles into the engine's loop as straight-line
+ * arithmetic, with no virtual call or allocation per order.
+ *
+ * Rule of zero.
+ */
+template <typename Price = AtOpen, typename Slippage = BpsSlippage,
+          typename Size = FullSize, typename Fee = NoCommission>
+class FillModel {
 public:
-  ExecutionModel();
-  ~ExecutionModel();
+  explicit FillModel(Slippage slippage = {}, Size size = {}, Fee fee = {},
+                     Price price = {}) noexcept
+      : m_price(price), m_slippage(slippage), m_size(size), m_fee(fee) {}
+
+  /// see execution_model_c
+  bool fill(const Order &order, const Bar &bar, std::uint64_t step,
+            Fill &out) const noexcept {
+    const std::int32_t quantity = m_size.quantity(order, bar);
+    if (quantity <= 0) {
+      return false;
+    }
+    const double direction = order.side == Side::buy ? 1.0 : -1.0;
+    const double reference = m_price.price(bar);
+    const double slippage = m_slippage.slippage(bar, reference, direction);
+    const double price = reference + slippage;
+    out = Fill{.step = step,
+               .symbol = order.symbol,
+               .side = order.side,
+               .quantity = quantity,
+               .price = price,
+               .slippage = slippage,
+               .commission = m_fee.commission(quantity, price)};
+    return true;
+  }
+
+private:
+  [[no_unique_address]] Price m_price;
+  [[no_unique_address]] Slippage m_slippage;
+  [[no_unique_address]] Size m_size;
+  [[no_unique_address]] Fee m_fee;
 };
 
+/// market orders at the next open, moved a fixed number of basis points
+using ExecutionModel = FillModel<>;
+
+static_assert(execution_model_c<ExecutionModel>);
+
 } // namespace chisel
 
 #endif // CHISEL_ENGINE_EXECUTION_MODEL_H
@@ -0,0 +1,35 @@
+#ifndef CHISEL_ENGINE_FIXED_POINT_H
+#define CHISEL_ENGINE_FIXED_POINT_H
+
+#include <cstdint>
+
+namespace chisel {
+
+/**
+ * Money and prices in millionths of a unit. Sums and differences are exact,
+ * so account totals updated a fill at a time never drift from a recount.
+ * An int64 covers about +-9.2 trillion units.
+ */
+using Fixed = std::int64_t;
+
+// NOLINTNEXTLINE
+inline constexpr Fixed FIXED_SCALE = 1'000'000;
+
+/// nearest millionth, halves away from zero as std::llround does
+[[nodiscard]] inline Fixed to_fixed(double value) noexcept {
+  // inline instead of llround's libm call, which cost more than the rest of
+  // marking a bar; `scaled - whole` is exact below 2^52
+  const double scaled = value * static_cast<double>(FIXED_SCALE);
+  const auto whole = static_cast<Fixed>(scaled);
+  const double fraction = scaled - static_cast<double>(whole);
+  return whole + static_cast<Fixed>(fraction >= 0.5) -
+         static_cast<Fixed>(fraction <= -0.5);
+}
+
+[[nodiscard]] inline double from_fixed(Fixed value) noexcept {
+  return static_cast<double>(value) / static_cast<double>(FIXED_SCALE);
+}
+
+} // namespace chisel
+
+#endif // CHISEL_ENGINE_FIXED_POINT_H
@@ -0,0 +1,101 @@
+#ifndef CHISEL_ENGINE_METRICS_H
+#define CHISEL_ENGINE_METRICS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace chisel {
+
+/**
+ * @brief Performance statistics kept in one pass over a run, in constant
+ * memory: no equity curve is stored.
+ *
+ * A step only appends its equity to a small fixed block. Each full block is
+ * folded in: its returns' mean and squared deviations come from two passes
+ * over at most BLOCK values and merge into the running totals with Chan's
+ * update, the blockwise form of Welford's, and a running peak tracks the
+ * drawdown. Variance stays accurate over millions of bars where a sum of
+ * squares would cancel, and the bar loop carries no division. Trades are
+ * fills that closed some of a position, tallied by their realized PnL.
+ *
+ * Every figure but the trade tally is a ratio of equities, so they can come
+ * in any unit; the engines pass their fixed-point equity as is.
+ *
+ * Rule of zero.
+ */
+class RunMetrics {
+public:
+  // NOLINTNEXTLINE
+  static constexpr std::size_t BLOCK = 64;
+
+  /// forgets everything, `equity` is the starting point
+  void reset(double equity) noexcept;
+
+  /// the equity after a step's fills and marks
+  void on_step(double equity) noexcept {
+    m_block[m_pending++] = equity;
+    if (m_pending == BLOCK) {
+      fold();
+    }
+  }
+
+  /// a fill that closed some of a position, `pnl` net of its commission
+  void on_trade(double pnl) noexcept {
+    ++m_trades;
+    m_wins += pnl > 0.0 ? 1U : 0U;
+  }
+
+  /// largest fall from a peak, a fraction of the peak
+  [[nodiscard]] double max_drawdown() const noexcept {
+    return settled().max_drawdown;
+  }
+  [[nodiscard]] std::uint64_t trades() const noexcept { return m_trades; }
+  [[nodiscard]] std::uint64_t wins() const noexcept { return m_wins; }
+  /// wins over closing trades, 0 without any
+  [[nodiscard]] double win_rate() const noexcept {
+    return m_trades == 0 ? 0.0
+                         : static_cast<double>(m_wins) /
+                               static_cast<double>(m_trades);
+  }
+
+  /// step returns so far, skipping steps that start at equity <= 0
+  [[nodiscard]] std::uint64_t returns() const noexcept {
+    return settled().count;
+  }
+  [[nodiscard]] double mean_return() const noexcept {
+    return settled().mean;
+  }
+  /// sample standard deviation of step returns
+  [[nodiscard]] double return_stddev() const noexcept;
+  /// mean over stddev of step returns times sqrt(`periods_per_year`), with
+  /// no risk-free rate; 0 while the returns have no spread
+  [[nodiscard]] double sharpe(double periods_per_year) const noexcept;
+
+private:
+  struct Totals {
+    std::uint64_t count = 0;
+    double mean = 0.0;
+    // sum of squared deviations from the mean
+    double m2 = 0.0;
+    double peak = 0.0;
+    double max_drawdown = 0.0;
+  };
+
+  /// the block's returns and drawdowns, merged into the totals
+  [[gnu::cold, gnu::noinline]] void fold() noexcept;
+  /// totals with the unfolded equities merged in
+  [[nodiscard]] Totals settled() const noexcept;
+
+  Totals m_totals;
+  // equity before m_block[0]
+  double m_last = 0.0;
+  std::array<double, BLOCK> m_block{};
+  std::size_t m_pending = 0;
+  std::uint64_t m_trades = 0;
+  std::uint64_t m_wins = 0;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_ENGINE_METRICS_H
@@ -0,0 +1,109 @@
+#ifndef CHISEL_ENGINE_ORDER_H
+#define CHISEL_ENGINE_ORDER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace chisel {
+
+enum class Side : std::uint8_t { buy, sell };
+
+/// dense index of a traded symbol within one run, 0 for single-symbol runs
+using SymbolId = std::uint32_t;
+
+/// what a strategy decided on a bar, mirrors marble::ActionType
+enum class Action : std::uint8_t { hold, buy, sell };
+
+/// market order, executes against the symbol's next bar; what a bar can't
+/// fill waits for the one after
+struct Order {
+  Side side;
+  std::int32_t quantity;
+  SymbolId symbol = 0;
+};
+
+struct Fill {
+  std::uint64_t step;
+  SymbolId symbol = 0;
+  Side side;
+  std::int32_t quantity;
+  double price;
+  // price minus the model's reference price, signed against the trader
+  double slippage;
+  // charged on top of quantity * price
+  double commission = 0.0;
+};
+
+/**
+ * Fixed-capacity buffer living inside its owner, refilled every step without
+ * touching the heap.
+ *
+ * Rule of zero.
+ */
+template <typename T, std::size_t N> class FixedBuffer {
+public:
+  /// @return false when full, the item is dropped
+  bool push(const T &item) noexcept {
+    if (m_size == N) {
+      return false;
+    }
+    m_items[m_size++] = item;
+    return true;
+  }
+
+  void clear() noexcept { m_size = 0; }
+
+  /// keeps, in order, the items `keep` returns true for; it may modify them
+  template <typename F> void retain(F keep) noexcept {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < m_size; ++i) {
+      if (keep(m_items[i])) {
+        m_items[kept++] = m_items[i];
+      }
+    }
+    m_size = kept;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+  [[nodiscard]] static constexpr std::size_t capacity() noexcept { return N; }
+
+  [[nodiscard]] std::span<const T> items() const noexcept {
+    return {m_items.data(), m_size};
+  }
+  [[nodiscard]] const T *begin() const noexcept { return m_items.data(); }
+  [[nodiscard]] const T *end() const noexcept {
+    return m_items.data() + m_size;
+  }
+
+private:
+  std::array<T, N> m_items{};
+  std::size_t m_size = 0;
+};
+
+// NOLINTNEXTLINE
+inline constexpr std::size_t MAX_ORDERS_PER_BAR = 16;
+
+using OrderBuffer = FixedBuffer<Order, MAX_ORDERS_PER_BAR>;
+using FillBuffer = FixedBuffer<Fill, MAX_ORDERS_PER_BAR>;
+
+// NOLINTNEXTLINE
+inline constexpr std::size_t MAX_ORDERS_PER_BATCH = 1024;
+
+/// orders across every symbol of one portfolio step
+using PortfolioOrders = FixedBuffer<Order, MAX_ORDERS_PER_BATCH>;
+
+/// drops what is left of `pending` orders on the other side of `placed`'s
+/// symbol: a strategy can't see them, so its latest order replaces them
+inline void cancel_opposite(OrderBuffer &pending,
+                            const Order &placed) noexcept {
+  pending.retain([&placed](const Order &order) {
+    return order.symbol != placed.symbol || order.side == placed.side;
+  });
+}
+
+} // namespace chisel
+
+#endif // CHISEL_ENGINE_ORDER_H
@@ -0,0 +1,138 @@
+#ifndef CHISEL_ENGINE_PORTFOLIO_ENGINE_H
+#define CHISEL_ENGINE_PORTFOLIO_ENGINE_H
+
+#include "engine/account.h"
+#include "engine/bar_merge.h"
+#include "engine/engine.h"
+#include "engine/execution_model.h"
+#include "engine/order.h"
+#include "strategy/portfolio_strategy.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace chisel {
+
+/**
+ * @brief Replays many symbols' bars through one strategy and one
+ * multi-position account, a timestamp at a time.
+ *
+ * Each step takes the next batch from the merge; every symbol in it first
+ * fills the orders placed for it earlier and marks its position, then the
+ * strategy sees the whole batch. An order waits for its own symbol's next
+ * bar, however many timestamps later that is, and what that bar can't
+ * fill waits for the one after, unless a new order for the symbol on the
+ * other side cancels it first.
+ *
+ * RunStats::steps counts timestamps; an order arriving while its symbol
+ * already has MAX_ORDERS_PER_BAR waiting is counted in
+ * RunStats::dropped_orders. No snapshots are recorded.
+ *
+ * A stop check, as on BacktestEngine, is polled every STOP_CHECK_STEPS
+ * timestamps.
+ *
+ * Rule of 5: non-copyable, non-movable (holds references to its parts).
+ */
+template <portfolio_strategy_c S, execution_model_c E = ExecutionModel>
+class PortfolioEngine {
+public:
+  PortfolioEngine(EngineConfig config, S &strategy, const E &execution)
+      : m_config(config), m_strategy(strategy), m_execution(execution) {}
+
+  PortfolioEngine(PortfolioEngine &&) noexcept = delete;
+  PortfolioEngine &operator=(PortfolioEngine &&) noexcept = delete;
+
+  PortfolioEngine(const PortfolioEngine &) = delete;
+  PortfolioEngine &operator=(const PortfolioEngine &) = delete;
+
+  ~PortfolioEngine() = default;
+
+  /// true once the run should end early; a stopped run reports the
+  /// timestamps it got through
+  void stop_when(BacktestEngineBase::stop_check check) {
+    m_stop = std::move(check);
+  }
+
+  /// rewinds `feed`, starts from `EngineConfig::starting_cash`; throws
+  /// std::out_of_range for an order naming a symbol `feed` doesn't have, and
+  /// whatever the strategy throws (see PerSymbol for a full batch)
+  RunStats run(BarMerge &feed) {
+    feed.reset();
+    m_account.reset(m_config.starting_cash, feed.symbols());
+    m_pending.assign(feed.symbols(), OrderBuffer{});
+    m_metrics.reset(static_cast<double>(m_account.equity_fixed()));
+    m_strategy.reset();
+
+    RunStats stats;
+    for (auto batch = feed.next(); !batch.empty(); batch = feed.next()) {
+      if (stats.steps % STOP_CHECK_STEPS == 0 && m_stop && m_stop()) {
+        break;
+      }
+      const std::uint64_t step = stats.steps++;
+      for (const SymbolBar &bar : batch) {
+        stats.fills += execute(bar, step);
+      }
+      m_metrics.on_step(static_cast<double>(m_account.equity_fixed()));
+
+      m_orders.clear();
+      m_strategy.on_batch(BatchContext{.step = step,
+                                       .t = batch.front().bar->t,
+                                       .bars = batch,
+                                       .feed = feed,
+                                       .account = m_account},
+                          m_orders);
+      for (const Order &order : m_orders) {
+        if (order.symbol >= m_pending.size()) {
+          throw std::out_of_range("order for an unknown symbol");
+        }
+        OrderBuffer &pending = m_pending[order.symbol];
+        cancel_opposite(pending, order);
+        stats.dropped_orders += pending.push(order) ? 0U : 1U;
+      }
+      stats.orders += m_orders.size();
+    }
+
+    stats.final_equity = m_account.equity();
+    stats.metrics = m_metrics;
+    return stats;
+  }
+
+  [[nodiscard]] const Account &account() const noexcept { return m_account; }
+
+private:
+  /// fills `bar.symbol`'s waiting orders, marks it; @return fills made
+  std::uint64_t execute(const SymbolBar &bar, std::uint64_t step) {
+    std::uint64_t filled = 0;
+    m_pending[bar.symbol].retain([&](Order &order) {
+      Fill fill{};
+      if (m_execution.fill(order, *bar.bar, step, fill)) {
+        const Booked booked = m_account.apply(fill);
+        if (booked.closed != 0) {
+          m_metrics.on_trade(from_fixed(booked.realized));
+        }
+        order.quantity -= fill.quantity;
+        ++filled;
+      }
+      return order.quantity > 0;
+    });
+    m_account.mark(bar.symbol, bar.bar->close);
+    return filled;
+  }
+
+  EngineConfig m_config;
+  S &m_strategy;
+  const E &m_execution;
+  Account m_account;
+  RunMetrics m_metrics;
+  // one queue per symbol, filled at that symbol's next bar
+  std::vector<OrderBuffer> m_pending;
+  PortfolioOrders m_orders;
+  BacktestEngineBase::stop_check m_stop;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_ENGINE_PORTFOLIO_ENGINE_H
@@ -0,0 +1,112 @@
+#ifndef CHISEL_ENGINE_SNAPSHOT_H
+#define CHISEL_ENGINE_SNAPSHOT_H
+
+#include "engine/bar.h"
+#include "engine/order.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace chisel {
+
+/// indicator values kept per snapshot, the rest of a strategy's are dropped
+// NOLINTNEXTLINE
+inline constexpr std::size_t MAX_SNAPSHOT_INDICATORS = 8;
+
+/**
+ * Rule of zero - engine state after one step, the plain counterpart of
+ * marble::Snapshot. Fixed size, so a batch of them is one flat array.
+ */
+struct Snapshot {
+  std::uint64_t step;
+  Bar bar;
+  Action action;
+  bool executed;
+  // first fill of the step, valid when `executed`
+  Fill execution;
+  double cash;
+  std::int64_t position;
+  double entry_price;
+  double unrealized_pnl;
+  double realized_pnl;
+  double equity;
+  // named by the strategy's indicator_names(), in that order
+  std::array<double, MAX_SNAPSHOT_INDICATORS> indicators;
+  std::uint8_t indicator_count;
+};
+
+/// which steps get a snapshot, see SnapshotSampler
+enum class SnapshotMode : std::uint8_t {
+  every_step,
+  // one every `SnapshotSampling::every` steps, starting with the first
+  every_n,
+  // steps where the strategy acted or an order filled
+  on_activity,
+  // the first step in each `SnapshotSampling::bucket_ms` window of bar time
+  time_bucketed,
+};
+
+struct SnapshotSampling {
+  SnapshotMode mode = SnapshotMode::every_step;
+  // 0 reads as 1
+  std::uint64_t every = 1;
+  // windows are aligned to the epoch; <= 0 reads as every step
+  std::int64_t bucket_ms = 60'000;
+};
+
+/**
+ * Rule of zero - decides step by step whether the engine records a
+ * snapshot, so a long run can stream a chart's worth of them instead of one
+ * per bar.
+ */
+class SnapshotSampler {
+public:
+  SnapshotSampler() = default;
+  explicit SnapshotSampler(SnapshotSampling sampling) noexcept
+      : m_sampling(sampling) {}
+
+  void reset() noexcept { m_bucket = NO_BUCKET; }
+
+  /// `active` if the step had a signal or a fill
+  [[nodiscard]] bool keep(std::uint64_t step, std::int64_t t,
+                          bool active) noexcept {
+    switch (m_sampling.mode) {
+    case SnapshotMode::every_step:
+      return true;
+    case SnapshotMode::every_n:
+      return m_sampling.every <= 1 || step % m_sampling.every == 0;
+    case SnapshotMode::on_activity:
+      return active;
+    case SnapshotMode::time_bucketed: {
+      if (m_sampling.bucket_ms <= 0) {
+        return true;
+      }
+      const std::int64_t bucket = floor_div(t, m_sampling.bucket_ms);
+      if (bucket == m_bucket) {
+        return false;
+      }
+      m_bucket = bucket;
+      return true;
+    }
+    }
+    return true;
+  }
+
+private:
+  // NOLINTNEXTLINE
+  static constexpr std::int64_t NO_BUCKET =
+      std::numeric_limits<std::int64_t>::min();
+
+  static std::int64_t floor_div(std::int64_t a, std::int64_t b) noexcept {
+    const std::int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+  }
+
+  SnapshotSampling m_sampling;
+  std::int64_t m_bucket = NO_BUCKET;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_ENGINE_SNAPSHOT_H
@@ -0,0 +1,43 @@
+#ifndef CHISEL_ENGINE_SUMMARY_H
+#define CHISEL_ENGINE_SUMMARY_H
+
+#include "engine/engine.h"
+#include <cstdint>
+
+namespace chisel {
+
+/**
+ * Rule of zero - how a run went, the plain counterpart of
+ * marble::BacktestSummary.
+ */
+struct BacktestSummary {
+  double start_balance = 0.0;
+  double end_balance = 0.0;
+  double return_percent = 0.0;
+  // largest peak to trough, a fraction of the peak
+  double max_drawdown = 0.0;
+  // closing fills, the trades win_rate is taken over
+  std::int32_t trade_count = 0;
+  double win_rate = 0.0;
+  double sharpe_ratio = 0.0;
+};
+
+/// what a run's RunStats tell, Sharpe annualized by the config's periods
+[[nodiscard]] inline BacktestSummary summarize(const EngineConfig &config,
+                                               const RunStats &stats) {
+  const double start = config.starting_cash;
+  return BacktestSummary{
+      .start_balance = start,
+      .end_balance = stats.final_equity,
+      .return_percent =
+          start != 0.0 ? 100.0 * (stats.final_equity - start) / start : 0.0,
+      .max_drawdown = stats.metrics.max_drawdown(),
+      .trade_count = static_cast<std::int32_t>(stats.metrics.trades()),
+      .win_rate = stats.metrics.win_rate(),
+      .sharpe_ratio = stats.metrics.sharpe(config.periods_per_year),
+  };
+}
+
+} // namespace chisel
+
+#endif // CHISEL_ENGINE_SUMMARY_H
@@ -1,12 +1,56 @@
 #ifndef CHISEL_GRPC_BACKTEST_SERVICE_H
 #define CHISEL_GRPC_BACKTEST_SERVICE_H
 
+#include "back_test.grpc.pb.h"
+#include "engine/bar.h"
+#include <functional>
+#include <vector>
+
 namespace chisel {
 
-class BacktestServiceImpl {
+/**
+ * @brief RunBackTest: replays a symbol's bars through the named strategy
+ * and streams the run as it goes.
+ *
+ * SnapshotOptions in the request decide how much of it goes out: which bars
+ * get a snapshot, how many share an event, and whether indicator names are
+ * sent once up front instead of in every snapshot.
+ *
+ * A config naming `symbols` runs the basket on PortfolioEngine, one copy of
+ * the strategy per symbol; those runs stream only the started and end
+ * events.
+ *
+ * Rule of 5: non-copyable, non-movable (registered with the server by
+ * address).
+ */
+class BacktestServiceImpl final : public marble::BacktestService::Service {
 public:
-  BacktestServiceImpl();
-  ~BacktestServiceImpl();
+  /// the config's symbol from start to end, in time order; called once
+  /// per symbol for a basket
+  using bar_source =
+      std::function<std::vector<Bar>(const marble::BacktestConfig &)>;
+
+  explicit BacktestServiceImpl(bar_source bars);
+
+  BacktestServiceImpl(BacktestServiceImpl &&) noexcept = delete;
+  BacktestServiceImpl &operator=(BacktestServiceImpl &&) noexcept = delete;
+
+  BacktestServiceImpl(const BacktestServiceImpl &) = delete;
+  BacktestServiceImpl &operator=(const BacktestServiceImpl &) = delete;
+
+  ~BacktestServiceImpl() override;
+
+  grpc::Status
+  RunBackTest(grpc::ServerContext *context,
+              const marble::BacktestRequest *request,
+              grpc::ServerWriter<marble::BacktestEvent> *writer) override;
+
+private:
+  grpc::Status run_basket(grpc::ServerContext *context,
+                          const marble::BacktestConfig &config,
+                          grpc::ServerWriter<marble::BacktestEvent> *writer);
+
+  bar_source m_bars;
 };
 
 } // namespace chisel
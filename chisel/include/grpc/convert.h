@@ -0,0 +1,48 @@
+#ifndef CHISEL_GRPC_CONVERT_H
+#define CHISEL_GRPC_CONVERT_H
+
+#include "back_test.pb.h"
+#include "engine/account.h"
+#include "engine/snapshot.h"
+#include "engine/summary.h"
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace chisel {
+
+/**
+ * Fills `out` from `account`, one Position per symbol with a non-zero
+ * quantity. `tickers[i]` names SymbolId i; an account wider than `tickers`
+ * leaves the extra tickers blank.
+ */
+void to_account_state(const Account &account,
+                      std::span<const std::string> tickers,
+                      marble::AccountState &out);
+
+/// how one run's snapshots go on the wire
+struct SnapshotEncoding {
+  // names the position
+  std::string_view ticker;
+  // the strategy's indicator_names()
+  std::span<const std::string_view> indicator_names;
+  // values only, named once by the started event's indicator_names
+  bool intern_names = false;
+};
+
+/**
+ * Overwrites every field of `out`, so one message can be reused step after
+ * step and keep its allocations.
+ */
+void to_snapshot(const Snapshot &snapshot, const SnapshotEncoding &encoding,
+                 marble::Snapshot &out);
+
+void to_summary(const BacktestSummary &summary, marble::BacktestSummary &out);
+
+/// SAMPLE_NONE reads as every bar, the caller turns snapshots off instead
+[[nodiscard]] SnapshotSampling
+to_sampling(const marble::SnapshotOptions &options) noexcept;
+
+} // namespace chisel
+
+#endif // CHISEL_GRPC_CONVERT_H
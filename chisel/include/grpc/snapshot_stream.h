@@ -0,0 +1,80 @@
+#ifndef CHISEL_GRPC_SNAPSHOT_STREAM_H
+#define CHISEL_GRPC_SNAPSHOT_STREAM_H
+
+#include "back_test.pb.h"
+#include "engine/snapshot.h"
+#include "engine/summary.h"
+#include "grpc/convert.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+namespace chisel {
+
+/**
+ * @brief Turns one run into RunBackTest's events: started, the snapshots,
+ * end.
+ *
+ * Snapshots go out one step event each, or up to SnapshotOptions.batch to a
+ * SnapshotBatch event. One event is reused between writes, so after the
+ * first batch encoding allocates nothing new. Once a write fails the
+ * client is gone, and everything after it is dropped.
+ *
+ * Rule of 5: non-copyable, non-movable (the engine's sink points at it).
+ */
+class SnapshotStream {
+public:
+  /// false once the stream is closed
+  using event_writer = std::function<bool(const marble::BacktestEvent &)>;
+
+  SnapshotStream(const marble::SnapshotOptions &options,
+                 SnapshotEncoding encoding, event_writer write);
+
+  SnapshotStream(SnapshotStream &&) noexcept = delete;
+  SnapshotStream &operator=(SnapshotStream &&) noexcept = delete;
+
+  SnapshotStream(const SnapshotStream &) = delete;
+  SnapshotStream &operator=(const SnapshotStream &) = delete;
+
+  ~SnapshotStream();
+
+  /**
+   * EngineConfig::snapshot_batch that hands write() one event's worth at a
+   * time, 0 for SAMPLE_NONE.
+   */
+  [[nodiscard]] std::size_t engine_batch() const noexcept {
+    return m_snapshot_batch;
+  }
+
+  /// the started event: `config` and the strategy's indicator names
+  bool start(const marble::BacktestConfig &config);
+
+  /// the engine's snapshot sink; splits into events of the requested size
+  void write(std::span<const Snapshot> snapshots);
+
+  bool finish(const BacktestSummary &summary);
+
+  [[nodiscard]] bool ok() const noexcept { return m_ok; }
+  [[nodiscard]] std::uint64_t events() const noexcept { return m_events; }
+  [[nodiscard]] std::uint64_t snapshots() const noexcept {
+    return m_snapshots;
+  }
+
+private:
+  bool send();
+
+  SnapshotEncoding m_encoding;
+  event_writer m_write;
+  // snapshots per event, 1 sends step events
+  std::size_t m_per_event;
+  std::size_t m_snapshot_batch;
+  marble::BacktestEvent m_event;
+  bool m_ok = true;
+  std::uint64_t m_events = 0;
+  std::uint64_t m_snapshots = 0;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_GRPC_SNAPSHOT_STREAM_H
@@ -0,0 +1,58 @@
+#ifndef CHISEL_INDICATORS_ATR_H
+#define CHISEL_INDICATORS_ATR_H
+
+#include "engine/bar.h"
+#include "indicators/wilder.h"
+#include <cmath>
+#include <cstddef>
+
+namespace chisel {
+
+/// high - low, widened to the previous close when the bar gapped past it
+[[nodiscard]] inline double true_range(double high, double low,
+                                       double prev_close) noexcept {
+  const double range = high - low;
+  const double up = std::abs(high - prev_close);
+  const double down = std::abs(low - prev_close);
+  const double wider = up > down ? up : down;
+  return range > wider ? range : wider;
+}
+
+/**
+ * Average true range, Wilder-smoothed. The first bar has no previous close
+ * and counts its plain high - low.
+ *
+ * Rule of zero.
+ */
+class Atr {
+public:
+  explicit Atr(std::size_t period) : m_average(period) {}
+
+  double update(const Bar &bar) noexcept {
+    const double range = m_has_prev ? true_range(bar.high, bar.low, m_prev)
+                                    : bar.high - bar.low;
+    m_prev = bar.close;
+    m_has_prev = true;
+    return m_average.update(range);
+  }
+
+  void reset() noexcept {
+    m_average.reset();
+    m_has_prev = false;
+  }
+
+  [[nodiscard]] bool ready() const noexcept { return m_average.ready(); }
+  [[nodiscard]] double value() const noexcept { return m_average.value(); }
+  [[nodiscard]] std::size_t period() const noexcept {
+    return m_average.period();
+  }
+
+private:
+  WilderAverage m_average;
+  double m_prev = 0.0;
+  bool m_has_prev = false;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_INDICATORS_ATR_H
@@ -0,0 +1,83 @@
+#ifndef CHISEL_INDICATORS_BATCH_H
+#define CHISEL_INDICATORS_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+/**
+ * Whole-series indicator kernels over contiguous double columns, for
+ * research and sweeps that precompute instead of stepping bar by bar.
+ *
+ * Every kernel performs the same floating point operations in the same order
+ * as its incremental counterpart, so results are bit-identical to feeding the
+ * series through Sma, Bollinger, Ema or Atr. chisel_core builds with
+ * -ffp-contract=off so no side fuses a multiply-add the other doesn't.
+ *
+ * Element-wise kernels run AVX2 or AVX-512 wide when the CPU has them.
+ * Running sums and EMAs are recurrences: one series is a single sequential
+ * pass, and the `_lanes` variants vectorize across windows instead, one
+ * window per SIMD lane.
+ *
+ * `out` spans must be at least as long as the input.
+ */
+namespace chisel::batch {
+
+enum class Simd : std::uint8_t { scalar, avx2, avx512 };
+
+/// widest level this CPU runs, detected once
+[[nodiscard]] Simd best_simd() noexcept;
+[[nodiscard]] std::string_view simd_name(Simd simd) noexcept;
+
+/// out[i] = Sma(window).value() after in[i], 0 until the window fills
+void rolling_mean(std::span<const double> in, std::size_t window,
+                  std::span<double> out);
+
+/**
+ * Sma for several windows in one pass, interleaved: the mean for
+ * windows[k] after in[i] lands in out[i * windows.size() + k].
+ */
+void rolling_mean_lanes(std::span<const double> in,
+                        std::span<const std::size_t> windows,
+                        std::span<double> out, Simd simd = best_simd());
+
+/// out[i] = Bollinger(window).stddev() after in[i]
+void rolling_stddev(std::span<const double> in, std::size_t window,
+                    std::span<double> out);
+
+/// out[i] = Ema(period).value() after in[i]
+void ema(std::span<const double> in, std::size_t period,
+         std::span<double> out);
+
+/// Ema for several periods in one pass, interleaved like rolling_mean_lanes
+void ema_lanes(std::span<const double> in,
+               std::span<const std::size_t> periods, std::span<double> out,
+               Simd simd = best_simd());
+
+/// the range Atr averages: out[0] = high - low, then true_range()
+void true_range(std::span<const double> high, std::span<const double> low,
+                std::span<const double> close, std::span<double> out,
+                Simd simd = best_simd());
+
+/// out[0] = 0, out[i] = close[i] / close[i - 1] - 1
+void returns(std::span<const double> close, std::span<double> out,
+             Simd simd = best_simd());
+
+/// out[0] = 0, out[i] = log(close[i] / close[i - 1]); the log is libm's
+void log_returns(std::span<const double> close, std::span<double> out,
+                 Simd simd = best_simd());
+
+/**
+ * MACrossover's rule over precomputed averages: +1 where fast - slow turns
+ * positive from <= 0, -1 where it turns negative from >= 0, else 0. Nothing
+ * fires before `from`, the first bar both averages are ready, and the spread
+ * before it counts as 0.
+ */
+void crosses(std::span<const double> fast, std::span<const double> slow,
+             std::size_t from, std::span<std::int8_t> out,
+             Simd simd = best_simd());
+
+} // namespace chisel::batch
+
+#endif // CHISEL_INDICATORS_BATCH_H
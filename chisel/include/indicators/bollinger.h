@@ -0,0 +1,90 @@
+#ifndef CHISEL_INDICATORS_BOLLINGER_H
+#define CHISEL_INDICATORS_BOLLINGER_H
+
+#include "indicators/ring_buffer.h"
+#include <cmath>
+#include <cstddef>
+
+namespace chisel {
+
+/**
+ * Bollinger bands: the window mean plus and minus `width` population
+ * standard deviations. Mean and the sum of squared deviations are kept by a
+ * windowed Welford update: each value is added while the window fills, then
+ * swapped in for the one it evicts. Unlike a raw sum of squares this never
+ * subtracts two huge, nearly equal numbers, so it holds its precision over
+ * millions of bars.
+ *
+ * Rule of zero.
+ */
+template <std::size_t N = dynamic_window> class Bollinger {
+public:
+  explicit Bollinger(double width = 2.0)
+    requires(N != dynamic_window)
+      : m_width(width) {}
+
+  Bollinger(std::size_t window, double width)
+    requires(N == dynamic_window)
+      : m_window(window), m_width(width) {}
+
+  double update(double value) noexcept {
+    if (!m_window.full()) {
+      m_window.push(value);
+      const double delta = value - m_mean;
+      m_mean += delta / static_cast<double>(m_window.size());
+      m_m2 += delta * (value - m_mean);
+      return middle();
+    }
+
+    const double evicted = m_window.push(value);
+    const double prev_mean = m_mean;
+    m_mean += (value - evicted) / count();
+    m_m2 += (value - evicted) * (value - m_mean + evicted - prev_mean);
+    return middle();
+  }
+
+  void reset() noexcept {
+    m_window.clear();
+    m_mean = 0.0;
+    m_m2 = 0.0;
+  }
+
+  [[nodiscard]] bool ready() const noexcept { return m_window.full(); }
+  /// the window mean, 0 until ready
+  [[nodiscard]] double value() const noexcept { return middle(); }
+  [[nodiscard]] double middle() const noexcept {
+    return ready() ? m_mean : 0.0;
+  }
+  [[nodiscard]] double stddev() const noexcept {
+    if (!ready()) {
+      return 0.0;
+    }
+    const double variance = m_m2 / count();
+    // rounding can leave a flat window slightly negative
+    return variance > 0.0 ? std::sqrt(variance) : 0.0;
+  }
+  [[nodiscard]] double upper() const noexcept {
+    return middle() + m_width * stddev();
+  }
+  [[nodiscard]] double lower() const noexcept {
+    return middle() - m_width * stddev();
+  }
+  [[nodiscard]] std::size_t period() const noexcept {
+    return m_window.capacity();
+  }
+
+private:
+  RingBuffer<double, N> m_window;
+  double m_width;
+  double m_mean = 0.0;
+  // sum of squared deviations from m_mean over the window
+  double m_m2 = 0.0;
+
+  [[nodiscard]] double count() const noexcept {
+    return static_cast<double>(m_window.capacity());
+  }
+};
+
+} // namespace chisel
+
+#endif // CHISEL_INDICATORS_BOLLINGER_H
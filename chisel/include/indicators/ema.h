@@ -0,0 +1,59 @@
+#ifndef CHISEL_INDICATORS_EMA_H
+#define CHISEL_INDICATORS_EMA_H
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace chisel {
+
+/**
+ * Exponential moving average with alpha = 2 / (period + 1), seeded with the
+ * mean of the first `period` values.
+ *
+ * Rule of zero.
+ */
+class Ema {
+public:
+  explicit Ema(std::size_t period)
+      : m_period(period), m_alpha(2.0 / (static_cast<double>(period) + 1.0)) {
+    if (period == 0) {
+      throw std::invalid_argument("Ema period must be positive");
+    }
+  }
+
+  double update(double value) noexcept {
+    if (m_count < m_period) {
+      m_value += value;
+      if (++m_count == m_period) {
+        m_value /= static_cast<double>(m_period);
+      }
+      return this->value();
+    }
+    m_value += m_alpha * (value - m_value);
+    return m_value;
+  }
+
+  void reset() noexcept {
+    m_count = 0;
+    m_value = 0.0;
+  }
+
+  [[nodiscard]] bool ready() const noexcept { return m_count == m_period; }
+  /// 0 until seeded
+  [[nodiscard]] double value() const noexcept {
+    return ready() ? m_value : 0.0;
+  }
+  [[nodiscard]] std::size_t period() const noexcept { return m_period; }
+  [[nodiscard]] double alpha() const noexcept { return m_alpha; }
+
+private:
+  std::size_t m_period;
+  double m_alpha;
+  std::size_t m_count = 0;
+  // running sum while seeding, the average after
+  double m_value = 0.0;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_INDICATORS_EMA_H
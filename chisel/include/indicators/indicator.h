@@ -0,0 +1,65 @@
+#ifndef CHISEL_INDICATORS_INDICATOR_H
+#define CHISEL_INDICATORS_INDICATOR_H
+
+#include "engine/bar.h"
+#include <concepts>
+#include <utility>
+
+namespace chisel {
+
+/// what every indicator offers besides its `update`
+template <typename T>
+concept indicator_c = requires(T indicator, const T &view) {
+  { view.value() } -> std::convertible_to<double>;
+  { view.ready() } -> std::convertible_to<bool>;
+  indicator.reset();
+};
+
+/// updated from one number per bar, usually a close or another indicator
+template <typename T>
+concept scalar_indicator_c = indicator_c<T> && requires(T indicator) {
+  { indicator.update(0.0) } -> std::convertible_to<double>;
+};
+
+/// updated from the whole bar, like Atr or Vwap
+template <typename T>
+concept bar_indicator_c = indicator_c<T> && requires(T indicator, Bar bar) {
+  { indicator.update(bar) } -> std::convertible_to<double>;
+};
+
+/**
+ * Feeds `Inner`'s value into `Outer` once `Inner` is ready, e.g.
+ * `Chained<Rsi, Ema>` is a smoothed RSI and `Chained<Atr, Sma<20>>` an
+ * average ATR. Both stay O(1) per update and chains nest.
+ *
+ * Rule of zero.
+ */
+template <typename Inner, scalar_indicator_c Outer>
+  requires scalar_indicator_c<Inner> || bar_indicator_c<Inner>
+class Chained {
+public:
+  Chained(Inner inner, Outer outer)
+      : m_inner(std::move(inner)), m_outer(std::move(outer)) {}
+
+  template <typename Input> double update(const Input &input) noexcept {
+    const double inner = m_inner.update(input);
+    return m_inner.ready() ? m_outer.update(inner) : m_outer.value();
+  }
+
+  void reset() noexcept {
+    m_inner.reset();
+    m_outer.reset();
+  }
+
+  [[nodiscard]] bool ready() const noexcept { return m_outer.ready(); }
+  [[nodiscard]] double value() const noexcept { return m_outer.value(); }
+  [[nodiscard]] const Inner &inner() const noexcept { return m_inner; }
+
+private:
+  Inner m_inner;
+  Outer m_outer;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_INDICATORS_INDICATOR_H
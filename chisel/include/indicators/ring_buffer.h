@@ -0,0 +1,77 @@
+#ifndef CHISEL_INDICATORS_RING_BUFFER_H
+#define CHISEL_INDICATORS_RING_BUFFER_H
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace chisel {
+
+/// window size picked at runtime instead of as a template argument
+// NOLINTNEXTLINE
+inline constexpr std::size_t dynamic_window = 0;
+
+/**
+ * Fixed-capacity FIFO over the last `N` values. Storage is inline for a
+ * compile-time `N`, or allocated once at construction for `dynamic_window`;
+ * `push` never allocates either way.
+ *
+ * Rule of zero.
+ */
+template <typename T, std::size_t N = dynamic_window> class RingBuffer {
+public:
+  RingBuffer()
+    requires(N != dynamic_window)
+  = default;
+
+  explicit RingBuffer(std::size_t capacity)
+    requires(N == dynamic_window)
+      : m_items(capacity) {
+    if (capacity == 0) {
+      throw std::invalid_argument("RingBuffer capacity must be positive");
+    }
+  }
+
+  /// @return the value pushed out, T{} while not yet full
+  T push(T value) noexcept {
+    T evicted = m_size == capacity() ? m_items[m_head] : T{};
+    m_items[m_head] = value;
+    if (++m_head == capacity()) {
+      m_head = 0;
+    }
+    if (m_size < capacity()) {
+      ++m_size;
+    }
+    return evicted;
+  }
+
+  void clear() noexcept {
+    m_head = 0;
+    m_size = 0;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+  [[nodiscard]] std::size_t capacity() const noexcept {
+    return m_items.size();
+  }
+  [[nodiscard]] bool full() const noexcept { return m_size == capacity(); }
+
+  /// i-th oldest value held
+  [[nodiscard]] const T &operator[](std::size_t i) const noexcept {
+    const std::size_t oldest = full() ? m_head : 0;
+    const std::size_t at = oldest + i;
+    return m_items[at < capacity() ? at : at - capacity()];
+  }
+
+private:
+  std::conditional_t<N == dynamic_window, std::vector<T>, std::array<T, N>>
+      m_items{};
+  std::size_t m_head = 0;
+  std::size_t m_size = 0;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_INDICATORS_RING_BUFFER_H
@@ -0,0 +1,58 @@
+#ifndef CHISEL_INDICATORS_RSI_H
+#define CHISEL_INDICATORS_RSI_H
+
+#include "indicators/wilder.h"
+#include <cstddef>
+
+namespace chisel {
+
+/**
+ * Relative strength index, 0-100, over Wilder-smoothed gains and losses of
+ * consecutive values.
+ *
+ * Rule of zero.
+ */
+class Rsi {
+public:
+  explicit Rsi(std::size_t period) : m_gain(period), m_loss(period) {}
+
+  double update(double value) noexcept {
+    if (m_has_prev) {
+      const double change = value - m_prev;
+      m_gain.update(change > 0.0 ? change : 0.0);
+      m_loss.update(change < 0.0 ? -change : 0.0);
+    }
+    m_prev = value;
+    m_has_prev = true;
+    return this->value();
+  }
+
+  void reset() noexcept {
+    m_gain.reset();
+    m_loss.reset();
+    m_has_prev = false;
+  }
+
+  [[nodiscard]] bool ready() const noexcept { return m_gain.ready(); }
+  /// 50 until ready, 100 when nothing was lost
+  [[nodiscard]] double value() const noexcept {
+    if (!ready()) {
+      return 50.0;
+    }
+    if (m_loss.value() == 0.0) {
+      return 100.0;
+    }
+    return 100.0 - 100.0 / (1.0 + m_gain.value() / m_loss.value());
+  }
+  [[nodiscard]] std::size_t period() const noexcept { return m_gain.period(); }
+
+private:
+  WilderAverage m_gain;
+  WilderAverage m_loss;
+  double m_prev = 0.0;
+  bool m_has_prev = false;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_INDICATORS_RSI_H
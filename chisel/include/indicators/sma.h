@@ -0,0 +1,53 @@
+#ifndef CHISEL_INDICATORS_SMA_H
+#define CHISEL_INDICATORS_SMA_H
+
+#include "indicators/ring_buffer.h"
+#include <cstddef>
+
+namespace chisel {
+
+/**
+ * Simple moving average, a running sum corrected by the value leaving the
+ * window, so O(1) per update whatever the window.
+ *
+ * Rule of zero.
+ */
+template <std::size_t N = dynamic_window> class Sma {
+public:
+  Sma()
+    requires(N != dynamic_window)
+  = default;
+
+  explicit Sma(std::size_t window)
+    requires(N == dynamic_window)
+      : m_window(window) {}
+
+  double update(double value) noexcept {
+    m_sum += value - m_window.push(value);
+    return value_or_zero();
+  }
+
+  void reset() noexcept {
+    m_window.clear();
+    m_sum = 0.0;
+  }
+
+  [[nodiscard]] bool ready() const noexcept { return m_window.full(); }
+  /// 0 until the window has filled
+  [[nodiscard]] double value() const noexcept { return value_or_zero(); }
+  [[nodiscard]] std::size_t period() const noexcept {
+    return m_window.capacity();
+  }
+
+private:
+  RingBuffer<double, N> m_window;
+  double m_sum = 0.0;
+
+  [[nodiscard]] double value_or_zero() const noexcept {
+    return ready() ? m_sum / static_cast<double>(m_window.capacity()) : 0.0;
+  }
+};
+
+} // namespace chisel
+
+#endif // CHISEL_INDICATORS_SMA_H
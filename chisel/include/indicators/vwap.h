@@ -0,0 +1,42 @@
+#ifndef CHISEL_INDICATORS_VWAP_H
+#define CHISEL_INDICATORS_VWAP_H
+
+#include "engine/bar.h"
+
+namespace chisel {
+
+/**
+ * Volume-weighted average price since the last `reset`, typically called at
+ * each session open. Uses the bar's own vwap, or its typical price
+ * (high + low + close) / 3 when the feed has none.
+ *
+ * Rule of zero.
+ */
+class Vwap {
+public:
+  double update(const Bar &bar) noexcept {
+    const double price =
+        bar.vwap > 0.0 ? bar.vwap : (bar.high + bar.low + bar.close) / 3.0;
+    m_traded += price * bar.volume;
+    m_volume += bar.volume;
+    return value();
+  }
+
+  void reset() noexcept {
+    m_traded = 0.0;
+    m_volume = 0.0;
+  }
+
+  [[nodiscard]] bool ready() const noexcept { return m_volume > 0.0; }
+  [[nodiscard]] double value() const noexcept {
+    return ready() ? m_traded / m_volume : 0.0;
+  }
+
+private:
+  double m_traded = 0.0;
+  double m_volume = 0.0;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_INDICATORS_VWAP_H
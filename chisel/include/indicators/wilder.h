@@ -0,0 +1,55 @@
+#ifndef CHISEL_INDICATORS_WILDER_H
+#define CHISEL_INDICATORS_WILDER_H
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace chisel {
+
+/**
+ * Wilder's smoothing, the average behind RSI and ATR: the mean of the first
+ * `period` values, then avg = (avg * (period - 1) + value) / period.
+ *
+ * Rule of zero.
+ */
+class WilderAverage {
+public:
+  explicit WilderAverage(std::size_t period) : m_period(period) {
+    if (period == 0) {
+      throw std::invalid_argument("Wilder period must be positive");
+    }
+  }
+
+  double update(double value) noexcept {
+    const auto period = static_cast<double>(m_period);
+    if (m_count < m_period) {
+      m_value += value;
+      if (++m_count == m_period) {
+        m_value /= period;
+      }
+      return this->value();
+    }
+    m_value = (m_value * (period - 1.0) + value) / period;
+    return m_value;
+  }
+
+  void reset() noexcept {
+    m_count = 0;
+    m_value = 0.0;
+  }
+
+  [[nodiscard]] bool ready() const noexcept { return m_count == m_period; }
+  [[nodiscard]] double value() const noexcept {
+    return ready() ? m_value : 0.0;
+  }
+  [[nodiscard]] std::size_t period() const noexcept { return m_period; }
+
+private:
+  std::size_t m_period;
+  std::size_t m_count = 0;
+  double m_value = 0.0;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_INDICATORS_WILDER_H
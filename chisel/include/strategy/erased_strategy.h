@@ -0,0 +1,50 @@
+#ifndef CHISEL_STRATEGY_ERASED_STRATEGY_H
+#define CHISEL_STRATEGY_ERASED_STRATEGY_H
+
+#include "strategy/i_strategy.h"
+#include "strategy/strategy.h"
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace chisel {
+
+/**
+ * @brief Puts a strategy_c type behind IStrategy, so one chosen at runtime
+ * runs on BacktestEngine<IStrategy>.
+ *
+ * The wrapped strategy is built in place from the constructor arguments.
+ *
+ * Rule of zero (copies and moves as far as `S` does).
+ */
+template <strategy_c S> class ErasedStrategy final : public IStrategy {
+public:
+  template <typename... Args>
+  explicit ErasedStrategy(Args &&...args)
+      : m_strategy(std::forward<Args>(args)...) {}
+
+  void reset() override { m_strategy.reset(); }
+
+  Action on_bar(const BarContext &ctx, OrderBuffer &orders) override {
+    return m_strategy.on_bar(ctx, orders);
+  }
+
+  [[nodiscard]] std::span<const std::string_view>
+  indicator_names() const override {
+    return m_strategy.indicator_names();
+  }
+
+  [[nodiscard]] std::span<const double> indicator_values() const override {
+    return m_strategy.indicator_values();
+  }
+
+  [[nodiscard]] S &strategy() noexcept { return m_strategy; }
+  [[nodiscard]] const S &strategy() const noexcept { return m_strategy; }
+
+private:
+  S m_strategy;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_STRATEGY_ERASED_STRATEGY_H
@@ -1,14 +1,43 @@
 #ifndef CHISEL_STRATEGY_I_STRATEGY_H
 #define CHISEL_STRATEGY_I_STRATEGY_H
 
+#include "engine/order.h"
+#include "strategy/strategy.h"
+#include <span>
+#include <string_view>
+
 namespace chisel {
 
+/**
+ * Runtime-polymorphic strategy, for picking one by name. Each on_bar is a
+ * virtual call; hot loops over a known strategy type use it directly through
+ * strategy_c instead.
+ */
 class IStrategy {
 public:
   IStrategy();
   virtual ~IStrategy();
+
+  /// back to the state before the first bar
+  virtual void reset() = 0;
+
+  /// places market orders for the next bar into `orders`
+  virtual Action on_bar(const BarContext &ctx, OrderBuffer &orders) = 0;
+
+  /// fixed for the strategy's lifetime, one per `indicator_values()` entry
+  [[nodiscard]] virtual std::span<const std::string_view>
+  indicator_names() const {
+    return {};
+  }
+
+  /// as of the last `on_bar`, read by the engine for snapshots
+  [[nodiscard]] virtual std::span<const double> indicator_values() const {
+    return {};
+  }
 };
 
+static_assert(strategy_c<IStrategy>);
+
 } // namespace chisel
 
 #endif // CHISEL_STRATEGY_I_STRATEGY_H
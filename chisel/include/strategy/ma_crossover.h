@@ -1,16 +1,90 @@
 #ifndef CHISEL_STRATEGY_MA_CROSSOVER_H
 #define CHISEL_STRATEGY_MA_CROSSOVER_H
 
-#include "strategy/i_strategy.h"
+#include "indicators/sma.h"
+#include "strategy/strategy.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
 
 namespace chisel {
 
-class MACrossover : public IStrategy {
+/**
+ * Long-only moving average crossover on closes: buys `quantity` when the fast
+ * average crosses above the slow one, sells the position when it crosses
+ * back below. Both averages update in O(1) per bar and are reported as
+ * `sma(<fast>)` and `sma(<slow>)`.
+ *
+ * A plain strategy_c type: the engine calls it directly, ErasedStrategy puts
+ * it behind IStrategy.
+ *
+ * Rule of 5: non-copyable, non-movable (name views point into itself).
+ */
+class MACrossover {
 public:
-  MACrossover();
-  ~MACrossover() override;
+  MACrossover(std::size_t fast, std::size_t slow, std::int32_t quantity);
+
+  MACrossover(MACrossover &&) noexcept = delete;
+  MACrossover &operator=(MACrossover &&) noexcept = delete;
+
+  MACrossover(const MACrossover &) = delete;
+  MACrossover &operator=(const MACrossover &) = delete;
+
+  ~MACrossover();
+
+  void reset();
+
+  /// defined here so the engine loop can inline it
+  Action on_bar(const BarContext &ctx, OrderBuffer &orders) {
+    const double close = ctx.bar().close;
+    m_values[0] = m_fast.update(close);
+    m_values[1] = m_slow.update(close);
+    if (!m_slow.ready()) {
+      return Action::hold;
+    }
+
+    const double spread = m_values[0] - m_values[1];
+    const double prev = m_prev_spread;
+    m_prev_spread = spread;
+
+    const std::int64_t held = ctx.account.position(ctx.symbol);
+    if (prev <= 0.0 && spread > 0.0 && held == 0) {
+      orders.push(Order{.side = Side::buy, .quantity = m_quantity});
+      return Action::buy;
+    }
+    if (prev >= 0.0 && spread < 0.0 && held > 0) {
+      orders.push(Order{.side = Side::sell,
+                        .quantity = static_cast<std::int32_t>(held)});
+      return Action::sell;
+    }
+    return Action::hold;
+  }
+
+  [[nodiscard]] std::span<const std::string_view>
+  indicator_names() const noexcept {
+    return m_name_views;
+  }
+  [[nodiscard]] std::span<const double> indicator_values() const noexcept {
+    return m_values;
+  }
+
+private:
+  Sma<> m_fast;
+  Sma<> m_slow;
+  std::int32_t m_quantity;
+  // fast minus slow on the previous bar, 0 until both are warm
+  double m_prev_spread = 0.0;
+
+  std::array<std::string, 2> m_names;
+  std::array<std::string_view, 2> m_name_views;
+  std::array<double, 2> m_values{};
 };
 
+static_assert(strategy_c<MACrossover>);
+
 } // namespace chisel
 
 #endif // CHISEL_STRATEGY_MA_CROSSOVER_H
@@ -0,0 +1,102 @@
+#ifndef CHISEL_STRATEGY_PORTFOLIO_STRATEGY_H
+#define CHISEL_STRATEGY_PORTFOLIO_STRATEGY_H
+
+#include "engine/account.h"
+#include "engine/bar_merge.h"
+#include "engine/order.h"
+#include "strategy/strategy.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace chisel {
+
+/// what a portfolio strategy sees on each timestamp
+struct BatchContext {
+  std::uint64_t step;
+  std::int64_t t;
+  // the symbols with a bar at `t`, ascending
+  std::span<const SymbolBar> bars;
+  // every symbol's history so far
+  const BarMerge &feed;
+  const Account &account;
+};
+
+/**
+ * What PortfolioEngine drives: one call per timestamp with every symbol's
+ * bar at it, placing orders for any symbol.
+ *
+ * - reset(): back to the state before the first batch
+ * - on_batch(): places market orders into `orders`, each executing at its
+ *   symbol's next bar
+ */
+template <typename S>
+concept portfolio_strategy_c =
+    requires(S &strategy, const BatchContext &ctx, PortfolioOrders &orders) {
+      strategy.reset();
+      strategy.on_batch(ctx, orders);
+    };
+
+/**
+ * @brief Runs one single-symbol strategy per symbol, each over its own
+ * history, sharing the portfolio's account.
+ *
+ * Every copy is built from the same constructor arguments. Orders are
+ * stamped with the symbol whose strategy placed them; on_batch throws
+ * std::length_error rather than drop any past MAX_ORDERS_PER_BATCH.
+ *
+ * Rule of zero (the strategies stay put in a deque, so non-movable ones
+ * work).
+ */
+template <strategy_c S> class PerSymbol {
+public:
+  template <typename... Args>
+  explicit PerSymbol(std::size_t symbols, const Args &...args) {
+    for (std::size_t s = 0; s < symbols; ++s) {
+      m_strategies.emplace_back(args...);
+    }
+  }
+
+  void reset() {
+    for (S &strategy : m_strategies) {
+      strategy.reset();
+    }
+  }
+
+  void on_batch(const BatchContext &ctx, PortfolioOrders &orders) {
+    for (const SymbolBar &bar : ctx.bars) {
+      m_scratch.clear();
+      m_strategies[bar.symbol].on_bar(
+          BarContext{.step = ctx.step,
+                     .history = ctx.feed.history(bar.symbol),
+                     .account = ctx.account,
+                     .symbol = bar.symbol},
+          m_scratch);
+      for (Order order : m_scratch) {
+        order.symbol = bar.symbol;
+        if (!orders.push(order)) {
+          throw std::length_error(
+              "more than MAX_ORDERS_PER_BATCH orders in one batch");
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] std::size_t symbols() const noexcept {
+    return m_strategies.size();
+  }
+  [[nodiscard]] S &strategy(SymbolId symbol) noexcept {
+    return m_strategies[symbol];
+  }
+
+private:
+  std::deque<S> m_strategies;
+  OrderBuffer m_scratch;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_STRATEGY_PORTFOLIO_STRATEGY_H
@@ -0,0 +1,24 @@
+#ifndef CHISEL_STRATEGY_REGISTRY_H
+#define CHISEL_STRATEGY_REGISTRY_H
+
+#include "strategy/i_strategy.h"
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace chisel {
+
+/**
+ * The strategy `BacktestConfig.strategy_name` names, with its default
+ * parameters, behind IStrategy.
+ *
+ * @throws std::invalid_argument for a name not in strategy_names()
+ */
+std::unique_ptr<IStrategy> make_strategy(std::string_view name);
+
+/// every name make_strategy accepts
+std::span<const std::string_view> strategy_names() noexcept;
+
+} // namespace chisel
+
+#endif // CHISEL_STRATEGY_REGISTRY_H
@@ -0,0 +1,49 @@
+#ifndef CHISEL_STRATEGY_STRATEGY_H
+#define CHISEL_STRATEGY_STRATEGY_H
+
+#include "engine/account.h"
+#include "engine/bar.h"
+#include "engine/order.h"
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace chisel {
+
+/// what a strategy sees on each step
+struct BarContext {
+  std::uint64_t step;
+  // every bar so far, the current one last
+  std::span<const Bar> history;
+  const Account &account;
+  // whose bars `history` holds, 0 outside portfolio runs
+  SymbolId symbol = 0;
+
+  [[nodiscard]] const Bar &bar() const noexcept { return history.back(); }
+};
+
+/**
+ * What BacktestEngine drives. A concrete strategy type makes on_bar a direct
+ * call the compiler can inline into the bar loop; IStrategy satisfies it too,
+ * for strategies picked at runtime.
+ *
+ * - reset(): back to the state before the first bar
+ * - on_bar(): places market orders for the next bar into `orders`
+ * - indicator_names(): fixed for the strategy's lifetime, one per value
+ * - indicator_values(): as of the last on_bar, read for snapshots
+ */
+template <typename S>
+concept strategy_c = requires(S &strategy, const S &view,
+                              const BarContext &ctx, OrderBuffer &orders) {
+  strategy.reset();
+  { strategy.on_bar(ctx, orders) } -> std::same_as<Action>;
+  {
+    view.indicator_names()
+  } -> std::convertible_to<std::span<const std::string_view>>;
+  { view.indicator_values() } -> std::convertible_to<std::span<const double>>;
+};
+
+} // namespace chisel
+
+#endif // CHISEL_STRATEGY_STRATEGY_H
@@ -0,0 +1,75 @@
+#ifndef CHISEL_SWEEP_PARAM_SPACE_H
+#define CHISEL_SWEEP_PARAM_SPACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace chisel {
+
+/**
+ * One swept parameter, taking lo, lo + step, ... up to hi. A step of 0 makes
+ * it continuous, which random_sample and latin_hypercube allow but a full
+ * grid doesn't.
+ */
+struct Dimension {
+  std::string name;
+  double lo = 0.0;
+  double hi = 0.0;
+  double step = 1.0;
+};
+
+/**
+ * @brief The parameter combinations of a sweep, stored flat: point `i` is
+ * one value per dimension, in dimension order.
+ *
+ * Rule of zero.
+ */
+class ParamGrid {
+public:
+  /// @throws std::invalid_argument for hi < lo or a negative step
+  explicit ParamGrid(std::vector<Dimension> dimensions);
+
+  /// @throws std::invalid_argument unless one value per dimension
+  void add(std::span<const double> point);
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return m_dimensions.empty() ? 0 : m_values.size() / m_dimensions.size();
+  }
+  [[nodiscard]] std::span<const Dimension> dimensions() const noexcept {
+    return m_dimensions;
+  }
+  [[nodiscard]] std::span<const double> point(std::size_t i) const noexcept {
+    return std::span<const double>{m_values}.subspan(
+        i * m_dimensions.size(), m_dimensions.size());
+  }
+
+private:
+  std::vector<Dimension> m_dimensions;
+  std::vector<double> m_values;
+};
+
+/**
+ * Every combination, the last dimension varying fastest.
+ *
+ * @throws std::invalid_argument for a continuous dimension with lo < hi
+ */
+ParamGrid full_grid(std::vector<Dimension> dimensions);
+
+/// `count` points drawn uniformly, on each dimension's steps
+ParamGrid random_sample(std::vector<Dimension> dimensions, std::size_t count,
+                        std::uint64_t seed);
+
+/**
+ * `count` points where each dimension's range, cut into `count` equal strata,
+ * has exactly one point per stratum, so a few hundred samples still cover
+ * every parameter's whole range. Values snap to the dimension's steps.
+ */
+ParamGrid latin_hypercube(std::vector<Dimension> dimensions,
+                          std::size_t count, std::uint64_t seed);
+
+} // namespace chisel
+
+#endif // CHISEL_SWEEP_PARAM_SPACE_H
@@ -0,0 +1,141 @@
+#ifndef CHISEL_SWEEP_SWEEP_H
+#define CHISEL_SWEEP_SWEEP_H
+
+#include "engine/bar.h"
+#include "engine/engine.h"
+#include "engine/execution_model.h"
+#include "engine/summary.h"
+#include "strategy/strategy.h"
+#include "sweep/param_space.h"
+#include "sweep/work_stealing_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chisel {
+
+struct SweepConfig {
+  // 0 runs one worker per hardware thread
+  std::size_t threads = 0;
+  // keep the best `top_k` runs, 0 keeps every run
+  std::size_t top_k = 0;
+  // what ranks runs, best first
+  double BacktestSummary::*rank_by = &BacktestSummary::return_percent;
+  bool lower_is_better = false;
+  EngineConfig engine{};
+};
+
+struct SweepResult {
+  // index into the ParamGrid
+  std::size_t point;
+  BacktestSummary summary;
+};
+
+struct SweepReport {
+  // best first, ties in grid order
+  std::vector<SweepResult> results;
+  std::size_t runs = 0;
+  // points whose parameters the strategy rejected
+  std::size_t skipped = 0;
+  std::uint64_t steals = 0;
+  std::chrono::nanoseconds elapsed{};
+};
+
+/**
+ * @brief Collects sweep results per worker without locking, keeping only
+ * each worker's best `top_k`, and merges them once the sweep ends.
+ *
+ * Rule of 5: non-copyable, non-movable (workers write into it).
+ */
+class SweepCollector {
+public:
+  using result_sink = std::function<void(const SweepResult &)>;
+
+  SweepCollector(const SweepConfig &config, std::size_t workers,
+                 result_sink on_result = {});
+
+  SweepCollector(SweepCollector &&) noexcept = delete;
+  SweepCollector &operator=(SweepCollector &&) noexcept = delete;
+
+  SweepCollector(const SweepCollector &) = delete;
+  SweepCollector &operator=(const SweepCollector &) = delete;
+
+  ~SweepCollector();
+
+  /// only ever called by `worker` itself
+  void add(std::size_t worker, const SweepResult &result);
+
+  /// every worker's results merged, best first, cut to top_k
+  [[nodiscard]] std::vector<SweepResult> take();
+
+  [[nodiscard]] bool better(const SweepResult &a,
+                            const SweepResult &b) const noexcept;
+
+private:
+  struct alignas(64) Kept {
+    std::vector<SweepResult> results;
+  };
+
+  double BacktestSummary::*m_rank_by;
+  bool m_lower_is_better;
+  std::size_t m_top_k;
+  std::vector<Kept> m_kept;
+  std::mutex m_sink_mutex;
+  result_sink m_on_result;
+};
+
+/**
+ * @brief Backtests every point of `grid` over the same bars, one isolated
+ * engine and strategy per point, on a WorkStealingPool.
+ *
+ * `make` builds the strategy for a point's parameters; throwing
+ * std::invalid_argument (say fast >= slow) skips the point. The bars and
+ * execution model are shared read-only. `on_result`, if set, sees each
+ * result as it lands, one call at a time.
+ */
+template <execution_model_c E, typename Make>
+  requires strategy_c<
+      std::invoke_result_t<const Make &, std::span<const double>>>
+SweepReport run_sweep(std::span<const Bar> bars, const ParamGrid &grid,
+                      const E &execution, const Make &make,
+                      const SweepConfig &config = {},
+                      SweepCollector::result_sink on_result = {}) {
+  WorkStealingPool pool(config.threads);
+  SweepCollector collector(config, pool.threads(), std::move(on_result));
+  std::atomic<std::size_t> runs{0};
+  std::atomic<std::size_t> skipped{0};
+
+  const auto start = std::chrono::steady_clock::now();
+  pool.run(grid.size(), [&](std::size_t point, std::size_t worker) {
+    try {
+      auto strategy = make(grid.point(point));
+      BacktestEngine engine(config.engine, strategy, execution);
+      const auto stats = engine.run(bars);
+      collector.add(worker, SweepResult{
+                                .point = point,
+                                .summary = summarize(config.engine, stats),
+                            });
+      ++runs;
+    } catch (const std::invalid_argument &) {
+      ++skipped;
+    }
+  });
+
+  return SweepReport{.results = collector.take(),
+                     .runs = runs,
+                     .skipped = skipped,
+                     .steals = pool.steals(),
+                     .elapsed = std::chrono::steady_clock::now() - start};
+}
+
+} // namespace chisel
+
+#endif // CHISEL_SWEEP_SWEEP_H
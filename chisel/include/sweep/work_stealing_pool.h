@@ -0,0 +1,67 @@
+#ifndef CHISEL_SWEEP_WORK_STEALING_POOL_H
+#define CHISEL_SWEEP_WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace chisel {
+
+/**
+ * @brief Runs task indices [0, tasks) on a fixed number of threads.
+ *
+ * Each worker starts on an even slice of the indices and takes from its
+ * front. One that runs dry steals the back half of the largest slice left,
+ * so a few slow tasks don't leave the other cores idle. Tasks are meant to
+ * be coarse (a whole backtest), so a mutex per slice is cheap enough.
+ *
+ * Rule of 5: non-copyable, non-movable (slices hold mutexes).
+ */
+class WorkStealingPool {
+public:
+  using task = std::function<void(std::size_t index, std::size_t worker)>;
+
+  /// 0 threads means one per hardware thread
+  explicit WorkStealingPool(std::size_t threads = 0);
+
+  WorkStealingPool(WorkStealingPool &&) noexcept = delete;
+  WorkStealingPool &operator=(WorkStealingPool &&) noexcept = delete;
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  ~WorkStealingPool();
+
+  /**
+   * Blocks until every index has run, `worker` being the calling thread's
+   * number in [0, threads()). If tasks throw, the rest still run and the
+   * first exception is rethrown here.
+   */
+  void run(std::size_t tasks, const task &fn);
+
+  [[nodiscard]] std::size_t threads() const noexcept { return m_threads; }
+  /// slices stolen during the last run
+  [[nodiscard]] std::uint64_t steals() const noexcept { return m_steals; }
+
+private:
+  // own cache line each, workers hammer their own
+  struct alignas(64) Slice {
+    std::mutex mutex;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+  };
+
+  std::size_t m_threads;
+  std::vector<Slice> m_slices;
+  std::atomic<std::uint64_t> m_steals{0};
+
+  bool pop(std::size_t worker, std::size_t &index);
+  bool steal(std::size_t worker, std::size_t &index);
+};
+
+} // namespace chisel
+
+#endif // CHISEL_SWEEP_WORK_STEALING_POOL_H
@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <print>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "engine/engine.h"
+#include "engine/execution_model.h"
+#include "engine/portfolio_engine.h"
+#include "strategy/erased_strategy.h"
+#include "strategy/ma_crossover.h"
+#include "strategy/portfolio_strategy.h"
+
+namespace {
+// allocations made by the calling thread, to prove the loop makes none
+thread_local std::uint64_t t_allocations = 0;
+} // namespace
+
+// NOLINTBEGIN
+void *operator new(std::size_t size) {
+  ++t_allocations;
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+// NOLINTEND
+
+namespace {
+using steady = std::chrono::steady_clock;
+
+/**
+ * Every engine replays the same bars `passes` times; `threads` engines run
+ * side by side on their own strategy and account, sharing the read-only
+ * series, which is how a parameter sweep would use the cores.
+ */
+struct BenchConfig {
+  std::size_t bars = 5'000'000;
+  std::size_t passes = 5;
+  std::size_t threads = 1;
+  std::size_t fast = 10;
+  std::size_t slow = 50;
+  std::uint32_t seed = 1;
+  // through ErasedStrategy and a virtual on_bar instead of MACrossover's own
+  bool erased = false;
+  // > 1 splits `bars` across that many symbols on one PortfolioEngine
+  std::size_t symbols = 1;
+};
+
+/**
+ * --bars=N --passes=N --threads=N --fast=N --slow=N --seed=N --erased=0|1
+ * --symbols=N
+ */
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    const auto eq = arg.find('=');
+    const auto key = arg.substr(0, eq);
+    if (eq == std::string_view::npos) {
+      throw std::invalid_argument("expected --key=value: " + std::string{arg});
+    }
+    const auto value = std::stoul(std::string{arg.substr(eq + 1)});
+
+    if (key == "--bars") {
+      config.bars = value;
+    } else if (key == "--passes") {
+      config.passes = std::max(1UL, value);
+    } else if (key == "--threads") {
+      config.threads = std::max(1UL, value);
+    } else if (key == "--fast") {
+      config.fast = value;
+    } else if (key == "--slow") {
+      config.slow = value;
+    } else if (key == "--seed") {
+      config.seed = static_cast<std::uint32_t>(value);
+    } else if (key == "--erased") {
+      config.erased = value != 0;
+    } else if (key == "--symbols") {
+      config.symbols = std::max(1UL, value);
+    } else {
+      throw std::invalid_argument("unknown argument: " + std::string{arg});
+    }
+  }
+  return config;
+}
+
+/// minute bars on a geometric random walk
+std::vector<chisel::Bar> random_walk(std::size_t count, std::uint32_t seed) {
+  std::mt19937_64 rng{seed};
+  std::normal_distribution<double> step{0.0, 0.001};
+  std::uniform_real_distribution<double> wick{0.0, 0.0005};
+  std::uniform_real_distribution<double> volume{1'000.0, 50'000.0};
+
+  std::vector<chisel::Bar> bars;
+  bars.reserve(count);
+  double price = 100.0;
+  std::int64_t t = 1'704'205'800'000; // 2024-01-02 14:30 UTC
+  for (std::size_t i = 0; i < count; ++i) {
+    const double open = price;
+    price *= std::exp(step(rng));
+    const double high = std::max(open, price) * (1.0 + wick(rng));
+    const double low = std::min(open, price) * (1.0 - wick(rng));
+    bars.push_back(chisel::Bar{.t = t,
+                               .open = open,
+                               .high = high,
+                               .low = low,
+                               .close = price,
+                               .volume = volume(rng),
+                               .vwap = (high + low + price) / 3.0,
+                               .transactions = 100});
+    t += 60'000;
+  }
+  return bars;
+}
+
+struct WorkerResult {
+  std::chrono::nanoseconds elapsed{};
+  std::uint64_t steps = 0;
+  std::uint64_t fills = 0;
+  std::uint64_t allocations = 0;
+  double final_equity = 0.0;
+};
+
+template <chisel::strategy_c S>
+WorkerResult run_worker(const BenchConfig &config,
+                        std::span<const chisel::Bar> bars, S &strategy) {
+  const chisel::ExecutionModel execution(chisel::BpsSlippage{1.0});
+  chisel::BacktestEngine engine({}, strategy, execution);
+
+  WorkerResult result;
+  const std::uint64_t allocations_before = t_allocations;
+  const auto start = steady::now();
+  for (std::size_t pass = 0; pass < config.passes; ++pass) {
+    const auto stats = engine.run(bars);
+    result.steps += stats.steps;
+    result.fills += stats.fills;
+    result.final_equity = stats.final_equity;
+  }
+  result.elapsed = steady::now() - start;
+  result.allocations = t_allocations - allocations_before;
+  return result;
+}
+
+/// every symbol's walk spans the same minutes, so each timestamp is a batch
+/// of `config.symbols` bars
+WorkerResult run_portfolio(const BenchConfig &config,
+                           std::span<const std::vector<chisel::Bar>> series) {
+  const chisel::ExecutionModel execution(chisel::BpsSlippage{1.0});
+  chisel::BarMerge merge(
+      std::vector<std::span<const chisel::Bar>>(series.begin(), series.end()));
+  chisel::PerSymbol<chisel::MACrossover> basket(series.size(), config.fast,
+                                                config.slow, 100);
+  chisel::PortfolioEngine engine({}, basket, execution);
+
+  WorkerResult result;
+  const std::uint64_t allocations_before = t_allocations;
+  const auto start = steady::now();
+  for (std::size_t pass = 0; pass < config.passes; ++pass) {
+    const auto stats = engine.run(merge);
+    result.fills += stats.fills;
+    result.final_equity = stats.final_equity;
+  }
+  result.elapsed = steady::now() - start;
+  result.allocations = t_allocations - allocations_before;
+  for (const auto &bars : series) {
+    result.steps += bars.size() * config.passes;
+  }
+  return result;
+}
+
+WorkerResult run_worker(const BenchConfig &config,
+                        std::span<const chisel::Bar> bars,
+                        std::span<const std::vector<chisel::Bar>> series) {
+  if (!series.empty()) {
+    return run_portfolio(config, series);
+  }
+  if (config.erased) {
+    chisel::ErasedStrategy<chisel::MACrossover> strategy(config.fast,
+                                                         config.slow, 100);
+    return run_worker<chisel::IStrategy>(config, bars, strategy);
+  }
+  chisel::MACrossover strategy(config.fast, config.slow, 100);
+  return run_worker(config, bars, strategy);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchConfig config;
+  try {
+    config = parse_args(argc, argv);
+  } catch (const std::exception &ex) {
+    std::println(stderr, "Bad arguments: {}", ex.what());
+    return 1;
+  }
+
+  std::vector<chisel::Bar> bars;
+  std::vector<std::vector<chisel::Bar>> series;
+  if (config.symbols > 1) {
+    for (std::size_t s = 0; s < config.symbols; ++s) {
+      const auto seed = config.seed + static_cast<std::uint32_t>(s);
+      series.push_back(random_walk(config.bars / config.symbols, seed));
+    }
+  } else {
+    bars = random_walk(config.bars, config.seed);
+  }
+
+  std::vector<WorkerResult> results(config.threads);
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(config.threads);
+    for (std::size_t i = 0; i < config.threads; ++i) {
+      workers.emplace_back([&config, &bars, &series, &results, i]() {
+        results[i] = run_worker(config, bars, series);
+      });
+    }
+  }
+
+  std::uint64_t steps = 0;
+  std::uint64_t allocations = 0;
+  double slowest = 0.0;
+  double per_core = 0.0;
+  for (const auto &result : results) {
+    const double seconds =
+        std::chrono::duration<double>(result.elapsed).count();
+    steps += result.steps;
+    allocations += result.allocations;
+    slowest = std::max(slowest, seconds);
+    per_core += static_cast<double>(result.steps) / seconds;
+  }
+  per_core /= static_cast<double>(results.size());
+
+  std::println(
+      R"({{"bars":{},"passes":{},"threads":{},"fast":{},"slow":{},)"
+      R"("erased":{},"symbols":{},)"
+      R"("steps":{},"fills_per_run":{},"final_equity":{:.2f},)"
+      R"("bars_per_sec_per_core":{:.0f},"bars_per_sec":{:.0f},)"
+      R"("ns_per_bar":{:.2f},"loop_allocations":{}}})",
+      config.bars, config.passes, config.threads, config.fast, config.slow,
+      config.erased, config.symbols, steps,
+      results.front().fills / config.passes, results.front().final_equity,
+      per_core,
+      static_cast<double>(steps) / slowest, 1e9 / per_core, allocations);
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <print>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "indicators/batch.h"
+#include "indicators/sma.h"
+
+namespace {
+using steady = std::chrono::steady_clock;
+using chisel::batch::Simd;
+
+/**
+ * The MACrossover signal for one (fast, slow) pair, stepped bar by bar and
+ * as batch kernels, then `lanes` windows at once the way a sweep would
+ * precompute them.
+ */
+struct BenchConfig {
+  std::size_t bars = 5'000'000;
+  std::size_t passes = 5;
+  std::size_t fast = 10;
+  std::size_t slow = 50;
+  std::size_t lanes = 16;
+  std::uint32_t seed = 1;
+};
+
+/**
+ * --bars=N --passes=N --fast=N --slow=N --lanes=N --seed=N
+ */
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    const auto eq = arg.find('=');
+    const auto key = arg.substr(0, eq);
+    if (eq == std::string_view::npos) {
+      throw std::invalid_argument("expected --key=value: " + std::string{arg});
+    }
+    const auto value = std::stoul(std::string{arg.substr(eq + 1)});
+
+    if (key == "--bars") {
+      config.bars = value;
+    } else if (key == "--passes") {
+      config.passes = std::max(1UL, value);
+    } else if (key == "--fast") {
+      config.fast = value;
+    } else if (key == "--slow") {
+      config.slow = value;
+    } else if (key == "--lanes") {
+      config.lanes = std::max(1UL, value);
+    } else if (key == "--seed") {
+      config.seed = static_cast<std::uint32_t>(value);
+    } else {
+      throw std::invalid_argument("unknown argument: " + std::string{arg});
+    }
+  }
+  return config;
+}
+
+std::vector<double> random_walk(std::size_t count, std::uint32_t seed) {
+  std::mt19937_64 rng{seed};
+  std::normal_distribution<double> step{0.0, 0.001};
+  std::vector<double> closes(count);
+  double price = 100.0;
+  for (auto &close : closes) {
+    price *= std::exp(step(rng));
+    close = price;
+  }
+  return closes;
+}
+
+/// best of `passes`, in ns per bar
+template <typename Fn>
+double time_per_bar(const BenchConfig &config, Fn &&fn) {
+  double best = 0.0;
+  for (std::size_t pass = 0; pass < config.passes; ++pass) {
+    const auto start = steady::now();
+    fn();
+    const double ns =
+        std::chrono::duration<double, std::nano>(steady::now() - start)
+            .count() /
+        static_cast<double>(config.bars);
+    best = pass == 0 ? ns : std::min(best, ns);
+  }
+  return best;
+}
+
+/// MACrossover's spread rule over two incremental averages
+void step_signals(const BenchConfig &config, const std::vector<double> &in,
+                  std::vector<std::int8_t> &out) {
+  chisel::Sma<> fast(config.fast);
+  chisel::Sma<> slow(config.slow);
+  double prev = 0.0;
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    const double f = fast.update(in[i]);
+    const double s = slow.update(in[i]);
+    std::int8_t signal = 0;
+    if (slow.ready()) {
+      const double spread = f - s;
+      signal = prev <= 0.0 && spread > 0.0   ? 1
+               : prev >= 0.0 && spread < 0.0 ? -1
+                                             : 0;
+      prev = spread;
+    }
+    out[i] = signal;
+  }
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchConfig config;
+  try {
+    config = parse_args(argc, argv);
+    if (config.fast == 0 || config.slow <= config.fast) {
+      throw std::invalid_argument("needs 0 < fast < slow");
+    }
+  } catch (const std::exception &ex) {
+    std::println(stderr, "Bad arguments: {}", ex.what());
+    return 1;
+  }
+
+  const auto closes = random_walk(config.bars, config.seed);
+  std::vector<std::size_t> windows(config.lanes);
+  for (std::size_t k = 0; k < windows.size(); ++k) {
+    windows[k] = config.fast + k * 5;
+  }
+
+  std::vector<std::int8_t> stepped(config.bars);
+  const double step_ns =
+      time_per_bar(config, [&] { step_signals(config, closes, stepped); });
+  std::vector<double> lanes_out(config.bars * windows.size());
+  const double step_lanes_ns = time_per_bar(config, [&] {
+    std::vector<chisel::Sma<>> smas(windows.begin(), windows.end());
+    double *row = lanes_out.data();
+    for (const double close : closes) {
+      for (auto &sma : smas) {
+        *row++ = sma.update(close);
+      }
+    }
+  });
+
+  std::vector<double> fast(config.bars);
+  std::vector<double> slow(config.bars);
+  std::vector<std::int8_t> signals(config.bars);
+  std::string levels;
+  for (int level = 0; level <= static_cast<int>(chisel::batch::best_simd());
+       ++level) {
+    const auto simd = static_cast<Simd>(level);
+    const double batch_ns = time_per_bar(config, [&] {
+      chisel::batch::rolling_mean(closes, config.fast, fast);
+      chisel::batch::rolling_mean(closes, config.slow, slow);
+      chisel::batch::crosses(fast, slow, config.slow - 1, signals, simd);
+    });
+    const double lanes_ns = time_per_bar(config, [&] {
+      chisel::batch::rolling_mean_lanes(closes, windows, lanes_out, simd);
+    });
+    const bool identical = signals == stepped;
+
+    levels += std::format(
+        R"({}{{"simd":"{}","ns_per_bar":{:.2f},"speedup":{:.2f},)"
+        R"("lanes_ns_per_bar":{:.2f},"lanes_speedup":{:.2f},)"
+        R"("identical":{}}})",
+        levels.empty() ? "" : ",", chisel::batch::simd_name(simd), batch_ns,
+        step_ns / batch_ns, lanes_ns, step_lanes_ns / lanes_ns, identical);
+  }
+
+  std::println(R"({{"bars":{},"passes":{},"fast":{},"slow":{},"lanes":{},)"
+               R"("step_ns_per_bar":{:.2f},"step_lanes_ns_per_bar":{:.2f},)"
+               R"("batch":[{}]}})",
+               config.bars, config.passes, config.fast, config.slow,
+               config.lanes, step_ns, step_lanes_ns, levels);
+  return 0;
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <print>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "strategy/ma_crossover.h"
+#include "sweep/param_space.h"
+#include "sweep/sweep.h"
+
+namespace {
+/**
+ * MACrossover over a fast x slow grid on one shared series. Run it at
+ * --threads=1 and at the core count to read off the scaling.
+ */
+struct BenchConfig {
+  std::size_t bars = 500'000;
+  std::size_t threads = 0;
+  std::size_t top = 5;
+  std::size_t fast_max = 50;
+  std::size_t slow_max = 200;
+  std::uint32_t seed = 1;
+};
+
+/**
+ * --bars=N --threads=N --top=N --fast-max=N --slow-max=N --seed=N
+ */
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    const auto eq = arg.find('=');
+    const auto key = arg.substr(0, eq);
+    if (eq == std::string_view::npos) {
+      throw std::invalid_argument("expected --key=value: " + std::string{arg});
+    }
+    const auto value = std::stoul(std::string{arg.substr(eq + 1)});
+
+    if (key == "--bars") {
+      config.bars = value;
+    } else if (key == "--threads") {
+      config.threads = value;
+    } else if (key == "--top") {
+      config.top = value;
+    } else if (key == "--fast-max") {
+      config.fast_max = std::max(5UL, value);
+    } else if (key == "--slow-max") {
+      config.slow_max = std::max(20UL, value);
+    } else if (key == "--seed") {
+      config.seed = static_cast<std::uint32_t>(value);
+    } else {
+      throw std::invalid_argument("unknown argument: " + std::string{arg});
+    }
+  }
+  return config;
+}
+
+/// minute bars on a geometric random walk
+std::vector<chisel::Bar> random_walk(std::size_t count, std::uint32_t seed) {
+  std::mt19937_64 rng{seed};
+  std::normal_distribution<double> step{0.0, 0.001};
+
+  std::vector<chisel::Bar> bars;
+  bars.reserve(count);
+  double price = 100.0;
+  std::int64_t t = 1'704'205'800'000; // 2024-01-02 14:30 UTC
+  for (std::size_t i = 0; i < count; ++i) {
+    const double open = price;
+    price *= std::exp(step(rng));
+    bars.push_back(chisel::Bar{.t = t,
+                               .open = open,
+                               .high = std::max(open, price),
+                               .low = std::min(open, price),
+                               .close = price,
+                               .volume = 10'000.0,
+                               .vwap = (open + price) / 2.0,
+                               .transactions = 100});
+    t += 60'000;
+  }
+  return bars;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchConfig config;
+  try {
+    config = parse_args(argc, argv);
+  } catch (const std::exception &ex) {
+    std::println(stderr, "Bad arguments: {}", ex.what());
+    return 1;
+  }
+
+  const auto bars = random_walk(config.bars, config.seed);
+  const auto grid = chisel::full_grid(
+      {{.name = "fast",
+        .lo = 5,
+        .hi = static_cast<double>(config.fast_max),
+        .step = 5},
+       {.name = "slow",
+        .lo = 20,
+        .hi = static_cast<double>(config.slow_max),
+        .step = 10}});
+  const chisel::ExecutionModel execution(chisel::BpsSlippage{1.0});
+
+  const auto report = chisel::run_sweep(
+      bars, grid, execution,
+      [](std::span<const double> params) {
+        return chisel::MACrossover(static_cast<std::size_t>(params[0]),
+                                   static_cast<std::size_t>(params[1]), 100);
+      },
+      {.threads = config.threads, .top_k = config.top});
+
+  const double seconds =
+      std::chrono::duration<double>(report.elapsed).count();
+  const auto &best = report.results.front();
+  std::println(
+      R"({{"bars":{},"threads":{},"points":{},"runs":{},"skipped":{},)"
+      R"("steals":{},"seconds":{:.3f},"runs_per_sec":{:.1f},)"
+      R"("bars_per_sec":{:.0f},"best_fast":{},"best_slow":{},)"
+      R"("best_return_percent":{:.3f}}})",
+      config.bars,
+      config.threads != 0 ? config.threads
+                          : std::max(1U, std::thread::hardware_concurrency()),
+      grid.size(), report.runs, report.skipped, report.steals, seconds,
+      static_cast<double>(report.runs) / seconds,
+      static_cast<double>(report.runs * config.bars) / seconds,
+      grid.point(best.point)[0], grid.point(best.point)[1],
+      best.summary.return_percent);
+  return 0;
+}
@@ -1,9 +1,52 @@
 #include "engine/account.h"
+#include <algorithm>
+#include <cstdlib>
 
 namespace chisel {
 
-Account::Account() = default;
+Account::Account(double cash, std::size_t symbols) { reset(cash, symbols); }
 
-Account::~Account() = default;
+void Account::reset(double cash, std::size_t symbols) {
+  m_cash = to_fixed(cash);
+  m_realized = 0;
+  m_market = 0;
+  m_cost = 0;
+  // assign keeps the capacity, so same-sized runs don't reallocate
+  m_positions.assign(std::max<std::size_t>(symbols, 1), Position{});
+}
+
+Booked Account::apply(const Fill &fill) noexcept {
+  Position &held = m_positions[fill.symbol];
+  const Fixed price = to_fixed(fill.price);
+  const Fixed commission = to_fixed(fill.commission);
+  const std::int64_t delta =
+      fill.side == Side::buy ? fill.quantity : -std::int64_t{fill.quantity};
+  const std::int64_t size = std::abs(held.quantity);
+
+  m_market -= held.quantity * held.mark;
+  m_cost -= held.cost;
+
+  // the part of the fill against the position, nothing when adding
+  const std::int64_t closed =
+      (held.quantity ^ delta) < 0 ? std::min(std::abs(delta), size) : 0;
+  // closed's share of the cost; split so cost * closed can't overflow
+  const Fixed removed = closed == size ? held.cost
+                                       : held.cost / size * closed +
+                                             held.cost % size * closed / size;
+  const std::int64_t closing = held.quantity > 0 ? -closed : closed;
+  // commission is a realized loss the moment it's paid
+  const Fixed realized = -closing * price - removed - commission;
+
+  held.cost += (delta - closing) * price - removed;
+  held.realized += realized;
+  held.quantity += delta;
+  held.mark = price;
+
+  m_cash -= delta * price + commission;
+  m_realized += realized;
+  m_market += held.quantity * held.mark;
+  m_cost += held.cost;
+  return Booked{.closed = closed, .realized = realized};
+}
 
 } // namespace chisel
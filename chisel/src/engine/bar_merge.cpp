@@ -0,0 +1,164 @@
+#include "engine/bar_merge.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace chisel {
+
+namespace {
+// NOLINTNEXTLINE
+constexpr std::int64_t DRAINED = std::numeric_limits<std::int64_t>::max();
+// batches averaged before picking scan or heap again
+// NOLINTNEXTLINE
+constexpr std::size_t ADAPT_WINDOW = 64;
+// a scan visits every symbol, a heap pop costs roughly log2(symbols) slow
+// compares per bar; measured, the heap pays off once batches average under
+// 1/64 of the symbols. Switching back waits for 1/32 so it doesn't flap.
+// NOLINTNEXTLINE
+constexpr std::size_t TO_HEAP = 64;
+// NOLINTNEXTLINE
+constexpr std::size_t TO_SCAN = 32;
+} // namespace
+
+BarMerge::BarMerge(std::vector<std::span<const Bar>> series)
+    : m_series(std::move(series)) {
+  if (m_series.size() > std::numeric_limits<SymbolId>::max()) {
+    throw std::invalid_argument("too many symbols to merge");
+  }
+  for (std::size_t s = 0; s < m_series.size(); ++s) {
+    const auto bars = m_series[s];
+    if (bars.size() > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::invalid_argument("series " + std::to_string(s) +
+                                  " is too long to merge");
+    }
+    for (std::size_t i = 1; i < bars.size(); ++i) {
+      if (bars[i].t <= bars[i - 1].t) {
+        throw std::invalid_argument("series " + std::to_string(s) +
+                                    " is not strictly increasing in time");
+      }
+    }
+  }
+  m_cursors.resize(m_series.size());
+  m_next.resize(m_series.size());
+  m_heap.reserve(m_series.size());
+  m_batch.reserve(m_series.size());
+  reset();
+}
+
+void BarMerge::reset() {
+  m_t = DRAINED;
+  for (std::size_t s = 0; s < m_series.size(); ++s) {
+    m_cursors[s] = 0;
+    m_next[s] = m_series[s].empty() ? DRAINED : m_series[s].front().t;
+    m_t = std::min(m_t, m_next[s]);
+  }
+  m_heap.clear();
+  m_batch.clear();
+  m_heap_mode = false;
+  m_window_bars = 0;
+  m_window_batches = 0;
+}
+
+std::span<const SymbolBar> BarMerge::next() {
+  m_batch.clear();
+  if (m_t == DRAINED) {
+    return {};
+  }
+  if (m_heap_mode) {
+    pop();
+  } else {
+    scan();
+  }
+  adapt();
+  return m_batch;
+}
+
+void BarMerge::take(SymbolId symbol) {
+  const auto bars = m_series[symbol];
+  const std::uint32_t index = m_cursors[symbol]++;
+  m_batch.push_back(
+      SymbolBar{.symbol = symbol, .index = index, .bar = &bars[index]});
+  m_next[symbol] = index + 1 < bars.size() ? bars[index + 1].t : DRAINED;
+}
+
+void BarMerge::scan() {
+  const std::int64_t t = m_t;
+  std::int64_t after = DRAINED;
+  for (std::size_t s = 0; s < m_next.size(); ++s) {
+    if (m_next[s] == t) {
+      take(static_cast<SymbolId>(s));
+    }
+    after = std::min(after, m_next[s]);
+  }
+  m_t = after;
+}
+
+void BarMerge::pop() {
+  const std::int64_t t = m_t;
+  while (!m_heap.empty() && m_heap.front().t == t) {
+    const SymbolId symbol = m_heap.front().symbol;
+    take(symbol);
+    if (m_next[symbol] != DRAINED) {
+      sift_down(0, Key{.t = m_next[symbol], .symbol = symbol});
+    } else {
+      const Key last = m_heap.back();
+      m_heap.pop_back();
+      if (!m_heap.empty()) {
+        sift_down(0, last);
+      }
+    }
+  }
+  m_t = m_heap.empty() ? DRAINED : m_heap.front().t;
+}
+
+void BarMerge::adapt() {
+  m_window_bars += m_batch.size();
+  if (++m_window_batches < ADAPT_WINDOW) {
+    return;
+  }
+  const std::size_t symbols = m_series.size();
+  const std::size_t bars = m_window_bars;
+  m_window_bars = 0;
+  m_window_batches = 0;
+
+  if (!m_heap_mode && bars * TO_HEAP < symbols * ADAPT_WINDOW) {
+    m_heap.clear();
+    for (std::size_t s = 0; s < symbols; ++s) {
+      if (m_next[s] != DRAINED) {
+        m_heap.push_back(
+            Key{.t = m_next[s], .symbol = static_cast<SymbolId>(s)});
+      }
+    }
+    for (std::size_t at = m_heap.size() / 2; at-- > 0;) {
+      sift_down(at, m_heap[at]);
+    }
+    m_heap_mode = true;
+  } else if (m_heap_mode && bars * TO_SCAN >= symbols * ADAPT_WINDOW) {
+    // m_next is kept current in both modes, so the heap can just go
+    m_heap.clear();
+    m_heap_mode = false;
+  }
+}
+
+void BarMerge::sift_down(std::size_t at, Key key) noexcept {
+  const std::size_t size = m_heap.size();
+  for (;;) {
+    std::size_t child = 2 * at + 1;
+    if (child >= size) {
+      break;
+    }
+    if (child + 1 < size && before(m_heap[child + 1], m_heap[child])) {
+      ++child;
+    }
+    if (!before(m_heap[child], key)) {
+      break;
+    }
+    m_heap[at] = m_heap[child];
+    at = child;
+  }
+  m_heap[at] = key;
+}
+
+} // namespace chisel
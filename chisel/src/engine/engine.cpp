@@ -1,9 +1,57 @@
 #include "engine/engine.h"
+#include <algorithm>
 
 namespace chisel {
 
-BacktestEngine::BacktestEngine() = default;
+BacktestEngineBase::BacktestEngineBase(EngineConfig config)
+    : m_config(config), m_account(config.starting_cash),
+      m_sampler(config.sampling) {
+  m_snapshots.reserve(config.snapshot_batch);
+}
 
-BacktestEngine::~BacktestEngine() = default;
+BacktestEngineBase::~BacktestEngineBase() = default;
+
+void BacktestEngineBase::begin_run() {
+  m_account.reset(m_config.starting_cash);
+  m_metrics.reset(static_cast<double>(m_account.equity_fixed()));
+  m_pending.clear();
+  m_snapshots.clear();
+  m_sampler.reset();
+}
+
+void BacktestEngineBase::record(std::uint64_t step, const Bar &bar,
+                                Action action,
+                                std::span<const double> indicators) {
+  auto &snapshot = m_snapshots.emplace_back(
+      Snapshot{.step = step,
+               .bar = bar,
+               .action = action,
+               .executed = !m_fills.empty(),
+               .execution = m_fills.empty() ? Fill{} : *m_fills.begin(),
+               .cash = m_account.cash(),
+               .position = m_account.position(),
+               .entry_price = m_account.entry_price(),
+               .unrealized_pnl = m_account.unrealized_pnl(),
+               .realized_pnl = m_account.realized_pnl(),
+               .equity = m_account.equity(),
+               .indicators = {},
+               .indicator_count = 0});
+
+  const std::size_t kept =
+      std::min(indicators.size(), MAX_SNAPSHOT_INDICATORS);
+  std::copy_n(indicators.begin(), kept, snapshot.indicators.begin());
+  snapshot.indicator_count = static_cast<std::uint8_t>(kept);
+
+  if (m_snapshots.size() == m_config.snapshot_batch) {
+    flush_snapshots();
+  }
+}
+
+void BacktestEngineBase::flush_snapshots() {
+  if (!m_snapshots.empty() && m_sink) {
+    m_sink(m_snapshots);
+  }
+  m_snapshots.clear();
+}
 
 } // namespace chisel
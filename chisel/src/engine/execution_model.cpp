@@ -1,9 +0,0 @@
-#include "engine/execution_model.h"
-
-namespace chisel {
-
-ExecutionModel::ExecutionModel() = default;
-
-ExecutionModel::~ExecutionModel() = default;
-
-} // namespace chisel
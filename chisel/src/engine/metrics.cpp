@@ -0,0 +1,97 @@
+#include "engine/metrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace chisel {
+
+void RunMetrics::reset(double equity) noexcept {
+  *this = RunMetrics{};
+  m_last = equity;
+  m_totals.peak = equity;
+}
+
+void RunMetrics::fold() noexcept {
+  m_totals = settled();
+  m_last = m_block[m_pending - 1];
+  m_pending = 0;
+}
+
+RunMetrics::Totals RunMetrics::settled() const noexcept {
+  const std::size_t size = m_pending;
+  Totals out = m_totals;
+  if (size == 0) {
+    return out;
+  }
+
+  for (std::size_t i = 0; i < size; ++i) {
+    const double equity = m_block[i];
+    out.peak = std::max(out.peak, equity);
+    if (out.peak > 0.0) {
+      out.max_drawdown =
+          std::max(out.max_drawdown, (out.peak - equity) / out.peak);
+    }
+  }
+
+  // a step starting at equity <= 0 has no return; equities are almost
+  // always positive, and then the loops below vectorize
+  std::array<double, BLOCK> returns;
+  std::size_t count = 0;
+  const bool positive =
+      m_last > 0.0 &&
+      std::all_of(m_block.begin(), m_block.begin() + (size - 1),
+                  [](double equity) { return equity > 0.0; });
+  if (positive) {
+    returns[0] = m_block[0] / m_last - 1.0;
+    for (std::size_t i = 1; i < size; ++i) {
+      returns[i] = m_block[i] / m_block[i - 1] - 1.0;
+    }
+    count = size;
+  } else {
+    double prev = m_last;
+    for (std::size_t i = 0; i < size; ++i) {
+      if (prev > 0.0) {
+        returns[count++] = m_block[i] / prev - 1.0;
+      }
+      prev = m_block[i];
+    }
+    if (count == 0) {
+      return out;
+    }
+  }
+
+  double sum = 0.0;
+  for (std::size_t i = 0; i < count; ++i) {
+    sum += returns[i];
+  }
+  const double mean = sum / static_cast<double>(count);
+  double m2 = 0.0;
+  for (std::size_t i = 0; i < count; ++i) {
+    m2 += (returns[i] - mean) * (returns[i] - mean);
+  }
+
+  // Chan et al.: combine two sets' counts, means and squared deviations
+  const std::uint64_t total = out.count + count;
+  const double delta = mean - out.mean;
+  const double weight =
+      static_cast<double>(count) / static_cast<double>(total);
+  out.m2 += m2 + delta * delta * static_cast<double>(out.count) * weight;
+  out.mean += delta * weight;
+  out.count = total;
+  return out;
+}
+
+double RunMetrics::return_stddev() const noexcept {
+  const Totals totals = settled();
+  return totals.count < 2
+             ? 0.0
+             : std::sqrt(totals.m2 / static_cast<double>(totals.count - 1));
+}
+
+double RunMetrics::sharpe(double periods_per_year) const noexcept {
+  const double stddev = return_stddev();
+  return stddev > 0.0
+             ? mean_return() / stddev * std::sqrt(periods_per_year)
+             : 0.0;
+}
+
+} // namespace chisel
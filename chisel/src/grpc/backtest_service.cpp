@@ -1,9 +1,164 @@
 #include "grpc/backtest_service.h"
+#include "engine/bar_merge.h"
+#include "engine/engine.h"
+#include "engine/portfolio_engine.h"
+#include "engine/summary.h"
+#include "grpc/snapshot_stream.h"
+#include "strategy/portfolio_strategy.h"
+#include "strategy/registry.h"
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace chisel {
 
-BacktestServiceImpl::BacktestServiceImpl() = default;
+namespace {
+/// a registry strategy PerSymbol can build one of per symbol
+class Registered {
+public:
+  explicit Registered(std::string_view name)
+      : m_strategy(make_strategy(name)) {}
+
+  void reset() { m_strategy->reset(); }
+
+  Action on_bar(const BarContext &ctx, OrderBuffer &orders) {
+    return m_strategy->on_bar(ctx, orders);
+  }
+
+  [[nodiscard]] std::span<const std::string_view> indicator_names() const {
+    return m_strategy->indicator_names();
+  }
+
+  [[nodiscard]] std::span<const double> indicator_values() const {
+    return m_strategy->indicator_values();
+  }
+
+private:
+  std::unique_ptr<IStrategy> m_strategy;
+};
+} // namespace
+
+BacktestServiceImpl::BacktestServiceImpl(bar_source bars)
+    : m_bars(std::move(bars)) {}
 
 BacktestServiceImpl::~BacktestServiceImpl() = default;
 
+grpc::Status BacktestServiceImpl::RunBackTest(
+    grpc::ServerContext *context, const marble::BacktestRequest *request,
+    grpc::ServerWriter<marble::BacktestEvent> *writer) {
+  marble::BacktestConfig config = request->config();
+  if (config.strategy_name().empty()) {
+    config.set_strategy_name(std::string{strategy_names().front()});
+  }
+  if (config.symbols_size() > 0) {
+    return run_basket(context, config, writer);
+  }
+
+  std::unique_ptr<IStrategy> strategy;
+  std::vector<Bar> bars;
+  try {
+    strategy = make_strategy(config.strategy_name());
+    bars = m_bars(config);
+  } catch (const std::invalid_argument &ex) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, ex.what()};
+  } catch (const std::exception &ex) {
+    return {grpc::StatusCode::INTERNAL, ex.what()};
+  }
+
+  const marble::SnapshotOptions &options = request->snapshots();
+  SnapshotStream stream(
+      options,
+      SnapshotEncoding{.ticker = config.symbol(),
+                       .indicator_names = strategy->indicator_names(),
+                       .intern_names = options.intern_names()},
+      [context, writer](const marble::BacktestEvent &event) {
+        return !context->IsCancelled() && writer->Write(event);
+      });
+
+  const ExecutionModel execution;
+  const EngineConfig engine_config{.snapshot_batch = stream.engine_batch(),
+                                   .sampling = to_sampling(options)};
+  DynamicBacktestEngine engine(engine_config, *strategy, execution);
+  engine.on_snapshots(
+      [&stream](std::span<const Snapshot> batch) { stream.write(batch); });
+
+  // a client that went away stops the replay, not just the writes
+  auto gone = [context, &stream]() {
+    return !stream.ok() || context->IsCancelled();
+  };
+  engine.stop_when(gone);
+
+  if (!stream.start(config)) {
+    return grpc::Status::CANCELLED;
+  }
+  const RunStats stats = engine.run(bars);
+  if (gone() || !stream.finish(summarize(engine_config, stats))) {
+    return grpc::Status::CANCELLED;
+  }
+  return grpc::Status::OK;
+}
+
+grpc::Status BacktestServiceImpl::run_basket(
+    grpc::ServerContext *context, const marble::BacktestConfig &config,
+    grpc::ServerWriter<marble::BacktestEvent> *writer) {
+  std::optional<PerSymbol<Registered>> basket;
+  std::vector<std::vector<Bar>> series;
+  try {
+    basket.emplace(static_cast<std::size_t>(config.symbols_size()),
+                   config.strategy_name());
+    for (const std::string &symbol : config.symbols()) {
+      marble::BacktestConfig one = config;
+      one.clear_symbols();
+      one.set_symbol(symbol);
+      series.push_back(m_bars(one));
+    }
+  } catch (const std::invalid_argument &ex) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, ex.what()};
+  } catch (const std::exception &ex) {
+    return {grpc::StatusCode::INTERNAL, ex.what()};
+  }
+
+  // no snapshots for portfolio runs, just started and end
+  marble::SnapshotOptions options;
+  options.set_sampling(marble::SAMPLE_NONE);
+  SnapshotStream stream(
+      options,
+      SnapshotEncoding{.ticker = {},
+                       .indicator_names =
+                           basket->strategy(0).indicator_names()},
+      [context, writer](const marble::BacktestEvent &event) {
+        return !context->IsCancelled() && writer->Write(event);
+      });
+
+  const ExecutionModel execution;
+  const EngineConfig engine_config{};
+  PortfolioEngine engine(engine_config, *basket, execution);
+  auto gone = [context, &stream]() {
+    return !stream.ok() || context->IsCancelled();
+  };
+  engine.stop_when(gone);
+
+  if (!stream.start(config)) {
+    return grpc::Status::CANCELLED;
+  }
+  RunStats stats;
+  try {
+    BarMerge merge(
+        std::vector<std::span<const Bar>>(series.begin(), series.end()));
+    stats = engine.run(merge);
+  } catch (const std::exception &ex) {
+    return {grpc::StatusCode::INTERNAL, ex.what()};
+  }
+  if (gone() || !stream.finish(summarize(engine_config, stats))) {
+    return grpc::Status::CANCELLED;
+  }
+  return grpc::Status::OK;
+}
+
 } // namespace chisel
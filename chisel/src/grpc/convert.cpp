@@ -0,0 +1,132 @@
+#include "grpc/convert.h"
+
+namespace chisel {
+
+namespace {
+marble::ActionType to_action(Action action) noexcept {
+  switch (action) {
+  case Action::buy:
+    return marble::ACTION_BUY;
+  case Action::sell:
+    return marble::ACTION_SELL;
+  case Action::hold:
+    break;
+  }
+  return marble::ACTION_HOLD;
+}
+
+marble::SideType to_side(Side side) noexcept {
+  return side == Side::buy ? marble::SIDE_BUY : marble::SIDE_SELL;
+}
+
+void to_candle(const Bar &bar, marble::AggregateBar &out) {
+  out.set_open(bar.open);
+  out.set_close(bar.close);
+  out.set_high(bar.high);
+  out.set_low(bar.low);
+  out.set_n(bar.transactions);
+  out.set_t(bar.t);
+  out.set_volume(bar.volume);
+  out.set_volume_weighted(bar.vwap);
+}
+} // namespace
+
+void to_account_state(const Account &account,
+                      std::span<const std::string> tickers,
+                      marble::AccountState &out) {
+  out.set_cash(account.cash());
+  out.set_realized_pnl(account.realized_pnl());
+  out.set_total_equity(account.equity());
+
+  out.clear_positions();
+  const auto positions = account.positions();
+  for (std::size_t s = 0; s < positions.size(); ++s) {
+    const Position &held = positions[s];
+    if (held.quantity == 0) {
+      continue;
+    }
+    marble::Position *position = out.add_positions();
+    if (s < tickers.size()) {
+      position->set_ticker(tickers[s]);
+    }
+    position->set_quantity(static_cast<std::int32_t>(held.quantity));
+    position->set_entry_price(held.entry_price());
+    position->set_unrealized_pnl(held.unrealized_pnl());
+  }
+}
+
+void to_snapshot(const Snapshot &snapshot, const SnapshotEncoding &encoding,
+                 marble::Snapshot &out) {
+  out.set_step(snapshot.step);
+  to_candle(snapshot.bar, *out.mutable_candle());
+  out.mutable_signal()->set_action(to_action(snapshot.action));
+  out.mutable_signal()->clear_reason();
+
+  if (snapshot.executed) {
+    const Fill &fill = snapshot.execution;
+    marble::Execution *execution = out.mutable_execution();
+    execution->set_side(to_side(fill.side));
+    execution->set_quantity(fill.quantity);
+    execution->set_price(fill.price);
+    execution->set_slippage(fill.slippage);
+    execution->set_commission(fill.commission);
+  } else {
+    out.clear_execution();
+  }
+
+  marble::AccountState *account = out.mutable_account();
+  account->set_cash(snapshot.cash);
+  account->set_realized_pnl(snapshot.realized_pnl);
+  account->set_total_equity(snapshot.equity);
+  account->clear_positions();
+  if (snapshot.position != 0) {
+    marble::Position *position = account->add_positions();
+    position->set_ticker(encoding.ticker.data(), encoding.ticker.size());
+    position->set_quantity(static_cast<std::int32_t>(snapshot.position));
+    position->set_entry_price(snapshot.entry_price);
+    position->set_unrealized_pnl(snapshot.unrealized_pnl);
+  }
+
+  const std::span<const double> values{snapshot.indicators.data(),
+                                       snapshot.indicator_count};
+  out.clear_indicators();
+  out.clear_indicator_values();
+  if (encoding.intern_names) {
+    out.mutable_indicator_values()->Add(values.begin(), values.end());
+    return;
+  }
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    marble::Indicator *indicator = out.add_indicators();
+    if (i < encoding.indicator_names.size()) {
+      const std::string_view name = encoding.indicator_names[i];
+      indicator->set_name(name.data(), name.size());
+    }
+    indicator->set_value(values[i]);
+  }
+}
+
+void to_summary(const BacktestSummary &summary, marble::BacktestSummary &out) {
+  out.set_start_balance(summary.start_balance);
+  out.set_end_balance(summary.end_balance);
+  out.set_return_percent(summary.return_percent);
+  out.set_max_drawdown(summary.max_drawdown);
+  out.set_trade_count(summary.trade_count);
+  out.set_win_rate(summary.win_rate);
+  out.set_sharpe_ratio(summary.sharpe_ratio);
+}
+
+SnapshotSampling to_sampling(const marble::SnapshotOptions &options) noexcept {
+  switch (options.sampling()) {
+  case marble::SAMPLE_EVERY_N:
+    return {.mode = SnapshotMode::every_n, .every = options.every()};
+  case marble::SAMPLE_ON_ACTIVITY:
+    return {.mode = SnapshotMode::on_activity};
+  case marble::SAMPLE_TIME_BUCKETED:
+    return {.mode = SnapshotMode::time_bucketed,
+            .bucket_ms = options.bucket_ms()};
+  default:
+    return {};
+  }
+}
+
+} // namespace chisel
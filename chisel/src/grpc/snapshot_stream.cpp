@@ -0,0 +1,60 @@
+#include "grpc/snapshot_stream.h"
+#include <algorithm>
+#include <utility>
+
+namespace chisel {
+
+SnapshotStream::SnapshotStream(const marble::SnapshotOptions &options,
+                               SnapshotEncoding encoding, event_writer write)
+    : m_encoding(encoding), m_write(std::move(write)),
+      m_per_event(std::max<std::size_t>(1, options.batch())),
+      m_snapshot_batch(options.sampling() == marble::SAMPLE_NONE
+                           ? 0
+                           : m_per_event) {}
+
+SnapshotStream::~SnapshotStream() = default;
+
+bool SnapshotStream::start(const marble::BacktestConfig &config) {
+  marble::BacktestStarted *started = m_event.mutable_started();
+  *started->mutable_config() = config;
+  started->clear_indicator_names();
+  for (const std::string_view name : m_encoding.indicator_names) {
+    started->add_indicator_names(name.data(), name.size());
+  }
+  return send();
+}
+
+void SnapshotStream::write(std::span<const Snapshot> snapshots) {
+  while (m_ok && !snapshots.empty()) {
+    const auto chunk =
+        snapshots.first(std::min(m_per_event, snapshots.size()));
+    snapshots = snapshots.subspan(chunk.size());
+
+    if (m_per_event == 1) {
+      to_snapshot(chunk.front(), m_encoding, *m_event.mutable_step());
+    } else {
+      // cleared elements stay allocated and add_snapshots() hands them back
+      auto *snapshot_batch = m_event.mutable_steps()->mutable_snapshots();
+      snapshot_batch->Clear();
+      for (const Snapshot &snapshot : chunk) {
+        to_snapshot(snapshot, m_encoding, *snapshot_batch->Add());
+      }
+    }
+    if (send()) {
+      m_snapshots += chunk.size();
+    }
+  }
+}
+
+bool SnapshotStream::finish(const BacktestSummary &summary) {
+  to_summary(summary, *m_event.mutable_end());
+  return send();
+}
+
+bool SnapshotStream::send() {
+  m_ok = m_ok && m_write(m_event);
+  m_events += m_ok ? 1 : 0;
+  return m_ok;
+}
+
+} // namespace chisel
@@ -1,85 +1,425 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
-#include <iostream>
+#include <format>
 #include <logging.h>
+#include <map>
+#include <memory>
+#include <optional>
 #include <print>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 
 #include "aggregates.grpc.pb.h"
+#include "client/latency_histogram.h"
 
 namespace {
+using steady = std::chrono::steady_clock;
+
+/**
+ * Undoes the t_delta encoding into absolute epoch ms; the price/volume
+ * columns are read in place from the RepeatedFields.
+ */
+std::vector<std::int64_t>
+decode_timestamps(const marble::AggregateBarColumns &columns) {
+  std::vector<std::int64_t> timestamps;
+  timestamps.reserve(static_cast<std::size_t>(columns.t_delta_size()));
+  std::int64_t t = 0;
+  for (const std::int64_t delta : columns.t_delta()) {
+    t += delta;
+    timestamps.push_back(t);
+  }
+  return timestamps;
+}
+
+/// bars in a response or stream chunk, whichever layout it came in
+std::size_t bar_count(const marble::AggregatesResponse &response) {
+  if (response.has_bar_columns()) {
+    return static_cast<std::size_t>(response.bar_columns().open_size());
+  }
+  return static_cast<std::size_t>(response.aggregate_bars_size());
+}
+
+struct CallResult {
+  grpc::Status status;
+  std::size_t bars = 0;
+  // stream only
+  std::optional<std::chrono::microseconds> first_chunk;
+};
 
 class AggregatesClient {
 public:
   explicit AggregatesClient(std::shared_ptr<grpc::Channel> channel)
       : stub_(marble::AggregatesService::NewStub(std::move(channel))) {}
 
-  void do_aggregate(marble::AggregatesResponse &response,
-                    const std::string &ticker, const std::string &from_date,
-                    const std::string &to_date,
-                    marble::timespan_options time_span) {
-    marble::AggregatesRequest request;
+  CallResult do_aggregate(const marble::AggregatesRequest &request) {
+    marble::AggregatesResponse response;
+    grpc::ClientContext context;
 
-    request.set_ticker(ticker);
-    request.set_from_date(from_date);
-    request.set_to_date(to_date);
-    request.set_time_span(time_span);
+    CallResult result;
+    result.status = stub_->GetAggregate(&context, request, &response);
+    if (!result.status.ok()) {
+      return result;
+    }
 
-    grpc::ClientContext context;
-    const grpc::Status status =
-        stub_->GetAggregate(&context, request, &response);
+    result.bars = bar_count(response);
+    if (response.has_bar_columns() &&
+        decode_timestamps(response.bar_columns()).size() != result.bars) {
+      result.status = {grpc::StatusCode::DATA_LOSS, "ragged bar columns"};
+    }
+    return result;
+  }
 
-    if (!status.ok()) {
-      auto *logger = quarry::logging::init();
-      LOG_ERROR(logger, "Unary RPC failed: {}", status.error_message());
+  /// reads the StreamAggregates chunks as they arrive
+  CallResult stream_aggregate(const marble::AggregatesRequest &request) {
+    using namespace std::chrono;
+    grpc::ClientContext context;
+    const auto start = steady::now();
+    auto reader = stub_->StreamAggregates(&context, request);
 
-      return;
+    CallResult result;
+    marble::AggregatesResponse chunk;
+    while (reader->Read(&chunk)) {
+      if (!result.first_chunk.has_value()) {
+        result.first_chunk =
+            duration_cast<microseconds>(steady::now() - start);
+      }
+      result.bars += bar_count(chunk);
     }
+    result.status = reader->Finish();
+    return result;
   }
 
 private:
   std::unique_ptr<marble::AggregatesService::Stub> stub_;
 };
 
-} // namespace
+struct DateRange {
+  std::string from;
+  std::string to;
+};
 
-int main(int argc, char **argv) {
-  using namespace std::chrono;
+/**
+ * Closed loop: `concurrency` workers each issue the next request as soon as
+ * the previous one returns.
+ *
+ * Open loop (`qps > 0`): requests are scheduled at fixed intervals and shared
+ * by the workers; latency is measured from the scheduled time, so a stalled
+ * server shows up as latency instead of silently lowering the offered load.
+ * `concurrency` then caps outstanding requests.
+ */
+struct LoadConfig {
   std::string target = "localhost:50051";
-  int iterations = 1;
+  bool streaming = false;
+  bool columnar = false;
+  std::size_t concurrency = 1;
+  double qps = 0.0;
+  std::chrono::milliseconds warmup{std::chrono::seconds{2}};
+  std::chrono::milliseconds duration{std::chrono::seconds{10}};
+  std::vector<std::string> tickers{"AAPL"};
+  std::vector<DateRange> ranges{{"2025-01-01", "2025-01-09"}};
+  std::vector<marble::timespan_options> timespans{marble::DAY};
+  std::uint32_t seed = 1;
+};
 
-  if (argc > 1) {
-    iterations = std::max(1, std::atoi(argv[1]));
+std::vector<std::string_view> split(std::string_view text, char sep) {
+  std::vector<std::string_view> parts;
+  while (!text.empty()) {
+    const auto pos = text.find(sep);
+    parts.push_back(text.substr(0, pos));
+    if (pos == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(pos + 1);
   }
+  return parts;
+}
 
-  const auto channel_start = steady_clock::now();
-  auto channel =
-      grpc::CreateChannel(target, grpc::InsecureChannelCredentials());
-  const auto channel_ready = steady_clock::now();
-
-  AggregatesClient client(channel);
-  const auto client_ready = steady_clock::now();
+marble::timespan_options parse_timespan(std::string_view name) {
+  std::string upper{name};
+  std::ranges::transform(upper, upper.begin(), [](unsigned char ch) {
+    return static_cast<char>(std::toupper(ch));
+  });
+  marble::timespan_options timespan{};
+  if (!marble::timespan_options_Parse(upper, &timespan)) {
+    throw std::invalid_argument("unknown timespan: " + std::string{name});
+  }
+  return timespan;
+}
 
-  auto print_ms = [](auto start, auto end, const char *label) {
-    const auto ms = duration_cast<microseconds>(end - start).count() / 1000.0;
-    std::cout << label << ": " << ms << " ms" << std::endl;
+/**
+ * --target=host:port --mode=unary|stream --columnar --concurrency=N
+ * --qps=R --warmup=S --duration=S --tickers=A,B --timespans=day,minute
+ * --ranges=YYYY-MM-DD:YYYY-MM-DD,... --seed=N
+ */
+LoadConfig parse_args(int argc, char **argv) {
+  LoadConfig config;
+  auto seconds = [](std::string_view value) {
+    return std::chrono::milliseconds{
+        static_cast<std::int64_t>(std::stod(std::string{value}) * 1000)};
   };
 
-  print_ms(channel_start, channel_ready, "channel setup");
-  print_ms(channel_ready, client_ready, "stub setup");
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    const auto eq = arg.find('=');
+    const auto key = arg.substr(0, eq);
+    const auto value =
+        eq == std::string_view::npos ? std::string_view{} : arg.substr(eq + 1);
 
-  for (int i = 0; i < iterations; ++i) {
-    marble::AggregatesResponse response;
-    const auto rpc_start = steady_clock::now();
-    client.do_aggregate(response, "AAPL", "2025-01-01", "2025-01-09",
-                        marble::timespan_options::DAY);
-    const auto rpc_end = steady_clock::now();
-    std::println("rpc[{}] duration {}ms", i,
-                 duration_cast<microseconds>(rpc_end - rpc_start).count() /
-                     1000.0);
+    if (key == "--target") {
+      config.target = value;
+    } else if (key == "--mode") {
+      if (value != "unary" && value != "stream") {
+        throw std::invalid_argument("--mode is unary or stream");
+      }
+      config.streaming = value == "stream";
+    } else if (key == "--columnar") {
+      config.columnar = true;
+    } else if (key == "--concurrency") {
+      config.concurrency = std::max(1UL, std::stoul(std::string{value}));
+    } else if (key == "--qps") {
+      config.qps = std::stod(std::string{value});
+    } else if (key == "--warmup") {
+      config.warmup = seconds(value);
+    } else if (key == "--duration") {
+      config.duration = seconds(value);
+    } else if (key == "--seed") {
+      config.seed = static_cast<std::uint32_t>(std::stoul(std::string{value}));
+    } else if (key == "--tickers") {
+      config.tickers.clear();
+      for (const auto ticker : split(value, ',')) {
+        config.tickers.emplace_back(ticker);
+      }
+    } else if (key == "--timespans") {
+      config.timespans.clear();
+      for (const auto timespan : split(value, ',')) {
+        config.timespans.push_back(parse_timespan(timespan));
+      }
+    } else if (key == "--ranges") {
+      config.ranges.clear();
+      for (const auto range : split(value, ',')) {
+        const auto dates = split(range, ':');
+        if (dates.size() != 2) {
+          throw std::invalid_argument("--ranges takes FROM:TO pairs");
+        }
+        config.ranges.push_back({std::string{dates[0]}, std::string{dates[1]}});
+      }
+    } else {
+      throw std::invalid_argument("unknown argument: " + std::string{arg});
+    }
+  }
+
+  if (config.tickers.empty() || config.ranges.empty() ||
+      config.timespans.empty()) {
+    throw std::invalid_argument("tickers, ranges and timespans can't be empty");
+  }
+  return config;
+}
+
+/// per-worker results, merged once the run is over
+struct WorkerStats {
+  chisel::LatencyHistogram latency;
+  chisel::LatencyHistogram first_chunk;
+  std::uint64_t ok = 0;
+  std::uint64_t bars = 0;
+  std::map<std::string, std::uint64_t> errors;
+
+  void merge(const WorkerStats &other) {
+    latency.merge(other.latency);
+    first_chunk.merge(other.first_chunk);
+    ok += other.ok;
+    bars += other.bars;
+    for (const auto &[code, count] : other.errors) {
+      errors[code] += count;
+    }
+  }
+};
+
+std::string status_name(grpc::StatusCode code) {
+  switch (code) {
+  case grpc::StatusCode::CANCELLED:
+    return "CANCELLED";
+  case grpc::StatusCode::INVALID_ARGUMENT:
+    return "INVALID_ARGUMENT";
+  case grpc::StatusCode::DEADLINE_EXCEEDED:
+    return "DEADLINE_EXCEEDED";
+  case grpc::StatusCode::RESOURCE_EXHAUSTED:
+    return "RESOURCE_EXHAUSTED";
+  case grpc::StatusCode::INTERNAL:
+    return "INTERNAL";
+  case grpc::StatusCode::UNAVAILABLE:
+    return "UNAVAILABLE";
+  case grpc::StatusCode::DATA_LOSS:
+    return "DATA_LOSS";
+  default:
+    return "CODE_" + std::to_string(static_cast<int>(code));
+  }
+}
+
+class LoadGenerator {
+public:
+  explicit LoadGenerator(LoadConfig config) : m_config(std::move(config)) {}
+
+  WorkerStats run() {
+    auto channel = grpc::CreateChannel(m_config.target,
+                                       grpc::InsecureChannelCredentials());
+    AggregatesClient client{channel};
+
+    m_start = steady::now();
+    m_measure_from = m_start + m_config.warmup;
+    m_stop = m_measure_from + m_config.duration;
+
+    std::vector<WorkerStats> stats(m_config.concurrency);
+    {
+      std::vector<std::jthread> workers;
+      workers.reserve(m_config.concurrency);
+      for (std::size_t i = 0; i < m_config.concurrency; ++i) {
+        workers.emplace_back([this, &client, &stats, i]() {
+          work(client, stats[i], static_cast<std::uint32_t>(i));
+        });
+      }
+    }
+
+    WorkerStats total;
+    for (const auto &worker : stats) {
+      total.merge(worker);
+    }
+    return total;
+  }
+
+  [[nodiscard]] const LoadConfig &config() const noexcept { return m_config; }
+
+private:
+  LoadConfig m_config;
+  steady::time_point m_start;
+  steady::time_point m_measure_from;
+  steady::time_point m_stop;
+  std::atomic<std::uint64_t> m_next_slot{0};
+
+  /// open loop: claims the next slot, @return its scheduled time
+  steady::time_point next_scheduled() {
+    const auto slot = m_next_slot.fetch_add(1);
+    const auto offset = std::chrono::duration<double>(
+        static_cast<double>(slot) / m_config.qps);
+    return m_start + std::chrono::duration_cast<steady::duration>(offset);
+  }
+
+  marble::AggregatesRequest pick(std::mt19937 &rng) const {
+    auto any = [&rng](const auto &items) -> const auto & {
+      std::uniform_int_distribution<std::size_t> index(0, items.size() - 1);
+      return items[index(rng)];
+    };
+    const auto &range = any(m_config.ranges);
+
+    marble::AggregatesRequest request;
+    request.set_ticker(any(m_config.tickers));
+    request.set_from_date(range.from);
+    request.set_to_date(range.to);
+    request.set_time_span(any(m_config.timespans));
+    request.set_columnar(m_config.columnar);
+    return request;
+  }
+
+  void work(AggregatesClient &client, WorkerStats &stats,
+            std::uint32_t worker) {
+    using namespace std::chrono;
+    std::mt19937 rng{m_config.seed + worker};
+
+    while (true) {
+      auto started = steady::now();
+      if (m_config.qps > 0.0) {
+        started = next_scheduled();
+        std::this_thread::sleep_until(started);
+      }
+      if (started >= m_stop) {
+        return;
+      }
+
+      const auto request = pick(rng);
+      const CallResult result = m_config.streaming
+                                    ? client.stream_aggregate(request)
+                                    : client.do_aggregate(request);
+      if (started < m_measure_from) {
+        continue;
+      }
+
+      if (!result.status.ok()) {
+        ++stats.errors[status_name(result.status.error_code())];
+        continue;
+      }
+      ++stats.ok;
+      stats.bars += result.bars;
+      stats.latency.record(static_cast<std::uint64_t>(
+          duration_cast<microseconds>(steady::now() - started).count()));
+      if (result.first_chunk.has_value()) {
+        // from the actual send, the scheduling delay is in `latency`
+        stats.first_chunk.record(
+            static_cast<std::uint64_t>(result.first_chunk->count()));
+      }
+    }
+  }
+};
+
+std::string histogram_json(const chisel::LatencyHistogram &histogram) {
+  return std::format(
+      R"({{"count":{},"min":{},"mean":{:.1f},"p50":{},"p90":{},"p99":{},)"
+      R"("p99.9":{},"max":{}}})",
+      histogram.count(), histogram.min(), histogram.mean(),
+      histogram.percentile(0.50), histogram.percentile(0.90),
+      histogram.percentile(0.99), histogram.percentile(0.999),
+      histogram.max());
+}
+
+/// one JSON object on stdout, latencies in microseconds
+void report(const LoadConfig &config, const WorkerStats &total) {
+  const double seconds =
+      std::chrono::duration<double>(config.duration).count();
+  std::uint64_t error_count = 0;
+  std::string errors;
+  for (const auto &[code, count] : total.errors) {
+    errors += std::format("{}\"{}\":{}", errors.empty() ? "" : ",", code,
+                          count);
+    error_count += count;
+  }
+
+  std::println(
+      R"({{"mode":"{}","columnar":{},"concurrency":{},"target_qps":{},)"
+      R"("duration_s":{},"ok":{},"errors":{},"error_codes":{{{}}},)"
+      R"("throughput_rps":{:.2f},"bars":{},"latency_us":{}{}}})",
+      config.streaming ? "stream" : "unary", config.columnar,
+      config.concurrency, config.qps, seconds, total.ok, error_count, errors,
+      seconds > 0 ? static_cast<double>(total.ok) / seconds : 0.0, total.bars,
+      histogram_json(total.latency),
+      config.streaming
+          ? ",\"first_chunk_us\":" + histogram_json(total.first_chunk)
+          : std::string{});
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  auto *logger = quarry::logging::init();
+
+  LoadConfig config;
+  try {
+    config = parse_args(argc, argv);
+  } catch (const std::exception &ex) {
+    LOG_ERROR(logger, "Bad arguments: {}", ex.what());
+    return 1;
   }
 
+  LoadGenerator generator{std::move(config)};
+  const WorkerStats total = generator.run();
+  report(generator.config(), total);
   return 0;
 }
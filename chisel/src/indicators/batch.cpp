@@ -0,0 +1,206 @@
+#include "indicators/batch.h"
+#include "batch_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace chisel::batch {
+
+namespace {
+const detail::Kernels &kernels(Simd simd) noexcept {
+#if defined(CHISEL_BATCH_X86)
+  switch (std::min(simd, best_simd())) {
+  case Simd::avx512:
+    return detail::avx512_kernels();
+  case Simd::avx2:
+    return detail::avx2_kernels();
+  case Simd::scalar:
+    break;
+  }
+#else
+  (void)simd;
+#endif
+  return detail::scalar_kernels();
+}
+
+void require_fits(std::size_t in, std::size_t out) {
+  if (out < in) {
+    throw std::invalid_argument("batch output shorter than its input");
+  }
+}
+
+void require_window(std::size_t window) {
+  if (window == 0) {
+    throw std::invalid_argument("batch window must be positive");
+  }
+}
+} // namespace
+
+Simd best_simd() noexcept {
+#if defined(CHISEL_BATCH_X86)
+  static const Simd best = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return Simd::avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return Simd::avx2;
+    }
+    return Simd::scalar;
+  }();
+  return best;
+#else
+  return Simd::scalar;
+#endif
+}
+
+std::string_view simd_name(Simd simd) noexcept {
+  switch (simd) {
+  case Simd::avx2:
+    return "avx2";
+  case Simd::avx512:
+    return "avx512";
+  case Simd::scalar:
+    break;
+  }
+  return "scalar";
+}
+
+void rolling_mean(std::span<const double> in, std::size_t window,
+                  std::span<double> out) {
+  require_window(window);
+  require_fits(in.size(), out.size());
+  const auto divisor = static_cast<double>(window);
+  const std::size_t warm = std::min(window, in.size());
+
+  double sum = 0.0;
+  for (std::size_t i = 0; i < warm; ++i) {
+    // nothing leaves a filling window, Sma subtracts 0.0
+    sum += in[i] - 0.0;
+    out[i] = i + 1 == window ? sum / divisor : 0.0;
+  }
+  for (std::size_t i = warm; i < in.size(); ++i) {
+    sum += in[i] - in[i - window];
+    out[i] = sum / divisor;
+  }
+}
+
+void rolling_mean_lanes(std::span<const double> in,
+                        std::span<const std::size_t> windows,
+                        std::span<double> out, Simd simd) {
+  std::ranges::for_each(windows, require_window);
+  require_fits(in.size() * windows.size(), out.size());
+  std::vector<double> sums(windows.size());
+  kernels(simd).rolling_mean_lanes(in.data(), in.size(), windows.data(),
+                                   windows.size(), sums.data(), out.data());
+}
+
+void rolling_stddev(std::span<const double> in, std::size_t window,
+                    std::span<double> out) {
+  require_window(window);
+  require_fits(in.size(), out.size());
+  const auto count = static_cast<double>(window);
+
+  // the same windowed Welford steps as Bollinger::update
+  double mean = 0.0;
+  double m2 = 0.0;
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    if (i < window) {
+      const double delta = in[i] - mean;
+      mean += delta / static_cast<double>(i + 1);
+      m2 += delta * (in[i] - mean);
+    } else {
+      const double evicted = in[i - window];
+      const double prev_mean = mean;
+      mean += (in[i] - evicted) / count;
+      m2 += (in[i] - evicted) * (in[i] - mean + evicted - prev_mean);
+    }
+    if (i + 1 < window) {
+      out[i] = 0.0;
+      continue;
+    }
+    const double variance = m2 / count;
+    out[i] = variance > 0.0 ? std::sqrt(variance) : 0.0;
+  }
+}
+
+void ema(std::span<const double> in, std::size_t period,
+         std::span<double> out) {
+  require_window(period);
+  require_fits(in.size(), out.size());
+  // one lane is the scalar kernel
+  double value = 0.0;
+  detail::scalar_kernels().ema_lanes(in.data(), in.size(), &period, 1,
+                                     &value, out.data());
+}
+
+void ema_lanes(std::span<const double> in,
+               std::span<const std::size_t> periods, std::span<double> out,
+               Simd simd) {
+  std::ranges::for_each(periods, require_window);
+  require_fits(in.size() * periods.size(), out.size());
+  std::vector<double> values(periods.size());
+  kernels(simd).ema_lanes(in.data(), in.size(), periods.data(),
+                          periods.size(), values.data(), out.data());
+}
+
+void true_range(std::span<const double> high, std::span<const double> low,
+                std::span<const double> close, std::span<double> out,
+                Simd simd) {
+  if (low.size() != high.size() || close.size() != high.size()) {
+    throw std::invalid_argument("true_range columns differ in length");
+  }
+  require_fits(high.size(), out.size());
+  if (high.empty()) {
+    return;
+  }
+  out[0] = high[0] - low[0];
+  kernels(simd).true_range(high.data(), low.data(), close.data(),
+                           high.size(), out.data());
+}
+
+void returns(std::span<const double> close, std::span<double> out,
+             Simd simd) {
+  require_fits(close.size(), out.size());
+  if (close.empty()) {
+    return;
+  }
+  out[0] = 0.0;
+  kernels(simd).ratio(close.data(), 1.0, close.size(), out.data());
+}
+
+void log_returns(std::span<const double> close, std::span<double> out,
+                 Simd simd) {
+  require_fits(close.size(), out.size());
+  if (close.empty()) {
+    return;
+  }
+  out[0] = 0.0;
+  kernels(simd).ratio(close.data(), 0.0, close.size(), out.data());
+  for (std::size_t i = 1; i < close.size(); ++i) {
+    out[i] = std::log(out[i]);
+  }
+}
+
+void crosses(std::span<const double> fast, std::span<const double> slow,
+             std::size_t from, std::span<std::int8_t> out, Simd simd) {
+  if (slow.size() != fast.size()) {
+    throw std::invalid_argument("crosses columns differ in length");
+  }
+  require_fits(fast.size(), out.size());
+  const std::size_t n = fast.size();
+  std::fill_n(out.begin(), std::min(from, n), std::int8_t{0});
+  if (from >= n) {
+    return;
+  }
+
+  // the spread before `from` counts as 0
+  const double spread = fast[from] - slow[from];
+  out[from] = spread > 0.0   ? std::int8_t{1}
+              : spread < 0.0 ? std::int8_t{-1}
+                             : std::int8_t{0};
+  kernels(simd).crosses(fast.data(), slow.data(), from + 1, n, out.data());
+}
+
+} // namespace chisel::batch
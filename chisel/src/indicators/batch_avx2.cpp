@@ -0,0 +1,43 @@
+// Compiled with -mavx2 (no -mfma), only called once the CPU reports AVX2.
+#include "batch_kernels.h"
+#include <immintrin.h>
+
+namespace chisel::batch::detail {
+
+namespace {
+struct Avx2 {
+  using reg = __m256d;
+  using mask = __m256d;
+  static constexpr std::size_t width = 4;
+
+  static reg load(const double *p) { return _mm256_loadu_pd(p); }
+  static void store(double *p, reg v) { _mm256_storeu_pd(p, v); }
+  static reg set1(double x) { return _mm256_set1_pd(x); }
+  static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+  static reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+  static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+  static reg div(reg a, reg b) { return _mm256_div_pd(a, b); }
+  // a > b ? a : b per lane, ties and NaNs included
+  static reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+  static reg abs(reg v) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v); }
+  static __m256i load_offsets(const std::int64_t *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  }
+  static reg gather(const double *base, __m256i offsets) {
+    return _mm256_i64gather_pd(base, offsets, sizeof(double));
+  }
+
+  static mask gt(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+  static mask ge(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+  static mask lt(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static mask le(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+  static mask both(mask a, mask b) { return _mm256_and_pd(a, b); }
+  static unsigned bits(mask m) {
+    return static_cast<unsigned>(_mm256_movemask_pd(m));
+  }
+};
+} // namespace
+
+const Kernels &avx2_kernels() noexcept { return KernelSet<Avx2>::table; }
+
+} // namespace chisel::batch::detail
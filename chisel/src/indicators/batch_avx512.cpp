@@ -0,0 +1,41 @@
+// Compiled with -mavx512f, only called once the CPU reports AVX-512F.
+#include "batch_kernels.h"
+#include <immintrin.h>
+
+namespace chisel::batch::detail {
+
+namespace {
+struct Avx512 {
+  using reg = __m512d;
+  using mask = __mmask8;
+  static constexpr std::size_t width = 8;
+
+  static reg load(const double *p) { return _mm512_loadu_pd(p); }
+  static void store(double *p, reg v) { _mm512_storeu_pd(p, v); }
+  static reg set1(double x) { return _mm512_set1_pd(x); }
+  static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+  static reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+  static reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+  static reg div(reg a, reg b) { return _mm512_div_pd(a, b); }
+  // a > b ? a : b per lane, ties and NaNs included
+  static reg max(reg a, reg b) { return _mm512_max_pd(a, b); }
+  static reg abs(reg v) { return _mm512_abs_pd(v); }
+  static __m512i load_offsets(const std::int64_t *p) {
+    return _mm512_loadu_si512(p);
+  }
+  static reg gather(const double *base, __m512i offsets) {
+    return _mm512_i64gather_pd(offsets, base, sizeof(double));
+  }
+
+  static mask gt(reg a, reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+  static mask ge(reg a, reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+  static mask lt(reg a, reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+  static mask le(reg a, reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+  static mask both(mask a, mask b) { return static_cast<mask>(a & b); }
+  static unsigned bits(mask m) { return m; }
+};
+} // namespace
+
+const Kernels &avx512_kernels() noexcept { return KernelSet<Avx512>::table; }
+
+} // namespace chisel::batch::detail
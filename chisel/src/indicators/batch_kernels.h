@@ -0,0 +1,228 @@
+#ifndef CHISEL_INDICATORS_BATCH_KERNELS_H
+#define CHISEL_INDICATORS_BATCH_KERNELS_H
+
+// Included by one translation unit per instruction set, each compiled with
+// its own -m flags. Only intrinsics and fundamental types in here: an inline
+// std:: function instantiated under -mavx512f could be the copy the linker
+// keeps for everyone.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace chisel::batch::detail {
+
+/// raw-pointer kernels one instruction set provides, `n` is the series length
+struct Kernels {
+  // i in [1, n)
+  void (*true_range)(const double *high, const double *low,
+                     const double *close, std::size_t n, double *out);
+  // out[i] = close[i] / close[i - 1] - minus for i in [1, n)
+  void (*ratio)(const double *close, double minus, std::size_t n,
+                double *out);
+  // i in [from, n), from >= 1
+  void (*crosses)(const double *fast, const double *slow, std::size_t from,
+                  std::size_t n, std::int8_t *out);
+  // interleaved, see batch.h; `state` holds one zeroed double per lane
+  void (*rolling_mean_lanes)(const double *in, std::size_t n,
+                             const std::size_t *windows, std::size_t lanes,
+                             double *state, double *out);
+  void (*ema_lanes)(const double *in, std::size_t n,
+                    const std::size_t *periods, std::size_t lanes,
+                    double *state, double *out);
+};
+
+const Kernels &scalar_kernels() noexcept;
+const Kernels &avx2_kernels() noexcept;
+const Kernels &avx512_kernels() noexcept;
+
+/**
+ * Kernel bodies over a vector type `V` (width, loads, gathers, arithmetic,
+ * compare masks). Tails and warm-ups use plain doubles doing the same
+ * operations, so every instantiation, including the width-1 scalar one,
+ * rounds identically.
+ */
+template <typename V> struct KernelSet {
+  static constexpr std::size_t W = V::width;
+  // lanes sweep the series in blocks of rows, so the interleaved rows they
+  // write stay in cache from one lane group to the next
+  static constexpr std::size_t BLOCK_ROWS = 128;
+
+  static void true_range(const double *high, const double *low,
+                         const double *close, std::size_t n, double *out) {
+    std::size_t i = 1;
+    for (; i + W <= n; i += W) {
+      const auto h = V::load(high + i);
+      const auto l = V::load(low + i);
+      const auto prev = V::load(close + i - 1);
+      const auto range = V::sub(h, l);
+      const auto wider =
+          V::max(V::abs(V::sub(h, prev)), V::abs(V::sub(l, prev)));
+      V::store(out + i, V::max(range, wider));
+    }
+    for (; i < n; ++i) {
+      const double range = high[i] - low[i];
+      const double up = __builtin_fabs(high[i] - close[i - 1]);
+      const double down = __builtin_fabs(low[i] - close[i - 1]);
+      const double wider = up > down ? up : down;
+      out[i] = range > wider ? range : wider;
+    }
+  }
+
+  static void ratio(const double *close, double minus, std::size_t n,
+                    double *out) {
+    const auto m = V::set1(minus);
+    std::size_t i = 1;
+    for (; i + W <= n; i += W) {
+      V::store(out + i,
+               V::sub(V::div(V::load(close + i), V::load(close + i - 1)), m));
+    }
+    for (; i < n; ++i) {
+      out[i] = close[i] / close[i - 1] - minus;
+    }
+  }
+
+  static void crosses(const double *fast, const double *slow,
+                      std::size_t from, std::size_t n, std::int8_t *out) {
+    const auto zero = V::set1(0.0);
+    std::size_t i = from;
+    for (; i + W <= n; i += W) {
+      const auto spread = V::sub(V::load(fast + i), V::load(slow + i));
+      const auto prev = V::sub(V::load(fast + i - 1), V::load(slow + i - 1));
+      const unsigned up =
+          V::bits(V::both(V::le(prev, zero), V::gt(spread, zero)));
+      const unsigned down =
+          V::bits(V::both(V::ge(prev, zero), V::lt(spread, zero)));
+      for (std::size_t k = 0; k < W; ++k) {
+        out[i + k] = static_cast<std::int8_t>(
+            static_cast<int>((up >> k) & 1U) -
+            static_cast<int>((down >> k) & 1U));
+      }
+    }
+    for (; i < n; ++i) {
+      const double spread = fast[i] - slow[i];
+      const double prev = fast[i - 1] - slow[i - 1];
+      out[i] = prev <= 0.0 && spread > 0.0   ? std::int8_t{1}
+               : prev >= 0.0 && spread < 0.0 ? std::int8_t{-1}
+                                             : std::int8_t{0};
+    }
+  }
+
+  static double alpha_of(std::size_t period) {
+    return 2.0 / (static_cast<double>(period) + 1.0);
+  }
+
+  static std::size_t widest(const std::size_t *windows, std::size_t lanes,
+                            std::size_t n) {
+    std::size_t out = 0;
+    for (std::size_t k = 0; k < lanes; ++k) {
+      out = windows[k] > out ? windows[k] : out;
+    }
+    return out < n ? out : n;
+  }
+
+  static void rolling_mean_lanes(const double *in, std::size_t n,
+                                 const std::size_t *windows,
+                                 std::size_t lanes, double *sums,
+                                 double *out) {
+    // lanes step one by one, as Sma::update would, until every window is
+    // full; from there on each lane evicts on every bar
+    const std::size_t warm = widest(windows, lanes, n);
+    for (std::size_t i = 0; i < warm; ++i) {
+      for (std::size_t k = 0; k < lanes; ++k) {
+        const std::size_t window = windows[k];
+        sums[k] += in[i] - (i >= window ? in[i - window] : 0.0);
+        out[i * lanes + k] =
+            i + 1 >= window ? sums[k] / static_cast<double>(window) : 0.0;
+      }
+    }
+
+    for (std::size_t begin = warm; begin < n; begin += BLOCK_ROWS) {
+      const std::size_t end = begin + BLOCK_ROWS < n ? begin + BLOCK_ROWS : n;
+      std::size_t lane = 0;
+      for (; lane + W <= lanes; lane += W) {
+        std::int64_t back[W];
+        double divisors[W];
+        for (std::size_t k = 0; k < W; ++k) {
+          back[k] = -static_cast<std::int64_t>(windows[lane + k]);
+          divisors[k] = static_cast<double>(windows[lane + k]);
+        }
+        const auto offsets = V::load_offsets(back);
+        const auto divisor = V::load(divisors);
+        auto sum = V::load(sums + lane);
+        for (std::size_t i = begin; i < end; ++i) {
+          sum = V::add(sum,
+                       V::sub(V::set1(in[i]), V::gather(in + i, offsets)));
+          V::store(out + i * lanes + lane, V::div(sum, divisor));
+        }
+        V::store(sums + lane, sum);
+      }
+      for (; lane < lanes; ++lane) {
+        const std::size_t window = windows[lane];
+        for (std::size_t i = begin; i < end; ++i) {
+          sums[lane] += in[i] - in[i - window];
+          out[i * lanes + lane] = sums[lane] / static_cast<double>(window);
+        }
+      }
+    }
+  }
+
+  static void ema_lanes(const double *in, std::size_t n,
+                        const std::size_t *periods, std::size_t lanes,
+                        double *values, double *out) {
+    // seeding as Ema::update does it, a running sum divided once full
+    const std::size_t warm = widest(periods, lanes, n);
+    for (std::size_t i = 0; i < warm; ++i) {
+      for (std::size_t k = 0; k < lanes; ++k) {
+        const std::size_t period = periods[k];
+        if (i < period) {
+          values[k] += in[i];
+          if (i + 1 == period) {
+            values[k] /= static_cast<double>(period);
+          }
+          out[i * lanes + k] = i + 1 == period ? values[k] : 0.0;
+        } else {
+          values[k] += alpha_of(period) * (in[i] - values[k]);
+          out[i * lanes + k] = values[k];
+        }
+      }
+    }
+
+    for (std::size_t begin = warm; begin < n; begin += BLOCK_ROWS) {
+      const std::size_t end = begin + BLOCK_ROWS < n ? begin + BLOCK_ROWS : n;
+      std::size_t lane = 0;
+      for (; lane + W <= lanes; lane += W) {
+        double alphas[W];
+        for (std::size_t k = 0; k < W; ++k) {
+          alphas[k] = alpha_of(periods[lane + k]);
+        }
+        const auto alpha = V::load(alphas);
+        auto value = V::load(values + lane);
+        for (std::size_t i = begin; i < end; ++i) {
+          value =
+              V::add(value, V::mul(alpha, V::sub(V::set1(in[i]), value)));
+          V::store(out + i * lanes + lane, value);
+        }
+        V::store(values + lane, value);
+      }
+      for (; lane < lanes; ++lane) {
+        const double alpha = alpha_of(periods[lane]);
+        for (std::size_t i = begin; i < end; ++i) {
+          values[lane] += alpha * (in[i] - values[lane]);
+          out[i * lanes + lane] = values[lane];
+        }
+      }
+    }
+  }
+
+  static constexpr Kernels table{
+      .true_range = &true_range,
+      .ratio = &ratio,
+      .crosses = &crosses,
+      .rolling_mean_lanes = &rolling_mean_lanes,
+      .ema_lanes = &ema_lanes,
+  };
+};
+
+} // namespace chisel::batch::detail
+
+#endif // CHISEL_INDICATORS_BATCH_KERNELS_H
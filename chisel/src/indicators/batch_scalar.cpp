@@ -0,0 +1,39 @@
+#include "batch_kernels.h"
+
+namespace chisel::batch::detail {
+
+namespace {
+/// one double wide, the fallback on CPUs without AVX2 and off x86
+struct Scalar {
+  using reg = double;
+  using mask = bool;
+  static constexpr std::size_t width = 1;
+
+  static reg load(const double *p) { return *p; }
+  static void store(double *p, reg v) { *p = v; }
+  static reg set1(double x) { return x; }
+  static reg add(reg a, reg b) { return a + b; }
+  static reg sub(reg a, reg b) { return a - b; }
+  static reg mul(reg a, reg b) { return a * b; }
+  static reg div(reg a, reg b) { return a / b; }
+  static reg max(reg a, reg b) { return a > b ? a : b; }
+  static reg abs(reg v) { return __builtin_fabs(v); }
+  static std::int64_t load_offsets(const std::int64_t *p) { return *p; }
+  static reg gather(const double *base, std::int64_t offset) {
+    return base[offset];
+  }
+
+  static mask gt(reg a, reg b) { return a > b; }
+  static mask ge(reg a, reg b) { return a >= b; }
+  static mask lt(reg a, reg b) { return a < b; }
+  static mask le(reg a, reg b) { return a <= b; }
+  static mask both(mask a, mask b) { return a && b; }
+  static unsigned bits(mask m) { return m ? 1U : 0U; }
+};
+} // namespace
+
+const Kernels &scalar_kernels() noexcept {
+  return KernelSet<Scalar>::table;
+}
+
+} // namespace chisel::batch::detail
@@ -1,9 +1,31 @@
 #include "strategy/ma_crossover.h"
+#include <format>
+#include <stdexcept>
 
 namespace chisel {
 
-MACrossover::MACrossover() = default;
+namespace {
+std::size_t checked_fast(std::size_t fast, std::size_t slow) {
+  if (fast == 0 || slow <= fast) {
+    throw std::invalid_argument("MACrossover needs 0 < fast < slow");
+  }
+  return fast;
+}
+} // namespace
+
+MACrossover::MACrossover(std::size_t fast, std::size_t slow,
+                         std::int32_t quantity)
+    : m_fast(checked_fast(fast, slow)), m_slow(slow), m_quantity(quantity),
+      m_names{std::format("sma({})", fast), std::format("sma({})", slow)},
+      m_name_views{m_names[0], m_names[1]} {}
 
 MACrossover::~MACrossover() = default;
 
+void MACrossover::reset() {
+  m_fast.reset();
+  m_slow.reset();
+  m_prev_spread = 0.0;
+  m_values = {};
+}
+
 } // namespace chisel
@@ -0,0 +1,32 @@
+#include "strategy/registry.h"
+#include "strategy/erased_strategy.h"
+#include "strategy/ma_crossover.h"
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace chisel {
+
+namespace {
+// NOLINTNEXTLINE
+constexpr std::array<std::string_view, 1> NAMES = {"ma_crossover"};
+
+// NOLINTNEXTLINE
+constexpr std::size_t MA_FAST = 10;
+// NOLINTNEXTLINE
+constexpr std::size_t MA_SLOW = 50;
+// NOLINTNEXTLINE
+constexpr std::int32_t MA_QUANTITY = 100;
+} // namespace
+
+std::unique_ptr<IStrategy> make_strategy(std::string_view name) {
+  if (name == "ma_crossover") {
+    return std::make_unique<ErasedStrategy<MACrossover>>(MA_FAST, MA_SLOW,
+                                                         MA_QUANTITY);
+  }
+  throw std::invalid_argument("unknown strategy: " + std::string{name});
+}
+
+std::span<const std::string_view> strategy_names() noexcept { return NAMES; }
+
+} // namespace chisel
@@ -0,0 +1,142 @@
+#include "sweep/param_space.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace chisel {
+
+namespace {
+// absorbs (hi - lo) / step landing just under a whole number
+// NOLINTNEXTLINE
+constexpr double STEP_EPSILON = 1e-9;
+
+bool continuous(const Dimension &dim) { return dim.step == 0.0; }
+
+/// how many values a stepped dimension takes
+std::size_t steps_in(const Dimension &dim) {
+  return static_cast<std::size_t>(
+             std::floor((dim.hi - dim.lo) / dim.step + STEP_EPSILON)) +
+         1;
+}
+
+double step_value(const Dimension &dim, std::size_t index) {
+  return dim.lo + static_cast<double>(index) * dim.step;
+}
+
+/// `u` in [0, 1) to a value of `dim`
+double value_at(const Dimension &dim, double u) {
+  if (continuous(dim)) {
+    return dim.lo + u * (dim.hi - dim.lo);
+  }
+  const std::size_t count = steps_in(dim);
+  const auto index = static_cast<std::size_t>(u * static_cast<double>(count));
+  return step_value(dim, std::min(index, count - 1));
+}
+} // namespace
+
+ParamGrid::ParamGrid(std::vector<Dimension> dimensions)
+    : m_dimensions(std::move(dimensions)) {
+  for (const auto &dim : m_dimensions) {
+    if (dim.hi < dim.lo || dim.step < 0.0) {
+      throw std::invalid_argument("bad range for parameter " + dim.name);
+    }
+  }
+}
+
+void ParamGrid::add(std::span<const double> point) {
+  if (point.size() != m_dimensions.size()) {
+    throw std::invalid_argument("point needs one value per dimension");
+  }
+  m_values.insert(m_values.end(), point.begin(), point.end());
+}
+
+ParamGrid full_grid(std::vector<Dimension> dimensions) {
+  ParamGrid grid(std::move(dimensions));
+  const auto dims = grid.dimensions();
+  if (dims.empty()) {
+    return grid;
+  }
+
+  std::vector<std::size_t> counts(dims.size());
+  for (std::size_t d = 0; d < dims.size(); ++d) {
+    if (continuous(dims[d]) && dims[d].lo < dims[d].hi) {
+      throw std::invalid_argument("can't grid continuous parameter " +
+                                  dims[d].name);
+    }
+    counts[d] = continuous(dims[d]) ? 1 : steps_in(dims[d]);
+  }
+
+  // an odometer over the step indices
+  std::vector<std::size_t> index(dims.size(), 0);
+  std::vector<double> point(dims.size());
+  for (;;) {
+    for (std::size_t d = 0; d < dims.size(); ++d) {
+      point[d] =
+          continuous(dims[d]) ? dims[d].lo : step_value(dims[d], index[d]);
+    }
+    grid.add(point);
+
+    std::size_t d = dims.size();
+    while (d > 0 && ++index[d - 1] == counts[d - 1]) {
+      index[d - 1] = 0;
+      --d;
+    }
+    if (d == 0) {
+      return grid;
+    }
+  }
+}
+
+ParamGrid random_sample(std::vector<Dimension> dimensions, std::size_t count,
+                        std::uint64_t seed) {
+  ParamGrid grid(std::move(dimensions));
+  const auto dims = grid.dimensions();
+  std::mt19937_64 rng{seed};
+  std::uniform_real_distribution<double> unit{0.0, 1.0};
+
+  std::vector<double> point(dims.size());
+  for (std::size_t i = 0; i < count && !dims.empty(); ++i) {
+    for (std::size_t d = 0; d < dims.size(); ++d) {
+      point[d] = value_at(dims[d], unit(rng));
+    }
+    grid.add(point);
+  }
+  return grid;
+}
+
+ParamGrid latin_hypercube(std::vector<Dimension> dimensions,
+                          std::size_t count, std::uint64_t seed) {
+  ParamGrid grid(std::move(dimensions));
+  const auto dims = grid.dimensions();
+  if (dims.empty() || count == 0) {
+    return grid;
+  }
+  std::mt19937_64 rng{seed};
+  std::uniform_real_distribution<double> unit{0.0, 1.0};
+
+  // strata[d * count + i] is the stratum point i takes on dimension d
+  std::vector<std::size_t> strata(dims.size() * count);
+  for (std::size_t d = 0; d < dims.size(); ++d) {
+    const auto begin = strata.begin() + static_cast<std::ptrdiff_t>(d * count);
+    const auto end = begin + static_cast<std::ptrdiff_t>(count);
+    std::iota(begin, end, std::size_t{0});
+    std::shuffle(begin, end, rng);
+  }
+
+  const auto n = static_cast<double>(count);
+  std::vector<double> point(dims.size());
+  for (std::size_t i = 0; i < count; ++i) {
+    for (std::size_t d = 0; d < dims.size(); ++d) {
+      const double u =
+          (static_cast<double>(strata[d * count + i]) + unit(rng)) / n;
+      point[d] = value_at(dims[d], std::min(u, std::nextafter(1.0, 0.0)));
+    }
+    grid.add(point);
+  }
+  return grid;
+}
+
+} // namespace chisel
@@ -0,0 +1,75 @@
+#include "sweep/sweep.h"
+#include <algorithm>
+#include <utility>
+
+namespace chisel {
+
+SweepCollector::SweepCollector(const SweepConfig &config, std::size_t workers,
+                               result_sink on_result)
+    : m_rank_by(config.rank_by), m_lower_is_better(config.lower_is_better),
+      m_top_k(config.top_k), m_kept(workers),
+      m_on_result(std::move(on_result)) {
+  for (auto &kept : m_kept) {
+    kept.results.reserve(m_top_k);
+  }
+}
+
+SweepCollector::~SweepCollector() = default;
+
+bool SweepCollector::better(const SweepResult &a,
+                            const SweepResult &b) const noexcept {
+  const double x = a.summary.*m_rank_by;
+  const double y = b.summary.*m_rank_by;
+  if (x != y) {
+    return m_lower_is_better ? x < y : x > y;
+  }
+  return a.point < b.point;
+}
+
+void SweepCollector::add(std::size_t worker, const SweepResult &result) {
+  if (m_on_result) {
+    const std::lock_guard lock(m_sink_mutex);
+    m_on_result(result);
+  }
+
+  auto &results = m_kept[worker].results;
+  if (m_top_k == 0) {
+    results.push_back(result);
+    return;
+  }
+  // ordered by better(), a max-heap keeps the worst result on top
+  const auto worse = [this](const SweepResult &a, const SweepResult &b) {
+    return better(a, b);
+  };
+  if (results.size() < m_top_k) {
+    results.push_back(result);
+    std::ranges::push_heap(results, worse);
+    return;
+  }
+  if (better(result, results.front())) {
+    std::ranges::pop_heap(results, worse);
+    results.back() = result;
+    std::ranges::push_heap(results, worse);
+  }
+}
+
+std::vector<SweepResult> SweepCollector::take() {
+  std::vector<SweepResult> merged;
+  for (auto &kept : m_kept) {
+    merged.insert(merged.end(), kept.results.begin(), kept.results.end());
+    kept.results.clear();
+  }
+  const auto order = [this](const SweepResult &a, const SweepResult &b) {
+    return better(a, b);
+  };
+  if (m_top_k != 0 && merged.size() > m_top_k) {
+    const auto kept = merged.begin() + static_cast<std::ptrdiff_t>(m_top_k);
+    std::ranges::partial_sort(merged, kept, order);
+    merged.resize(m_top_k);
+  } else {
+    std::ranges::sort(merged, order);
+  }
+  return merged;
+}
+
+} // namespace chisel
@@ -0,0 +1,101 @@
+#include "sweep/work_stealing_pool.h"
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace chisel {
+
+WorkStealingPool::WorkStealingPool(std::size_t threads)
+    : m_threads(threads != 0
+                    ? threads
+                    : std::max(1U, std::thread::hardware_concurrency())),
+      m_slices(m_threads) {}
+
+WorkStealingPool::~WorkStealingPool() = default;
+
+void WorkStealingPool::run(std::size_t tasks, const task &fn) {
+  m_steals = 0;
+  for (std::size_t w = 0; w < m_threads; ++w) {
+    const std::lock_guard lock(m_slices[w].mutex);
+    m_slices[w].begin = tasks * w / m_threads;
+    m_slices[w].end = tasks * (w + 1) / m_threads;
+  }
+
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(m_threads);
+    for (std::size_t w = 0; w < m_threads; ++w) {
+      workers.emplace_back([this, w, &fn, &error_mutex, &error]() {
+        std::size_t index = 0;
+        while (pop(w, index) || steal(w, index)) {
+          try {
+            fn(index, w);
+          } catch (...) {
+            const std::lock_guard lock(error_mutex);
+            if (!error) {
+              error = std::current_exception();
+            }
+          }
+        }
+      });
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+bool WorkStealingPool::pop(std::size_t worker, std::size_t &index) {
+  Slice &own = m_slices[worker];
+  const std::lock_guard lock(own.mutex);
+  if (own.begin == own.end) {
+    return false;
+  }
+  index = own.begin++;
+  return true;
+}
+
+bool WorkStealingPool::steal(std::size_t worker, std::size_t &index) {
+  for (;;) {
+    std::size_t victim = worker;
+    std::size_t most = 0;
+    for (std::size_t w = 0; w < m_threads; ++w) {
+      const std::lock_guard lock(m_slices[w].mutex);
+      const std::size_t left = m_slices[w].end - m_slices[w].begin;
+      if (w != worker && left > most) {
+        victim = w;
+        most = left;
+      }
+    }
+    if (most == 0) {
+      return false;
+    }
+
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    {
+      Slice &slice = m_slices[victim];
+      const std::lock_guard lock(slice.mutex);
+      if (slice.begin == slice.end) {
+        // emptied since the scan, look again
+        continue;
+      }
+      // the back half, or the one task left
+      end = slice.end;
+      begin = slice.begin + (slice.end - slice.begin) / 2;
+      slice.end = begin;
+    }
+    ++m_steals;
+
+    index = begin;
+    Slice &own = m_slices[worker];
+    const std::lock_guard lock(own.mutex);
+    own.begin = begin + 1;
+    own.end = end;
+    return true;
+  }
+}
+
+} // namespace chisel
@@ -1 +1,112 @@
+#include "engine/account.h"
+#include <catch2/catch_test_macros.hpp>
 
+namespace {
+chisel::Fill fill(chisel::Side side, std::int32_t quantity, double price) {
+  return {.step = 0,
+          .side = side,
+          .quantity = quantity,
+          .price = price,
+          .slippage = 0.0};
+}
+} // namespace
+
+TEST_CASE("Account") {
+  chisel::Account account(10'000.0);
+
+  SECTION("Adding averages the entry price") {
+    account.apply(fill(chisel::Side::buy, 10, 100.0));
+    account.apply(fill(chisel::Side::buy, 30, 104.0));
+    REQUIRE(account.position() == 40);
+    REQUIRE(account.entry_price() == 103.0);
+    REQUIRE(account.cash() == 10'000.0 - 1'000.0 - 3'120.0);
+    account.mark(0, 105.0);
+    REQUIRE(account.unrealized_pnl() == 80.0);
+    REQUIRE(account.equity() == 10'000.0 + 80.0);
+  }
+
+  SECTION("Closing realizes against the entry") {
+    account.apply(fill(chisel::Side::buy, 10, 100.0));
+    account.apply(fill(chisel::Side::sell, 4, 110.0));
+    REQUIRE(account.position() == 6);
+    REQUIRE(account.realized_pnl() == 40.0);
+    REQUIRE(account.entry_price() == 100.0);
+
+    account.apply(fill(chisel::Side::sell, 6, 90.0));
+    REQUIRE(account.position() == 0);
+    REQUIRE(account.realized_pnl() == -20.0);
+    REQUIRE(account.equity() == 10'000.0 - 20.0);
+  }
+
+  SECTION("Flipping opens the remainder at the fill") {
+    account.apply(fill(chisel::Side::buy, 5, 100.0));
+    account.apply(fill(chisel::Side::sell, 8, 102.0));
+    REQUIRE(account.position() == -3);
+    REQUIRE(account.realized_pnl() == 10.0);
+    REQUIRE(account.entry_price() == 102.0);
+    account.mark(0, 100.0);
+    REQUIRE(account.unrealized_pnl() == 6.0);
+  }
+}
+
+TEST_CASE("Account holds one position per symbol") {
+  chisel::Account account(10'000.0, 3);
+  auto on = [](chisel::SymbolId symbol, chisel::Fill fill) {
+    fill.symbol = symbol;
+    return fill;
+  };
+
+  account.apply(on(0, fill(chisel::Side::buy, 10, 100.0)));
+  account.apply(on(2, fill(chisel::Side::sell, 5, 50.0)));
+  REQUIRE(account.position(0) == 10);
+  REQUIRE(account.position(1) == 0);
+  REQUIRE(account.position(2) == -5);
+  REQUIRE(account.entry_price(2) == 50.0);
+  REQUIRE(account.cash() == 10'000.0 - 1'000.0 + 250.0);
+
+  account.mark(0, 101.0);
+  account.mark(2, 48.0);
+  REQUIRE(account.unrealized_pnl() == 10.0 + 10.0);
+  REQUIRE(account.equity() == 10'000.0 + 20.0);
+
+  account.apply(on(0, fill(chisel::Side::sell, 10, 103.0)));
+  REQUIRE(account.realized_pnl() == 30.0);
+  REQUIRE(account.positions()[0].realized_pnl() == 30.0);
+  REQUIRE(account.positions()[2].realized_pnl() == 0.0);
+
+  account.reset(500.0, 2);
+  REQUIRE(account.positions().size() == 2);
+  REQUIRE(account.position(0) == 0);
+  REQUIRE(account.equity() == 500.0);
+}
+
+TEST_CASE("Account bookkeeping is exact") {
+  chisel::Account account(1'000.0, 4);
+  std::int64_t seed = 7;
+  for (int i = 0; i < 5'000; ++i) {
+    seed = seed * 1'103'515'245 % 2'147'483'647;
+    const auto symbol = static_cast<chisel::SymbolId>(seed % 4);
+    // tenth-of-a-cent prices, none of them exact in binary
+    const double price = 0.001 * static_cast<double>(90'000 + seed % 20'000);
+    auto trade = fill(seed % 3 == 0 ? chisel::Side::sell : chisel::Side::buy,
+                      static_cast<std::int32_t>(1 + seed % 37), price);
+    trade.symbol = symbol;
+    account.apply(trade);
+    account.mark((symbol + 1) % 4, price + 0.003);
+
+    // the running totals equal a recount, to the millionth
+    chisel::Fixed market = 0;
+    chisel::Fixed realized = 0;
+    chisel::Fixed unrealized = 0;
+    for (const auto &held : account.positions()) {
+      market += held.quantity * held.mark;
+      realized += held.realized;
+      unrealized += held.unrealized();
+    }
+    REQUIRE(account.equity_fixed() == account.cash_fixed() + market);
+    REQUIRE(account.realized_fixed() == realized);
+    REQUIRE(account.unrealized_fixed() == unrealized);
+    REQUIRE(account.equity_fixed() ==
+            chisel::to_fixed(1'000.0) + realized + unrealized);
+  }
+}
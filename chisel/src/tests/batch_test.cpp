@@ -0,0 +1,176 @@
+#include "indicators/atr.h"
+#include "indicators/batch.h"
+#include "indicators/bollinger.h"
+#include "indicators/ema.h"
+#include "indicators/sma.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using chisel::batch::Simd;
+
+// long enough for warm-ups, full vectors and ragged tails at every width
+constexpr std::size_t ROWS = 1'003;
+
+std::vector<double> random_walk(std::uint64_t seed) {
+  std::mt19937_64 rng{seed};
+  std::normal_distribution<double> step{0.0, 0.01};
+  std::vector<double> closes(ROWS);
+  double price = 100.0;
+  for (auto &close : closes) {
+    price *= std::exp(step(rng));
+    close = price;
+  }
+  // a flat stretch, where the variance cancels to zero or just below
+  for (std::size_t i = 500; i < 540; ++i) {
+    closes[i] = closes[499];
+  }
+  return closes;
+}
+
+std::vector<Simd> levels() {
+  std::vector<Simd> out{Simd::scalar};
+  if (chisel::batch::best_simd() >= Simd::avx2) {
+    out.push_back(Simd::avx2);
+  }
+  if (chisel::batch::best_simd() >= Simd::avx512) {
+    out.push_back(Simd::avx512);
+  }
+  return out;
+}
+} // namespace
+
+TEST_CASE("Batch kernels match the incremental indicators bit for bit") {
+  const auto closes = random_walk(7);
+  const std::vector<std::size_t> windows = {1, 2, 3, 5, 9, 10, 20, 50, 64};
+
+  SECTION("rolling_mean and rolling_stddev") {
+    std::vector<double> mean(ROWS);
+    std::vector<double> stddev(ROWS);
+    for (const std::size_t window : windows) {
+      INFO("window " << window);
+      chisel::batch::rolling_mean(closes, window, mean);
+      chisel::batch::rolling_stddev(closes, window, stddev);
+
+      chisel::Sma<> sma(window);
+      chisel::Bollinger<> bands(window, 2.0);
+      for (std::size_t i = 0; i < ROWS; ++i) {
+        REQUIRE(mean[i] == sma.update(closes[i]));
+        bands.update(closes[i]);
+        REQUIRE(stddev[i] == bands.stddev());
+      }
+    }
+  }
+
+  SECTION("rolling_mean_lanes") {
+    for (const Simd simd : levels()) {
+      INFO("simd " << chisel::batch::simd_name(simd));
+      std::vector<double> out(ROWS * windows.size());
+      chisel::batch::rolling_mean_lanes(closes, windows, out, simd);
+      for (std::size_t k = 0; k < windows.size(); ++k) {
+        chisel::Sma<> sma(windows[k]);
+        for (std::size_t i = 0; i < ROWS; ++i) {
+          REQUIRE(out[i * windows.size() + k] == sma.update(closes[i]));
+        }
+      }
+    }
+  }
+
+  SECTION("ema and ema_lanes") {
+    for (const Simd simd : levels()) {
+      INFO("simd " << chisel::batch::simd_name(simd));
+      std::vector<double> single(ROWS);
+      std::vector<double> out(ROWS * windows.size());
+      chisel::batch::ema_lanes(closes, windows, out, simd);
+      for (std::size_t k = 0; k < windows.size(); ++k) {
+        chisel::batch::ema(closes, windows[k], single);
+        chisel::Ema ema(windows[k]);
+        for (std::size_t i = 0; i < ROWS; ++i) {
+          const double expected = ema.update(closes[i]);
+          REQUIRE(single[i] == expected);
+          REQUIRE(out[i * windows.size() + k] == expected);
+        }
+      }
+    }
+  }
+
+  SECTION("true_range, returns and log_returns") {
+    for (const Simd simd : levels()) {
+      INFO("simd " << chisel::batch::simd_name(simd));
+      std::vector<double> high(ROWS);
+      std::vector<double> low(ROWS);
+      for (std::size_t i = 0; i < ROWS; ++i) {
+        // every third bar gaps past the previous close
+        const double gap = i % 3 == 0 ? 0.5 : 0.0;
+        high[i] = closes[i] + 0.1 + gap;
+        low[i] = closes[i] - 0.1 + gap;
+      }
+      std::vector<double> ranges(ROWS);
+      chisel::batch::true_range(high, low, closes, ranges, simd);
+      REQUIRE(ranges[0] == high[0] - low[0]);
+      for (std::size_t i = 1; i < ROWS; ++i) {
+        REQUIRE(ranges[i] == chisel::true_range(high[i], low[i],
+                                                closes[i - 1]));
+      }
+
+      std::vector<double> simple(ROWS);
+      std::vector<double> logs(ROWS);
+      chisel::batch::returns(closes, simple, simd);
+      chisel::batch::log_returns(closes, logs, simd);
+      REQUIRE(simple[0] == 0.0);
+      REQUIRE(logs[0] == 0.0);
+      for (std::size_t i = 1; i < ROWS; ++i) {
+        REQUIRE(simple[i] == closes[i] / closes[i - 1] - 1.0);
+        REQUIRE(logs[i] == std::log(closes[i] / closes[i - 1]));
+      }
+    }
+  }
+
+  SECTION("crosses follow MACrossover's spread rule") {
+    for (const Simd simd : levels()) {
+      INFO("simd " << chisel::batch::simd_name(simd));
+      const std::size_t fast = 5;
+      const std::size_t slow = 20;
+      std::vector<double> fast_mean(ROWS);
+      std::vector<double> slow_mean(ROWS);
+      chisel::batch::rolling_mean(closes, fast, fast_mean);
+      chisel::batch::rolling_mean(closes, slow, slow_mean);
+      std::vector<std::int8_t> signals(ROWS);
+      chisel::batch::crosses(fast_mean, slow_mean, slow - 1, signals, simd);
+
+      double prev = 0.0;
+      std::size_t fired = 0;
+      for (std::size_t i = 0; i < ROWS; ++i) {
+        std::int8_t expected = 0;
+        if (i + 1 >= slow) {
+          const double spread = fast_mean[i] - slow_mean[i];
+          expected = prev <= 0.0 && spread > 0.0   ? 1
+                     : prev >= 0.0 && spread < 0.0 ? -1
+                                                   : 0;
+          prev = spread;
+        }
+        fired += expected != 0 ? 1 : 0;
+        REQUIRE(signals[i] == expected);
+      }
+      REQUIRE(fired > 10);
+    }
+  }
+}
+
+TEST_CASE("Batch kernels reject bad shapes") {
+  const std::vector<double> in(10, 1.0);
+  std::vector<double> short_out(9);
+  std::vector<double> out(10);
+  REQUIRE_THROWS_AS(chisel::batch::rolling_mean(in, 3, short_out),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(chisel::batch::rolling_mean(in, 0, out),
+                    std::invalid_argument);
+
+  const std::vector<std::size_t> windows = {2, 3};
+  REQUIRE_THROWS_AS(chisel::batch::rolling_mean_lanes(in, windows, out),
+                    std::invalid_argument);
+}
@@ -1 +1,133 @@
+#include "engine/engine.h"
+#include "strategy/ma_crossover.h"
+#include "strategy/registry.h"
+#include "test_support.h"
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
 
+namespace {
+using chisel::test::bars_from_closes;
+using chisel::test::RoundTrip;
+} // namespace
+
+TEST_CASE("BacktestEngine") {
+  const chisel::ExecutionModel execution;
+
+  SECTION("Orders fill at the next bar's open") {
+    const auto bars = bars_from_closes({100.0, 101.0, 103.0, 107.0, 107.0});
+    RoundTrip strategy;
+    chisel::BacktestEngine engine({.starting_cash = 1'000.0}, strategy,
+                                  execution);
+
+    const auto stats = engine.run(bars);
+    REQUIRE(stats.steps == 5);
+    REQUIRE(stats.orders == 2);
+    REQUIRE(stats.fills == 2);
+    // bought at 101, sold at 107
+    REQUIRE(engine.account().realized_pnl() == 60.0);
+    REQUIRE(stats.final_equity == 1'060.0);
+  }
+
+  SECTION("Snapshots arrive in full batches, the rest at the end") {
+    const auto bars = bars_from_closes({100.0, 101.0, 103.0, 107.0, 107.0});
+    RoundTrip strategy;
+    chisel::BacktestEngine engine(
+        {.starting_cash = 1'000.0, .snapshot_batch = 2}, strategy, execution);
+
+    std::vector<std::size_t> batches;
+    std::vector<chisel::Snapshot> seen;
+    engine.on_snapshots([&](std::span<const chisel::Snapshot> batch) {
+      batches.push_back(batch.size());
+      seen.insert(seen.end(), batch.begin(), batch.end());
+    });
+    engine.run(bars);
+
+    REQUIRE(batches == std::vector<std::size_t>{2, 2, 1});
+    REQUIRE(seen[0].action == chisel::Action::buy);
+    REQUIRE_FALSE(seen[0].executed);
+    REQUIRE(seen[1].executed);
+    REQUIRE(seen[1].execution.price == 101.0);
+    REQUIRE(seen[1].position == 10);
+    REQUIRE(seen[3].position == 0);
+    REQUIRE(seen[4].step == 4);
+  }
+
+  SECTION("Sampling decides which steps get a snapshot") {
+    const auto bars = bars_from_closes(std::vector<double>(10, 100.0));
+    const auto steps_kept = [&](chisel::SnapshotSampling sampling) {
+      RoundTrip strategy;
+      chisel::BacktestEngine engine(
+          {.snapshot_batch = 4, .sampling = sampling}, strategy, execution);
+      std::vector<std::uint64_t> steps;
+      engine.on_snapshots([&](std::span<const chisel::Snapshot> batch) {
+        for (const auto &snapshot : batch) {
+          steps.push_back(snapshot.step);
+        }
+      });
+      engine.run(bars);
+      // a second run starts the buckets over
+      steps.clear();
+      engine.run(bars);
+      return steps;
+    };
+    using step_list = std::vector<std::uint64_t>;
+
+    REQUIRE(steps_kept({}).size() == 10);
+    REQUIRE(steps_kept({.mode = chisel::SnapshotMode::every_n,
+                        .every = 4}) == step_list{0, 4, 8});
+    // signals on 0 and 2, fills on 1 and 3
+    REQUIRE(steps_kept({.mode = chisel::SnapshotMode::on_activity}) ==
+            step_list{0, 1, 2, 3});
+    // bars are a minute apart
+    REQUIRE(steps_kept({.mode = chisel::SnapshotMode::time_bucketed,
+                        .bucket_ms = 180'000}) == step_list{0, 3, 6, 9});
+  }
+
+  SECTION("Runs are independent") {
+    auto closes = std::vector<double>(60, 100.0);
+    for (std::size_t i = 30; i < 45; ++i) {
+      closes[i] = 100.0 + static_cast<double>(i - 29);
+    }
+    for (std::size_t i = 45; i < 60; ++i) {
+      closes[i] = 90.0;
+    }
+    const auto bars = bars_from_closes(closes);
+    chisel::MACrossover strategy(3, 10, 5);
+    chisel::BacktestEngine engine({}, strategy, execution);
+
+    const auto first = engine.run(bars);
+    const auto second = engine.run(bars);
+    REQUIRE(first.fills == 2);
+    REQUIRE(second.fills == first.fills);
+    REQUIRE(second.final_equity == first.final_equity);
+  }
+
+  SECTION("A strategy picked by name runs like the static one") {
+    const auto bars = chisel::test::sine_bars(200);
+
+    chisel::MACrossover strategy(10, 50, 100);
+    chisel::BacktestEngine engine({.snapshot_batch = 64}, strategy,
+                                  execution);
+    std::vector<chisel::Snapshot> direct;
+    engine.on_snapshots([&](std::span<const chisel::Snapshot> batch) {
+      direct.insert(direct.end(), batch.begin(), batch.end());
+    });
+
+    const auto named = chisel::make_strategy("ma_crossover");
+    chisel::DynamicBacktestEngine dynamic({.snapshot_batch = 64}, *named,
+                                          execution);
+    std::vector<chisel::Snapshot> erased;
+    dynamic.on_snapshots([&](std::span<const chisel::Snapshot> batch) {
+      erased.insert(erased.end(), batch.begin(), batch.end());
+    });
+
+    const auto expected = engine.run(bars);
+    const auto actual = dynamic.run(bars);
+    REQUIRE(expected.fills > 0);
+    REQUIRE(actual.fills == expected.fills);
+    REQUIRE(actual.final_equity == expected.final_equity);
+    REQUIRE(erased.size() == direct.size());
+    REQUIRE(erased.back().indicators == direct.back().indicators);
+    REQUIRE(named->indicator_names()[1] == "sma(50)");
+  }
+}
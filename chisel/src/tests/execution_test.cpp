@@ -0,0 +1,154 @@
+#include "engine/engine.h"
+#include "engine/execution_model.h"
+#include "strategy/ma_crossover.h"
+#include "test_support.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vector>
+
+namespace {
+using Catch::Matchers::WithinRel;
+
+const chisel::Bar BAR{.t = 0,
+                      .open = 100.0,
+                      .high = 104.0,
+                      .low = 98.0,
+                      .close = 102.0,
+                      .volume = 250.0,
+                      .vwap = 101.0,
+                      .transactions = 10};
+
+const chisel::Order BUY{.side = chisel::Side::buy, .quantity = 100};
+const chisel::Order SELL{.side = chisel::Side::sell, .quantity = 100};
+
+/// buys 100 on step 0
+class BuyOnce : public chisel::IStrategy {
+public:
+  void reset() override {}
+  chisel::Action on_bar(const chisel::BarContext &ctx,
+                        chisel::OrderBuffer &orders) override {
+    if (ctx.step == 0) {
+      orders.push({.side = chisel::Side::buy, .quantity = 100});
+      return chisel::Action::buy;
+    }
+    return chisel::Action::hold;
+  }
+};
+} // namespace
+
+TEST_CASE("Fill models") {
+  chisel::Fill fill{};
+
+  SECTION("Reference prices") {
+    const chisel::FillModel<chisel::AtOpen> open;
+    REQUIRE(open.fill(BUY, BAR, 3, fill));
+    REQUIRE(fill.step == 3);
+    REQUIRE(fill.price == 100.0);
+
+    const chisel::FillModel<chisel::AtClose> close;
+    REQUIRE(close.fill(BUY, BAR, 3, fill));
+    REQUIRE(fill.price == 102.0);
+
+    const chisel::FillModel<chisel::AtVwap> vwap;
+    REQUIRE(vwap.fill(BUY, BAR, 3, fill));
+    REQUIRE(fill.price == 101.0);
+    auto no_vwap = BAR;
+    no_vwap.vwap = 0.0;
+    REQUIRE(vwap.fill(BUY, no_vwap, 3, fill));
+    REQUIRE(fill.price == 304.0 / 3.0);
+  }
+
+  SECTION("Slippage moves against the trader") {
+    const chisel::ExecutionModel bps(chisel::BpsSlippage{10.0});
+    REQUIRE(bps.fill(BUY, BAR, 0, fill));
+    REQUIRE_THAT(fill.price, WithinRel(100.1));
+    REQUIRE(bps.fill(SELL, BAR, 0, fill));
+    REQUIRE_THAT(fill.price, WithinRel(99.9));
+    REQUIRE_THAT(fill.slippage, WithinRel(-0.1));
+
+    // a quarter of the 6.00 range
+    const chisel::FillModel<chisel::AtClose, chisel::RangeSlippage> range(
+        chisel::RangeSlippage{0.25});
+    REQUIRE(range.fill(BUY, BAR, 0, fill));
+    REQUIRE(fill.price == 103.5);
+    REQUIRE(range.fill(SELL, BAR, 0, fill));
+    REQUIRE(fill.price == 100.5);
+  }
+
+  SECTION("Volume caps fill part of an order") {
+    const chisel::FillModel<chisel::AtOpen, chisel::BpsSlippage,
+                            chisel::VolumeCap>
+        capped({}, chisel::VolumeCap{0.1});
+    REQUIRE(capped.fill(BUY, BAR, 0, fill));
+    REQUIRE(fill.quantity == 25);
+
+    auto quiet = BAR;
+    quiet.volume = 5.0;
+    REQUIRE_FALSE(capped.fill(BUY, quiet, 0, fill));
+  }
+
+  SECTION("Commissions") {
+    const chisel::FillModel<chisel::AtOpen, chisel::BpsSlippage,
+                            chisel::FullSize, chisel::PerShareCommission>
+        per_share({}, {}, chisel::PerShareCommission{0.01, 1.5});
+    REQUIRE(per_share.fill(BUY, BAR, 0, fill));
+    REQUIRE(fill.commission == 1.5);
+    REQUIRE(per_share.fill({.side = chisel::Side::buy, .quantity = 400}, BAR,
+                           0, fill));
+    REQUIRE(fill.commission == 4.0);
+
+    const chisel::FillModel<chisel::AtOpen, chisel::BpsSlippage,
+                            chisel::FullSize, chisel::BpsCommission>
+        bps({}, {}, chisel::BpsCommission{5.0});
+    REQUIRE(bps.fill(BUY, BAR, 0, fill));
+    REQUIRE_THAT(fill.commission, WithinRel(5.0));
+  }
+}
+
+TEST_CASE("Engines keep what a bar can't fill") {
+  std::vector<chisel::Bar> bars(6, BAR);
+  for (std::size_t i = 0; i < bars.size(); ++i) {
+    bars[i].t = static_cast<std::int64_t>(i) * 60'000;
+    bars[i].volume = 400.0;
+  }
+
+  BuyOnce strategy;
+  const chisel::FillModel<chisel::AtOpen, chisel::BpsSlippage,
+                          chisel::VolumeCap, chisel::PerShareCommission>
+      execution({}, chisel::VolumeCap{0.1}, {0.0, 1.0});
+  chisel::BacktestEngine engine({.starting_cash = 100'000.0}, strategy,
+                                execution);
+
+  // 40 a bar from step 1: 40, 40, 20
+  const auto stats = engine.run(bars);
+  REQUIRE(stats.orders == 1);
+  REQUIRE(stats.fills == 3);
+  REQUIRE(engine.account().position() == 100);
+  REQUIRE(engine.account().cash() == 100'000.0 - 10'000.0 - 3.0);
+  REQUIRE(engine.account().realized_pnl() == -3.0);
+  REQUIRE(stats.final_equity == 100'000.0 + 200.0 - 3.0);
+}
+
+TEST_CASE("An exit cancels the unfilled rest of its entry") {
+  // fast 1 over slow 2 crosses up at step 3 and back down at step 4
+  auto bars = chisel::test::bars_from_closes(
+      {100, 100, 100, 101, 100, 100, 100, 100});
+  for (chisel::Bar &bar : bars) {
+    bar.volume = 400.0;
+  }
+
+  chisel::MACrossover strategy(1, 2, 100);
+  const chisel::FillModel<chisel::AtOpen, chisel::BpsSlippage,
+                          chisel::VolumeCap>
+      execution({0.0}, chisel::VolumeCap{0.1});
+  chisel::BacktestEngine engine({.starting_cash = 100'000.0}, strategy,
+                                execution);
+
+  // buys 40 of 100 at step 4 and sells those 40 at step 5; the other 60
+  // would otherwise keep filling after the exit
+  const auto stats = engine.run(bars);
+  REQUIRE(stats.orders == 2);
+  REQUIRE(stats.fills == 2);
+  REQUIRE(engine.account().position() == 0);
+  REQUIRE(engine.account().cash() == 100'000.0);
+}
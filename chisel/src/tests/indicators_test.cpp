@@ -0,0 +1,191 @@
+#include "indicators/atr.h"
+#include "indicators/bollinger.h"
+#include "indicators/ema.h"
+#include "indicators/indicator.h"
+#include "indicators/rsi.h"
+#include "indicators/sma.h"
+#include "indicators/vwap.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace {
+using Catch::Matchers::WithinAbs;
+using Catch::Matchers::WithinRel;
+
+const std::vector<double> CLOSES = {44.34, 44.09, 44.15, 43.61, 44.33, 44.83,
+                                    45.10, 45.42, 45.84, 46.08, 45.89, 46.03,
+                                    45.61, 46.28, 46.28, 46.00, 46.03, 46.41,
+                                    46.22, 45.64, 46.21, 46.25, 45.71, 46.45};
+
+double window_mean(std::size_t end, std::size_t window) {
+  double sum = 0.0;
+  for (std::size_t i = end - window; i < end; ++i) {
+    sum += CLOSES[i];
+  }
+  return sum / static_cast<double>(window);
+}
+
+static_assert(chisel::scalar_indicator_c<chisel::Sma<5>>);
+static_assert(chisel::scalar_indicator_c<chisel::Rsi>);
+static_assert(chisel::bar_indicator_c<chisel::Atr>);
+static_assert(chisel::bar_indicator_c<chisel::Vwap>);
+} // namespace
+
+TEST_CASE("RingBuffer") {
+  chisel::RingBuffer<int, 3> ring;
+  REQUIRE(ring.push(1) == 0);
+  REQUIRE(ring.push(2) == 0);
+  REQUIRE(ring.push(3) == 0);
+  REQUIRE(ring.full());
+  REQUIRE(ring.push(4) == 1);
+  REQUIRE(ring[0] == 2);
+  REQUIRE(ring[2] == 4);
+}
+
+TEST_CASE("Sma matches the window mean") {
+  chisel::Sma<5> fixed;
+  chisel::Sma<> dynamic(5);
+  for (std::size_t i = 0; i < CLOSES.size(); ++i) {
+    fixed.update(CLOSES[i]);
+    dynamic.update(CLOSES[i]);
+    REQUIRE(fixed.ready() == (i >= 4));
+    if (fixed.ready()) {
+      REQUIRE_THAT(fixed.value(), WithinAbs(window_mean(i + 1, 5), 1e-9));
+      REQUIRE(dynamic.value() == fixed.value());
+    }
+  }
+}
+
+TEST_CASE("Ema seeds with the mean then smooths") {
+  chisel::Ema ema(10);
+  double expected = 0.0;
+  for (std::size_t i = 0; i < CLOSES.size(); ++i) {
+    ema.update(CLOSES[i]);
+    if (i == 9) {
+      expected = window_mean(10, 10);
+    } else if (i > 9) {
+      expected += (2.0 / 11.0) * (CLOSES[i] - expected);
+    }
+    if (i >= 9) {
+      REQUIRE_THAT(ema.value(), WithinAbs(expected, 1e-9));
+    } else {
+      REQUIRE_FALSE(ema.ready());
+    }
+  }
+}
+
+TEST_CASE("Rsi follows Wilder's worked example") {
+  chisel::Rsi rsi(14);
+  for (std::size_t i = 0; i < 15; ++i) {
+    rsi.update(CLOSES[i]);
+  }
+  REQUIRE(rsi.ready());
+  // 14-period RSI of the classic 44.34.. series at its 15th close
+  REQUIRE_THAT(rsi.value(), WithinAbs(70.46, 0.01));
+}
+
+TEST_CASE("Atr widens to gaps") {
+  chisel::Atr atr(2);
+  atr.update({.t = 0,
+              .open = 10,
+              .high = 11,
+              .low = 9,
+              .close = 10,
+              .volume = 0,
+              .vwap = 10,
+              .transactions = 0});
+  REQUIRE_FALSE(atr.ready());
+  // gap up: true range is 14 - 10, not 14 - 13
+  atr.update({.t = 1,
+              .open = 13,
+              .high = 14,
+              .low = 13,
+              .close = 13.5,
+              .volume = 0,
+              .vwap = 13.5,
+              .transactions = 0});
+  REQUIRE(atr.ready());
+  REQUIRE(atr.value() == 3.0);
+}
+
+TEST_CASE("Bollinger bands") {
+  chisel::Bollinger<4> bands(2.0);
+  for (const double value : {1.0, 2.0, 3.0, 4.0}) {
+    bands.update(value);
+  }
+  REQUIRE(bands.middle() == 2.5);
+  REQUIRE_THAT(bands.stddev(), WithinAbs(std::sqrt(1.25), 1e-12));
+  REQUIRE_THAT(bands.upper(), WithinAbs(2.5 + 2.0 * std::sqrt(1.25), 1e-12));
+
+  chisel::Bollinger<> flat(3, 2.0);
+  for (int i = 0; i < 10; ++i) {
+    flat.update(0.1);
+  }
+  REQUIRE(flat.stddev() == 0.0);
+}
+
+TEST_CASE("Bollinger bands keep their precision over long runs") {
+  // a walk held near 100 with moves of about 0.01: a sum of squares around
+  // 2e5 would lose the window's ~5e-3 of variance to rounding drift
+  std::mt19937_64 rng(3);
+  std::normal_distribution<double> noise(0.0, 0.01);
+  constexpr std::size_t window = 20;
+  chisel::Bollinger<window> bands(2.0);
+  std::vector<double> last(window);
+  double price = 100.0;
+  for (std::size_t i = 0; i < 2'000'000; ++i) {
+    price += noise(rng) + 0.001 * (100.0 - price);
+    bands.update(price);
+    last[i % window] = price;
+  }
+
+  double mean = 0.0;
+  for (const double value : last) {
+    mean += value;
+  }
+  mean /= static_cast<double>(window);
+  double variance = 0.0;
+  for (const double value : last) {
+    variance += (value - mean) * (value - mean);
+  }
+  variance /= static_cast<double>(window);
+
+  REQUIRE_THAT(bands.stddev(), WithinRel(std::sqrt(variance), 1e-7));
+}
+
+TEST_CASE("Vwap weights by volume until reset") {
+  chisel::Vwap vwap;
+  vwap.update({.t = 0,
+               .open = 10.0,
+               .high = 10.0,
+               .low = 10.0,
+               .close = 10.0,
+               .volume = 100,
+               .vwap = 10.0,
+               .transactions = 1});
+  vwap.update({.t = 1,
+               .open = 20.0,
+               .high = 20.0,
+               .low = 20.0,
+               .close = 20.0,
+               .volume = 300,
+               .vwap = 20.0,
+               .transactions = 1});
+  REQUIRE(vwap.value() == 17.5);
+  vwap.reset();
+  REQUIRE_FALSE(vwap.ready());
+}
+
+TEST_CASE("Chained indicators") {
+  chisel::Chained<chisel::Sma<3>, chisel::Sma<2>> smoothed({}, {});
+  for (const double value : {1.0, 2.0, 3.0, 4.0}) {
+    smoothed.update(value);
+  }
+  // mean of the last two 3-bar means, (2 + 3) / 2
+  REQUIRE(smoothed.ready());
+  REQUIRE(smoothed.value() == 2.5);
+}
@@ -0,0 +1,101 @@
+#include "engine/engine.h"
+#include "engine/metrics.h"
+#include "engine/summary.h"
+#include "test_support.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+using Catch::Matchers::WithinRel;
+using chisel::test::bars_from_closes;
+using chisel::test::TwoTrips;
+} // namespace
+
+TEST_CASE("RunMetrics") {
+  SECTION("Streaming moments match a two-pass recount") {
+    std::mt19937_64 rng{3};
+    std::normal_distribution<double> step{0.0002, 0.001};
+    chisel::RunMetrics metrics;
+    // far from zero, where a sum of squares would lose the variance
+    double equity = 1e9;
+    metrics.reset(equity);
+    std::vector<double> curve{equity};
+    for (int i = 0; i < 100'000; ++i) {
+      equity *= 1.0 + step(rng);
+      curve.push_back(equity);
+      metrics.on_step(equity);
+    }
+
+    double mean = 0.0;
+    for (std::size_t i = 1; i < curve.size(); ++i) {
+      mean += curve[i] / curve[i - 1] - 1.0;
+    }
+    mean /= static_cast<double>(curve.size() - 1);
+    double squares = 0.0;
+    double peak = curve.front();
+    double drawdown = 0.0;
+    for (std::size_t i = 1; i < curve.size(); ++i) {
+      const double r = curve[i] / curve[i - 1] - 1.0;
+      squares += (r - mean) * (r - mean);
+      peak = std::max(peak, curve[i]);
+      drawdown = std::max(drawdown, (peak - curve[i]) / peak);
+    }
+    const double stddev =
+        std::sqrt(squares / static_cast<double>(curve.size() - 2));
+
+    REQUIRE(metrics.returns() == 100'000);
+    REQUIRE_THAT(metrics.mean_return(), WithinRel(mean, 1e-9));
+    REQUIRE_THAT(metrics.return_stddev(), WithinRel(stddev, 1e-9));
+    REQUIRE_THAT(metrics.sharpe(252.0),
+                 WithinRel(mean / stddev * std::sqrt(252.0), 1e-9));
+    REQUIRE_THAT(metrics.max_drawdown(), WithinRel(drawdown, 1e-12));
+  }
+
+  SECTION("Drawdown is the deepest fall from a running peak") {
+    chisel::RunMetrics metrics;
+    metrics.reset(100.0);
+    for (const double equity : {120.0, 90.0, 150.0, 135.0, 160.0}) {
+      metrics.on_step(equity);
+    }
+    REQUIRE(metrics.max_drawdown() == 0.25);
+  }
+
+  SECTION("Flat curves have no Sharpe") {
+    chisel::RunMetrics metrics;
+    metrics.reset(100.0);
+    metrics.on_step(100.0);
+    metrics.on_step(100.0);
+    REQUIRE(metrics.sharpe(252.0) == 0.0);
+    REQUIRE(metrics.win_rate() == 0.0);
+  }
+}
+
+TEST_CASE("Engine runs fill the summary") {
+  // bought at 101 and sold at 103, then bought at 104 and sold at 102
+  const auto bars =
+      bars_from_closes({100.0, 101.0, 103.0, 105.0, 104.0, 102.0, 102.0});
+  TwoTrips strategy;
+  const chisel::ExecutionModel execution;
+  const chisel::EngineConfig config{.starting_cash = 1'000.0};
+  chisel::BacktestEngine engine(config, strategy, execution);
+
+  const auto stats = engine.run(bars);
+  REQUIRE(stats.metrics.trades() == 2);
+  REQUIRE(stats.metrics.wins() == 1);
+  REQUIRE(stats.metrics.returns() == bars.size());
+
+  const auto summary = chisel::summarize(config, stats);
+  REQUIRE(summary.end_balance == 1'000.0);
+  REQUIRE(summary.return_percent == 0.0);
+  REQUIRE(summary.win_rate == 0.5);
+  REQUIRE(summary.trade_count == 2);
+  // the peak of 1'020 after the first trip, back to 1'000
+  REQUIRE_THAT(summary.max_drawdown, WithinRel(20.0 / 1'020.0));
+  // +2% then -1.96%: flat in the end, a hair positive on average
+  REQUIRE(summary.sharpe_ratio ==
+          stats.metrics.sharpe(config.periods_per_year));
+  REQUIRE(summary.sharpe_ratio > 0.0);
+}
@@ -0,0 +1,281 @@
+#include "engine/bar_merge.h"
+#include "engine/engine.h"
+#include "engine/portfolio_engine.h"
+#include "strategy/ma_crossover.h"
+#include "strategy/portfolio_strategy.h"
+#include "test_support.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+using chisel::test::sine_bars;
+
+chisel::Bar bar_at(std::int64_t t, double close) {
+  return chisel::test::flat_bar(t, close);
+}
+
+/// buys `symbol` on the first batch, sells it on the third
+class BasketRoundTrip {
+public:
+  explicit BasketRoundTrip(chisel::SymbolId symbol) : m_symbol(symbol) {}
+  void reset() {}
+  void on_batch(const chisel::BatchContext &ctx,
+                chisel::PortfolioOrders &orders) {
+    if (ctx.step == 0) {
+      orders.push({.side = chisel::Side::buy, .quantity = 10,
+                   .symbol = m_symbol});
+    } else if (ctx.step == 2) {
+      orders.push({.side = chisel::Side::sell, .quantity = 10,
+                   .symbol = m_symbol});
+    }
+  }
+
+private:
+  chisel::SymbolId m_symbol;
+};
+
+/// buys one share of `symbol` `per_batch` times on every batch
+class Pile {
+public:
+  Pile(chisel::SymbolId symbol, std::size_t per_batch)
+      : m_symbol(symbol), m_per_batch(per_batch) {}
+  void reset() {}
+  void on_batch(const chisel::BatchContext & /*ctx*/,
+                chisel::PortfolioOrders &orders) {
+    for (std::size_t i = 0; i < m_per_batch; ++i) {
+      orders.push({.side = chisel::Side::buy, .quantity = 1,
+                   .symbol = m_symbol});
+    }
+  }
+
+private:
+  chisel::SymbolId m_symbol;
+  std::size_t m_per_batch;
+};
+
+/// buys one share `count` times on its first bar
+class Flood {
+public:
+  explicit Flood(std::size_t count) : m_count(count) {}
+  void reset() {}
+  chisel::Action on_bar(const chisel::BarContext &ctx,
+                        chisel::OrderBuffer &orders) {
+    for (std::size_t i = 0; ctx.step == 0 && i < m_count; ++i) {
+      orders.push({.side = chisel::Side::buy, .quantity = 1});
+    }
+    return chisel::Action::hold;
+  }
+  [[nodiscard]] std::span<const std::string_view>
+  indicator_names() const noexcept {
+    return {};
+  }
+  [[nodiscard]] std::span<const double> indicator_values() const noexcept {
+    return {};
+  }
+
+private:
+  std::size_t m_count;
+};
+} // namespace
+
+TEST_CASE("BarMerge") {
+  SECTION("Batches come out by timestamp, symbols ascending") {
+    const std::vector<chisel::Bar> a{bar_at(0, 1.0), bar_at(2, 2.0),
+                                     bar_at(3, 3.0)};
+    const std::vector<chisel::Bar> b{bar_at(1, 10.0), bar_at(2, 20.0)};
+    const std::vector<chisel::Bar> c{bar_at(2, 100.0), bar_at(5, 200.0)};
+    chisel::BarMerge merge({a, b, c});
+    REQUIRE(merge.symbols() == 3);
+
+    std::vector<std::vector<chisel::SymbolId>> order;
+    std::vector<std::int64_t> times;
+    for (auto batch = merge.next(); !batch.empty(); batch = merge.next()) {
+      times.push_back(batch.front().bar->t);
+      auto &symbols = order.emplace_back();
+      for (const auto &bar : batch) {
+        REQUIRE(bar.bar->t == times.back());
+        symbols.push_back(bar.symbol);
+      }
+    }
+    REQUIRE(times == std::vector<std::int64_t>{0, 1, 2, 3, 5});
+    REQUIRE(order == std::vector<std::vector<chisel::SymbolId>>{
+                         {0}, {1}, {0, 1, 2}, {0}, {2}});
+    REQUIRE(merge.history(0).size() == 3);
+    REQUIRE(merge.history(2).back().close == 200.0);
+
+    merge.reset();
+    const auto first = merge.next();
+    REQUIRE(first.size() == 1);
+    REQUIRE(first.front().index == 0);
+    REQUIRE(merge.history(1).empty());
+  }
+
+  SECTION("Many symbols merge in time order") {
+    std::vector<std::vector<chisel::Bar>> series;
+    std::vector<std::span<const chisel::Bar>> views;
+    std::size_t total = 0;
+    for (std::int64_t s = 0; s < 300; ++s) {
+      auto &bars = series.emplace_back();
+      for (std::int64_t t = s % 7; t < 500; t += 1 + s % 5) {
+        bars.push_back(bar_at(t, static_cast<double>(s)));
+      }
+      total += bars.size();
+    }
+    for (const auto &bars : series) {
+      views.emplace_back(bars);
+    }
+
+    chisel::BarMerge merge(views);
+    std::size_t seen = 0;
+    std::int64_t last = -1;
+    for (auto batch = merge.next(); !batch.empty(); batch = merge.next()) {
+      REQUIRE(batch.front().bar->t > last);
+      last = batch.front().bar->t;
+      for (std::size_t i = 1; i < batch.size(); ++i) {
+        REQUIRE(batch[i - 1].symbol < batch[i].symbol);
+      }
+      seen += batch.size();
+    }
+    REQUIRE(seen == total);
+  }
+
+  SECTION("Sparse stretches go through the heap and back") {
+    // 200 symbols trading one at a time, then all on a shared grid
+    std::vector<std::vector<chisel::Bar>> series(200);
+    std::vector<std::span<const chisel::Bar>> views;
+    for (std::int64_t s = 0; s < 200; ++s) {
+      auto &bars = series[static_cast<std::size_t>(s)];
+      for (std::int64_t j = 0; j < 100; ++j) {
+        bars.push_back(bar_at(j * 200 + s, 1.0));
+      }
+      for (std::int64_t j = 0; j < 200; ++j) {
+        bars.push_back(bar_at(100'000 + j, 2.0));
+      }
+      views.emplace_back(bars);
+    }
+
+    chisel::BarMerge merge(views);
+    bool used_heap = false;
+    std::size_t seen = 0;
+    std::int64_t last = -1;
+    for (auto batch = merge.next(); !batch.empty(); batch = merge.next()) {
+      used_heap = used_heap || merge.heap_mode();
+      REQUIRE(batch.front().bar->t > last);
+      last = batch.front().bar->t;
+      REQUIRE(batch.size() == (last < 100'000 ? 1U : 200U));
+      seen += batch.size();
+    }
+    REQUIRE(used_heap);
+    REQUIRE_FALSE(merge.heap_mode());
+    REQUIRE(seen == 200U * 300U);
+  }
+
+  SECTION("Unordered series are rejected") {
+    const std::vector<chisel::Bar> bad{bar_at(1, 1.0), bar_at(1, 1.0)};
+    REQUIRE_THROWS_AS(chisel::BarMerge({bad}), std::invalid_argument);
+  }
+}
+
+TEST_CASE("PortfolioEngine") {
+  const chisel::ExecutionModel execution;
+
+  SECTION("Orders wait for their own symbol's next bar") {
+    // symbol 1 has no bar at t = 1, its buy fills at t = 2
+    const std::vector<chisel::Bar> a{bar_at(0, 10.0), bar_at(1, 11.0),
+                                     bar_at(2, 12.0), bar_at(3, 13.0)};
+    const std::vector<chisel::Bar> b{bar_at(0, 50.0), bar_at(2, 55.0),
+                                     bar_at(3, 60.0), bar_at(4, 70.0)};
+    chisel::BarMerge merge({a, b});
+    BasketRoundTrip strategy(1);
+    chisel::PortfolioEngine engine({.starting_cash = 1'000.0}, strategy,
+                                   execution);
+
+    const auto stats = engine.run(merge);
+    REQUIRE(stats.steps == 5);
+    REQUIRE(stats.orders == 2);
+    REQUIRE(stats.fills == 2);
+    // bought at 55, sold at 60 on the t = 3 bar
+    REQUIRE(engine.account().realized_pnl() == 50.0);
+    REQUIRE(engine.account().position(1) == 0);
+    REQUIRE(stats.final_equity == 1'050.0);
+  }
+
+  SECTION("Per-symbol strategies match separate single-symbol runs") {
+    std::vector<std::vector<chisel::Bar>> series;
+    for (int s = 0; s < 4; ++s) {
+      // ragged: every symbol has its own bar spacing
+      series.push_back(sine_bars(600, s * 0.7, s + 1));
+    }
+    std::vector<std::span<const chisel::Bar>> views(series.begin(),
+                                                    series.end());
+    chisel::BarMerge merge(views);
+    chisel::PerSymbol<chisel::MACrossover> basket(series.size(), 5, 20, 10);
+    chisel::PortfolioEngine engine({.starting_cash = 10'000.0}, basket,
+                                   execution);
+    const auto stats = engine.run(merge);
+
+    std::uint64_t fills = 0;
+    for (std::size_t s = 0; s < series.size(); ++s) {
+      chisel::MACrossover alone(5, 20, 10);
+      chisel::BacktestEngine single({.starting_cash = 10'000.0}, alone,
+                                    execution);
+      fills += single.run(series[s]).fills;
+      REQUIRE(engine.account().positions()[s].realized_pnl() ==
+              single.account().realized_pnl());
+      REQUIRE(engine.account().position(static_cast<chisel::SymbolId>(s)) ==
+              single.account().position());
+    }
+    REQUIRE(stats.fills == fills);
+    REQUIRE(fills > 0);
+
+    // reruns start clean
+    const auto again = engine.run(merge);
+    REQUIRE(again.final_equity == stats.final_equity);
+  }
+
+  SECTION("Orders that don't fit are counted or refused, never lost") {
+    // symbol 1 has no bar between t = 0 and t = 9, its orders pile up
+    const std::vector<chisel::Bar> a{bar_at(0, 10.0), bar_at(1, 11.0),
+                                     bar_at(2, 12.0)};
+    const std::vector<chisel::Bar> b{bar_at(0, 5.0), bar_at(9, 6.0)};
+    chisel::BarMerge merge({a, b});
+    Pile pile(1, 10);
+    chisel::PortfolioEngine engine({}, pile, execution);
+    const auto stats = engine.run(merge);
+    REQUIRE(stats.orders == 40);
+    // 10 + 6 fit before t = 9 fills them, 10 queue after
+    REQUIRE(stats.dropped_orders == 14);
+    REQUIRE(engine.account().position(1) == 16);
+
+    // a basket's orders for one timestamp overflow the batch
+    const std::vector<std::vector<chisel::Bar>> wide(
+        chisel::MAX_ORDERS_PER_BATCH / chisel::MAX_ORDERS_PER_BAR + 1, a);
+    std::vector<std::span<const chisel::Bar>> views(wide.begin(), wide.end());
+    chisel::BarMerge basket(views);
+    chisel::PerSymbol<Flood> crowd(wide.size(), chisel::MAX_ORDERS_PER_BAR);
+    chisel::PortfolioEngine crowded({}, crowd, execution);
+    REQUIRE_THROWS_AS(crowded.run(basket), std::length_error);
+  }
+
+  SECTION("A stop check ends the run between timestamps") {
+    const auto bars = sine_bars(3 * chisel::STOP_CHECK_STEPS);
+    chisel::BarMerge merge({bars, bars});
+    chisel::PerSymbol<chisel::MACrossover> basket(2, 5, 20, 10);
+    chisel::PortfolioEngine engine({}, basket, execution);
+    std::size_t checks = 0;
+    engine.stop_when([&checks]() { return ++checks == 2; });
+    REQUIRE(engine.run(merge).steps == chisel::STOP_CHECK_STEPS);
+  }
+
+  SECTION("Orders for unknown symbols throw") {
+    const std::vector<chisel::Bar> a{bar_at(0, 10.0), bar_at(1, 11.0)};
+    chisel::BarMerge merge({a});
+    BasketRoundTrip strategy(3);
+    chisel::PortfolioEngine engine({}, strategy, execution);
+    REQUIRE_THROWS_AS(engine.run(merge), std::out_of_range);
+  }
+}
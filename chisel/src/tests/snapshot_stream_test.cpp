@@ -0,0 +1,145 @@
+#include "engine/engine.h"
+#include "grpc/snapshot_stream.h"
+#include "strategy/ma_crossover.h"
+#include "test_support.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace {
+/// every event a run streams, as RunBackTest would write them
+std::vector<marble::BacktestEvent>
+stream_run(const marble::SnapshotOptions &options,
+           std::span<const chisel::Bar> bars, std::size_t accept = SIZE_MAX,
+           chisel::RunStats *stats = nullptr) {
+  chisel::MACrossover strategy(10, 50, 100);
+  std::vector<marble::BacktestEvent> events;
+  chisel::SnapshotStream stream(
+      options,
+      {.ticker = "AAPL",
+       .indicator_names = strategy.indicator_names(),
+       .intern_names = options.intern_names()},
+      [&](const marble::BacktestEvent &event) {
+        if (events.size() == accept) {
+          return false;
+        }
+        events.push_back(event);
+        return true;
+      });
+
+  const chisel::ExecutionModel execution;
+  const chisel::EngineConfig config{.snapshot_batch = stream.engine_batch(),
+                                    .sampling = chisel::to_sampling(options)};
+  chisel::BacktestEngine engine(config, strategy, execution);
+  engine.on_snapshots([&](std::span<const chisel::Snapshot> batch) {
+    stream.write(batch);
+  });
+  engine.stop_when([&]() { return !stream.ok(); });
+
+  marble::BacktestConfig started;
+  started.set_symbol("AAPL");
+  stream.start(started);
+  const auto run = engine.run(bars);
+  stream.finish(chisel::summarize(config, run));
+  if (stats != nullptr) {
+    *stats = run;
+  }
+  return events;
+}
+
+std::size_t wire_bytes(const std::vector<marble::BacktestEvent> &events) {
+  std::size_t bytes = 0;
+  for (const auto &event : events) {
+    bytes += event.ByteSizeLong();
+  }
+  return bytes;
+}
+} // namespace
+
+TEST_CASE("SnapshotStream") {
+  const auto bars = chisel::test::sine_bars(500);
+
+  SECTION("Without options every bar is its own step event") {
+    const auto events = stream_run({}, bars);
+    REQUIRE(events.size() == bars.size() + 2);
+    REQUIRE(events.front().has_started());
+    REQUIRE(events.front().started().config().symbol() == "AAPL");
+    REQUIRE(events.front().started().indicator_names_size() == 2);
+    REQUIRE(events.back().has_end());
+    REQUIRE(events.back().end().start_balance() == 100'000.0);
+
+    const auto &last = events[events.size() - 2].step();
+    REQUIRE(last.step() == bars.size() - 1);
+    REQUIRE(last.candle().close() == bars.back().close);
+    REQUIRE(last.indicators_size() == 2);
+    REQUIRE(last.indicators(1).name() == "sma(50)");
+    REQUIRE(last.indicator_values_size() == 0);
+  }
+
+  SECTION("Batches pack snapshots, the last one partly") {
+    marble::SnapshotOptions options;
+    options.set_batch(64);
+    const auto events = stream_run(options, bars);
+    // 7 full batches and 52 left over
+    REQUIRE(events.size() == 8 + 2);
+    REQUIRE(events[1].steps().snapshots_size() == 64);
+    REQUIRE(events[8].steps().snapshots_size() == 52);
+    REQUIRE(events[8].steps().snapshots(51).step() == bars.size() - 1);
+  }
+
+  SECTION("Interned names send values only") {
+    marble::SnapshotOptions options;
+    options.set_batch(64);
+    options.set_intern_names(true);
+    const auto interned = stream_run(options, bars);
+    REQUIRE(interned.front().started().indicator_names(0) == "sma(10)");
+    const auto &snapshot = interned[8].steps().snapshots(51);
+    REQUIRE(snapshot.indicators_size() == 0);
+    REQUIRE(snapshot.indicator_values_size() == 2);
+
+    options.set_intern_names(false);
+    const auto named = stream_run(options, bars);
+    REQUIRE(snapshot.indicator_values(1) ==
+            named[8].steps().snapshots(51).indicators(1).value());
+    REQUIRE(wire_bytes(interned) < wire_bytes(named));
+  }
+
+  SECTION("Sampling thins the stream") {
+    marble::SnapshotOptions options;
+    options.set_batch(1'000);
+    options.set_sampling(marble::SAMPLE_ON_ACTIVITY);
+    const auto active = stream_run(options, bars);
+    REQUIRE(active.size() == 3);
+    for (const auto &snapshot : active[1].steps().snapshots()) {
+      REQUIRE((snapshot.signal().action() != marble::ACTION_HOLD ||
+               snapshot.has_execution()));
+    }
+
+    options.set_sampling(marble::SAMPLE_EVERY_N);
+    options.set_every(100);
+    REQUIRE(stream_run(options, bars)[1].steps().snapshots_size() == 5);
+
+    options.set_sampling(marble::SAMPLE_TIME_BUCKETED);
+    options.set_bucket_ms(3'600'000);
+    // minute bars from the epoch, one per hour
+    REQUIRE(stream_run(options, bars)[1].steps().snapshots(1).step() == 60);
+
+    options.set_sampling(marble::SAMPLE_NONE);
+    const auto none = stream_run(options, bars);
+    REQUIRE(none.size() == 2);
+    REQUIRE(none.back().has_end());
+  }
+
+  SECTION("A failed write ends the stream and stops the run") {
+    marble::SnapshotOptions options;
+    options.set_batch(64);
+    const auto long_run = chisel::test::sine_bars(4 * chisel::STOP_CHECK_STEPS);
+    chisel::RunStats stats;
+    const auto events = stream_run(options, long_run, 3, &stats);
+    REQUIRE(events.size() == 3);
+    REQUIRE_FALSE(events.back().has_end());
+    // the first stop check after the failure
+    REQUIRE(stats.steps == chisel::STOP_CHECK_STEPS);
+  }
+}
@@ -0,0 +1,42 @@
+#include "engine/account.h"
+#include "strategy/ma_crossover.h"
+#include "strategy/registry.h"
+#include "test_support.h"
+#include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("MACrossover") {
+  chisel::MACrossover strategy(2, 4, 10);
+  const chisel::Account account(1'000.0);
+  chisel::OrderBuffer orders;
+
+  std::vector<chisel::Bar> bars;
+  std::vector<chisel::Action> actions;
+  for (const double close : {5.0, 4.0, 3.0, 2.0, 6.0, 7.0, 1.0, 1.0}) {
+    bars.push_back(
+        chisel::test::flat_bar(static_cast<std::int64_t>(bars.size()), close));
+    actions.push_back(strategy.on_bar(
+        {.step = bars.size() - 1, .history = bars, .account = account},
+        orders));
+  }
+
+  REQUIRE(strategy.indicator_names().size() == 2);
+  REQUIRE(strategy.indicator_names()[0] == "sma(2)");
+  REQUIRE(strategy.indicator_names()[1] == "sma(4)");
+  // last two closes and last four
+  REQUIRE(strategy.indicator_values()[0] == 1.0);
+  REQUIRE(strategy.indicator_values()[1] == 3.75);
+
+  // 4 over 3.75 on the fifth bar crosses up
+  REQUIRE(actions[4] == chisel::Action::buy);
+  REQUIRE(orders.size() == 1);
+}
+
+TEST_CASE("Strategies by name") {
+  for (const auto name : chisel::strategy_names()) {
+    REQUIRE(chisel::make_strategy(name) != nullptr);
+  }
+  REQUIRE_THROWS_AS(chisel::make_strategy("buy_and_pray"),
+                    std::invalid_argument);
+}
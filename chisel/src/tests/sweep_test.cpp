@@ -0,0 +1,170 @@
+#include "strategy/ma_crossover.h"
+#include "sweep/param_space.h"
+#include "sweep/sweep.h"
+#include "sweep/work_stealing_pool.h"
+#include "test_support.h"
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+std::vector<chisel::Bar> sine_bars(std::size_t count) {
+  return chisel::test::flat_bars(count, [](double x) {
+    return 100.0 + 10.0 * std::sin(x / 17.0) + std::sin(x);
+  });
+}
+
+chisel::MACrossover make_crossover(std::span<const double> params) {
+  return {static_cast<std::size_t>(params[0]),
+          static_cast<std::size_t>(params[1]), 10};
+}
+} // namespace
+
+TEST_CASE("ParamGrid") {
+  SECTION("Full grid walks every combination, last dimension fastest") {
+    const auto grid = chisel::full_grid(
+        {{.name = "fast", .lo = 2, .hi = 6, .step = 2},
+         {.name = "slow", .lo = 10, .hi = 11, .step = 1}});
+    REQUIRE(grid.size() == 6);
+    REQUIRE(grid.point(0)[0] == 2.0);
+    REQUIRE(grid.point(0)[1] == 10.0);
+    REQUIRE(grid.point(1)[1] == 11.0);
+    REQUIRE(grid.point(5)[0] == 6.0);
+    REQUIRE(grid.point(5)[1] == 11.0);
+  }
+
+  SECTION("Steps that don't divide the range stop short of hi") {
+    const auto grid =
+        chisel::full_grid({{.name = "x", .lo = 0.0, .hi = 1.0, .step = 0.3}});
+    REQUIRE(grid.size() == 4);
+    REQUIRE(grid.point(3)[0] == 0.0 + 3 * 0.3);
+  }
+
+  SECTION("Continuous ranges can be sampled but not gridded") {
+    const std::vector<chisel::Dimension> dims = {
+        {.name = "x", .lo = 0.0, .hi = 1.0, .step = 0.0}};
+    REQUIRE_THROWS_AS(chisel::full_grid(dims), std::invalid_argument);
+    const auto sample = chisel::random_sample(dims, 100, 3);
+    REQUIRE(sample.size() == 100);
+    for (std::size_t i = 0; i < sample.size(); ++i) {
+      REQUIRE(sample.point(i)[0] >= 0.0);
+      REQUIRE(sample.point(i)[0] < 1.0);
+    }
+  }
+
+  SECTION("Latin hypercube puts one point in every stratum") {
+    constexpr std::size_t count = 50;
+    const auto grid = chisel::latin_hypercube(
+        {{.name = "a", .lo = 0.0, .hi = 1.0, .step = 0.0},
+         {.name = "b", .lo = 1, .hi = 50, .step = 1}},
+        count, 11);
+    REQUIRE(grid.size() == count);
+
+    std::vector<int> a_hits(count);
+    std::vector<int> b_hits(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto point = grid.point(i);
+      ++a_hits[static_cast<std::size_t>(point[0] * count)];
+      // 50 steps over 50 strata, one value each
+      ++b_hits[static_cast<std::size_t>(point[1]) - 1];
+    }
+    REQUIRE(std::ranges::all_of(a_hits, [](int n) { return n == 1; }));
+    REQUIRE(std::ranges::all_of(b_hits, [](int n) { return n == 1; }));
+  }
+
+  SECTION("Bad ranges are rejected") {
+    REQUIRE_THROWS_AS(chisel::ParamGrid({{.name = "x", .lo = 2, .hi = 1}}),
+                      std::invalid_argument);
+  }
+}
+
+TEST_CASE("WorkStealingPool") {
+  chisel::WorkStealingPool pool(4);
+  REQUIRE(pool.threads() == 4);
+
+  SECTION("Every index runs exactly once") {
+    std::vector<std::atomic<int>> ran(1'000);
+    std::atomic<std::size_t> bad_workers{0};
+    pool.run(ran.size(), [&](std::size_t index, std::size_t worker) {
+      bad_workers += worker < 4 ? 0 : 1;
+      ++ran[index];
+    });
+    REQUIRE(bad_workers == 0);
+    REQUIRE(std::ranges::all_of(ran, [](const auto &n) { return n == 1; }));
+  }
+
+  SECTION("Fewer tasks than threads") {
+    std::atomic<int> ran{0};
+    pool.run(2, [&](std::size_t, std::size_t) { ++ran; });
+    REQUIRE(ran == 2);
+  }
+
+  SECTION("The first exception surfaces after the rest ran") {
+    std::atomic<int> ran{0};
+    REQUIRE_THROWS_AS(pool.run(100,
+                               [&](std::size_t index, std::size_t) {
+                                 ++ran;
+                                 if (index == 42) {
+                                   throw std::runtime_error("boom");
+                                 }
+                               }),
+                      std::runtime_error);
+    REQUIRE(ran == 100);
+  }
+}
+
+TEST_CASE("run_sweep") {
+  const auto bars = sine_bars(2'000);
+  const chisel::ExecutionModel execution;
+  const auto grid =
+      chisel::full_grid({{.name = "fast", .lo = 2, .hi = 20, .step = 2},
+                         {.name = "slow", .lo = 5, .hi = 60, .step = 5}});
+
+  const auto all = chisel::run_sweep(bars, grid, execution, make_crossover,
+                                     {.threads = 4});
+  // fast >= slow is rejected by MACrossover
+  std::size_t valid = 0;
+  for (std::size_t i = 0; i < grid.size(); ++i) {
+    valid += grid.point(i)[0] < grid.point(i)[1] ? 1U : 0U;
+  }
+  REQUIRE(all.runs == valid);
+  REQUIRE(all.skipped == grid.size() - valid);
+  REQUIRE(all.results.size() == valid);
+  REQUIRE(std::ranges::is_sorted(
+      all.results, std::ranges::greater{}, [](const auto &result) {
+        return result.summary.return_percent;
+      }));
+
+  SECTION("Results match a lone engine run") {
+    const auto &best = all.results.front();
+    auto strategy = make_crossover(grid.point(best.point));
+    chisel::BacktestEngine engine({}, strategy, execution);
+    REQUIRE(engine.run(bars).final_equity == best.summary.end_balance);
+  }
+
+  SECTION("Top-K is the head of the full ranking") {
+    std::size_t streamed = 0;
+    const auto top = chisel::run_sweep(
+        bars, grid, execution, make_crossover, {.threads = 3, .top_k = 5},
+        [&](const chisel::SweepResult &) { ++streamed; });
+    REQUIRE(streamed == valid);
+    REQUIRE(top.results.size() == 5);
+    for (std::size_t i = 0; i < 5; ++i) {
+      REQUIRE(top.results[i].point == all.results[i].point);
+    }
+  }
+
+  SECTION("Lower is better flips the ranking") {
+    const auto worst = chisel::run_sweep(bars, grid, execution,
+                                         make_crossover,
+                                         {.threads = 2,
+                                          .top_k = 1,
+                                          .lower_is_better = true});
+    REQUIRE(worst.results.size() == 1);
+    REQUIRE(worst.results[0].summary.return_percent ==
+            all.results.back().summary.return_percent);
+  }
+}
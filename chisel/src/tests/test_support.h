@@ -0,0 +1,92 @@
+#ifndef CHISEL_TESTS_TEST_SUPPORT_H
+#define CHISEL_TESTS_TEST_SUPPORT_H
+
+#include "engine/bar.h"
+#include "engine/order.h"
+#include "strategy/i_strategy.h"
+#include "strategy/strategy.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chisel::test {
+
+// NOLINTNEXTLINE
+inline constexpr std::int64_t MINUTE_MS = 60'000;
+
+/// open = high = low = close, a steady 1'000 volume
+inline Bar flat_bar(std::int64_t t, double close) {
+  return {.t = t,
+          .open = close,
+          .high = close,
+          .low = close,
+          .close = close,
+          .volume = 1'000.0,
+          .vwap = close,
+          .transactions = 10};
+}
+
+/// `count` flat bars `step_ms` apart, bar i closing at close_at(i)
+template <typename F>
+std::vector<Bar> flat_bars(std::size_t count, F close_at,
+                           std::int64_t step_ms = MINUTE_MS) {
+  std::vector<Bar> bars;
+  bars.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    bars.push_back(flat_bar(static_cast<std::int64_t>(i) * step_ms,
+                            close_at(static_cast<double>(i))));
+  }
+  return bars;
+}
+
+/// one flat bar a minute per close
+inline std::vector<Bar> bars_from_closes(const std::vector<double> &closes) {
+  return flat_bars(closes.size(), [&closes](double i) {
+    return closes[static_cast<std::size_t>(i)];
+  });
+}
+
+/// 100 plus a 10-point sine, about 94 bars a cycle
+inline std::vector<Bar> sine_bars(std::size_t count, double phase = 0.0,
+                                  std::int64_t step_ms = MINUTE_MS) {
+  return flat_bars(
+      count,
+      [phase](double x) { return 100.0 + 10.0 * std::sin(x / 15.0 + phase); },
+      step_ms);
+}
+
+/// buys 10 on step 0, sells them on step 2
+class RoundTrip : public IStrategy {
+public:
+  void reset() override {}
+  Action on_bar(const BarContext &ctx, OrderBuffer &orders) override {
+    if (ctx.step == 0) {
+      orders.push({.side = Side::buy, .quantity = 10});
+      return Action::buy;
+    }
+    if (ctx.step == 2) {
+      orders.push({.side = Side::sell, .quantity = 10});
+      return Action::sell;
+    }
+    return Action::hold;
+  }
+};
+
+/// in for 10 on steps 0 and 3, out on steps 1 and 4
+class TwoTrips : public IStrategy {
+public:
+  void reset() override {}
+  Action on_bar(const BarContext &ctx, OrderBuffer &orders) override {
+    const bool buy = ctx.step == 0 || ctx.step == 3;
+    const bool sell = ctx.step == 1 || ctx.step == 4;
+    if (buy || sell) {
+      orders.push({.side = buy ? Side::buy : Side::sell, .quantity = 10});
+    }
+    return buy ? Action::buy : (sell ? Action::sell : Action::hold);
+  }
+};
+
+} // namespace chisel::test
+
+#endif // CHISEL_TESTS_TEST_SUPPORT_H
@@ -1,6 +1,11 @@
 import React, { useState } from 'react';
 import { AggregatesServiceClient } from '@proto/AggregatesServiceClientPb';
-import { AggregateBar, AggregatesRequest, timespan_options } from '@proto/aggregates_pb';
+import {
+  AggregateBar,
+  AggregatesRequest,
+  decimation_options,
+  timespan_options,
+} from '@proto/aggregates_pb';
 import CandlestickChart from './CandlestickChart/CandlestickChart';
 import { LocalizationProvider } from '@mui/x-date-pickers/LocalizationProvider';
 import { AdapterDayjs } from '@mui/x-date-pickers/AdapterDayjs';
@@ -21,6 +26,9 @@ const timespanLabels: Record<number, string> = {
 
 const client = new AggregatesServiceClient('');
 
+// the chart is at most ~2k px wide, more candles than that are never seen
+const MAX_CHART_POINTS = 2000;
+
 const darkTheme = createTheme({
   palette: {
     mode: 'dark',
@@ -76,6 +84,8 @@ export default function AggregatesPanel() {
     request.setFromDate(fromDate.format('YYYY-MM-DD'));
     request.setToDate(toDate.format('YYYY-MM-DD'));
     request.setTimeSpan(timespan);
+    request.setMaxPoints(MAX_CHART_POINTS);
+    request.setDecimation(decimation_options.OHLC_BUCKETS);
 
     try {
       const response = await client.getAggregate(request, null);
@@ -0,0 +1,123 @@
+-- fact_aggregate_bars becomes a parent partitioned by month on bar_timestamp
+-- (epoch ms). Bars arrive roughly in time order, so BRIN on bar_timestamp stays
+-- tiny while letting range scans skip whole block ranges.
+
+ALTER TABLE fact_aggregate_bars RENAME TO fact_aggregate_bars_legacy;
+ALTER TABLE fact_aggregate_bars_legacy
+  RENAME CONSTRAINT fact_aggregate_bars_pkey TO fact_aggregate_bars_legacy_pkey;
+
+CREATE TABLE fact_aggregate_bars (
+  ticker_id VARCHAR(20) NOT NULL REFERENCES dim_tickers (ticker_id),
+  bar_timestamp BIGINT NOT NULL,
+  open DOUBLE PRECISION NOT NULL,
+  close DOUBLE PRECISION NOT NULL,
+  high DOUBLE PRECISION NOT NULL,
+  low DOUBLE PRECISION NOT NULL,
+  transactions BIGINT NOT NULL,
+  is_otc BOOLEAN NOT NULL,
+  volume DOUBLE PRECISION NOT NULL,
+  volume_weighted DOUBLE PRECISION NOT NULL,
+  request_id VARCHAR(100),
+  created_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+  updated_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+  PRIMARY KEY (ticker_id, bar_timestamp)
+) PARTITION BY RANGE (bar_timestamp);
+
+-- catches bars outside any pre-created month, drained on partition creation
+CREATE TABLE fact_aggregate_bars_default
+  PARTITION OF fact_aggregate_bars DEFAULT;
+
+CREATE INDEX brin_fact_aggregate_bars_ts
+  ON fact_aggregate_bars USING BRIN (bar_timestamp)
+  WITH (pages_per_range = 32);
+
+CREATE OR REPLACE FUNCTION aggregate_bar_month_ms(p_month DATE)
+RETURNS BIGINT AS $$
+  SELECT (EXTRACT(EPOCH FROM date_trunc('month', p_month)::TIMESTAMP
+                  AT TIME ZONE 'UTC') * 1000)::BIGINT;
+$$ LANGUAGE sql IMMUTABLE;
+
+-- Creates the monthly partition holding p_month, moving any rows already
+-- sitting in the default partition for that range. Returns the partition name.
+CREATE OR REPLACE FUNCTION create_aggregate_bar_partition(p_month DATE)
+RETURNS TEXT AS $$
+DECLARE
+  v_start DATE := date_trunc('month', p_month)::DATE;
+  v_name TEXT := 'fact_aggregate_bars_' || to_char(p_month, 'YYYYMM');
+  v_lo BIGINT := aggregate_bar_month_ms(v_start);
+  v_hi BIGINT := aggregate_bar_month_ms((v_start + INTERVAL '1 month')::DATE);
+BEGIN
+  IF to_regclass(v_name) IS NOT NULL THEN
+    RETURN v_name;
+  END IF;
+
+  EXECUTE format(
+    'CREATE TABLE %I (LIKE fact_aggregate_bars INCLUDING DEFAULTS)', v_name);
+
+  EXECUTE format(
+    'WITH moved AS ('
+    '  DELETE FROM fact_aggregate_bars_default'
+    '  WHERE bar_timestamp >= %s AND bar_timestamp < %s'
+    '  RETURNING *'
+    ') INSERT INTO %I SELECT * FROM moved',
+    v_lo, v_hi, v_name);
+
+  EXECUTE format(
+    'ALTER TABLE fact_aggregate_bars ATTACH PARTITION %I '
+    'FOR VALUES FROM (%s) TO (%s)',
+    v_name, v_lo, v_hi);
+
+  RETURN v_name;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Detaches and drops every monthly partition that ends on or before p_cutoff.
+CREATE OR REPLACE FUNCTION drop_aggregate_bar_partitions_before(p_cutoff DATE)
+RETURNS INTEGER AS $$
+DECLARE
+  r RECORD;
+  v_dropped INTEGER := 0;
+BEGIN
+  FOR r IN
+    SELECT c.relname
+    FROM pg_inherits i
+    JOIN pg_class c ON c.oid = i.inhrelid
+    WHERE i.inhparent = 'fact_aggregate_bars'::regclass
+      AND c.relname ~ '^fact_aggregate_bars_[0-9]{6}$'
+      AND (to_date(right(c.relname, 6), 'YYYYMM') + INTERVAL '1 month')
+          <= p_cutoff
+  LOOP
+    EXECUTE format('ALTER TABLE fact_aggregate_bars DETACH PARTITION %I',
+                   r.relname);
+    EXECUTE format('DROP TABLE %I', r.relname);
+    v_dropped := v_dropped + 1;
+  END LOOP;
+
+  RETURN v_dropped;
+END;
+$$ LANGUAGE plpgsql;
+
+DO $$
+DECLARE
+  v_min BIGINT;
+  v_max BIGINT;
+  v_month DATE;
+BEGIN
+  SELECT MIN(bar_timestamp), MAX(bar_timestamp)
+  INTO v_min, v_max
+  FROM fact_aggregate_bars_legacy;
+
+  IF v_min IS NOT NULL THEN
+    v_month := date_trunc('month', to_timestamp(v_min / 1000.0)
+                                   AT TIME ZONE 'UTC')::DATE;
+    WHILE aggregate_bar_month_ms(v_month) <= v_max LOOP
+      PERFORM create_aggregate_bar_partition(v_month);
+      v_month := (v_month + INTERVAL '1 month')::DATE;
+    END LOOP;
+  END IF;
+END;
+$$;
+
+INSERT INTO fact_aggregate_bars SELECT * FROM fact_aggregate_bars_legacy;
+
+DROP TABLE fact_aggregate_bars_legacy;
@@ -0,0 +1,81 @@
+-- Bars of different granularity share fact_aggregate_bars, keyed by timespan.
+-- Existing rows were all ingested as daily bars.
+
+ALTER TABLE fact_aggregate_bars
+  ADD COLUMN timespan VARCHAR(16) NOT NULL DEFAULT 'day';
+
+ALTER TABLE fact_aggregate_bars DROP CONSTRAINT fact_aggregate_bars_pkey;
+ALTER TABLE fact_aggregate_bars
+  ADD PRIMARY KEY (ticker_id, timespan, bar_timestamp);
+
+DROP FUNCTION IF EXISTS normalize_aggregate_stage(VARCHAR, VARCHAR, VARCHAR,
+                                                  VARCHAR);
+
+CREATE OR REPLACE FUNCTION normalize_aggregate_stage(
+  p_ticker_id VARCHAR,
+  p_request_id VARCHAR,
+  p_display_name VARCHAR,
+  p_source VARCHAR,
+  p_timespan VARCHAR DEFAULT 'day'
+) RETURNS VOID AS $$
+BEGIN
+  INSERT INTO dim_tickers (
+    ticker_id,
+    source,
+    display_name,
+    last_ingested_request_id
+  )
+  VALUES (
+    p_ticker_id,
+    p_source,
+    COALESCE(p_display_name, p_ticker_id),
+    p_request_id
+  )
+  ON CONFLICT (ticker_id) DO UPDATE
+    SET display_name = COALESCE(EXCLUDED.display_name, dim_tickers.display_name),
+        last_ingested_request_id = EXCLUDED.last_ingested_request_id,
+        updated_at = NOW();
+
+  INSERT INTO fact_aggregate_bars (
+    ticker_id,
+    timespan,
+    bar_timestamp,
+    open,
+    close,
+    high,
+    low,
+    transactions,
+    is_otc,
+    volume,
+    volume_weighted,
+    request_id
+  )
+  SELECT
+    p_ticker_id,
+    p_timespan,
+    t,
+    o,
+    c,
+    h,
+    l,
+    n,
+    otc,
+    v,
+    vw,
+    p_request_id
+  FROM stg_aggregates_results
+  ON CONFLICT (ticker_id, timespan, bar_timestamp) DO UPDATE
+  SET open = EXCLUDED.open,
+      close = EXCLUDED.close,
+      high = EXCLUDED.high,
+      low = EXCLUDED.low,
+      transactions = EXCLUDED.transactions,
+      is_otc = EXCLUDED.is_otc,
+      volume = EXCLUDED.volume,
+      volume_weighted = EXCLUDED.volume_weighted,
+      request_id = EXCLUDED.request_id,
+      updated_at = NOW();
+
+  TRUNCATE TABLE stg_aggregates_results;
+END;
+$$ LANGUAGE plpgsql;
@@ -0,0 +1,135 @@
+-- Day ranges whose bars are fully stored, per ticker and timespan. Bars alone
+-- can't tell a hole from a weekend, so the read-through path plans against
+-- these instead of MIN..MAX(bar_timestamp). Intervals are disjoint and never
+-- touch, record_aggregate_coverage merges them.
+
+CREATE TABLE IF NOT EXISTS agg_coverage (
+  ticker_id VARCHAR(20) NOT NULL REFERENCES dim_tickers (ticker_id),
+  timespan VARCHAR(16) NOT NULL,
+  from_day DATE NOT NULL,
+  to_day DATE NOT NULL,
+  PRIMARY KEY (ticker_id, timespan, from_day),
+  CHECK (from_day <= to_day)
+);
+
+-- Adds [p_from, p_to] (UTC days) to the coverage. Today and later may still be
+-- trading, so they are never recorded.
+CREATE OR REPLACE FUNCTION record_aggregate_coverage(
+  p_ticker_id VARCHAR,
+  p_timespan VARCHAR,
+  p_from DATE,
+  p_to DATE
+) RETURNS VOID AS $$
+DECLARE
+  v_from DATE := p_from;
+  v_to DATE := LEAST(p_to, (NOW() AT TIME ZONE 'UTC')::DATE - 1);
+BEGIN
+  IF v_to < v_from THEN
+    RETURN;
+  END IF;
+
+  -- coverage can arrive for a ticker whose days held no bars at all
+  INSERT INTO dim_tickers (ticker_id, display_name)
+  VALUES (p_ticker_id, p_ticker_id)
+  ON CONFLICT (ticker_id) DO NOTHING;
+
+  -- concurrent merges for one ticker and timespan would race on the delete
+  PERFORM pg_advisory_xact_lock(hashtext(p_ticker_id || '/' || p_timespan));
+
+  WITH merged AS (
+    DELETE FROM agg_coverage
+    WHERE ticker_id = p_ticker_id
+      AND timespan = p_timespan
+      AND from_day <= v_to + 1
+      AND to_day >= v_from - 1
+    RETURNING from_day, to_day
+  )
+  SELECT LEAST(v_from, MIN(from_day)), GREATEST(v_to, MAX(to_day))
+  INTO v_from, v_to
+  FROM merged;
+
+  INSERT INTO agg_coverage (ticker_id, timespan, from_day, to_day)
+  VALUES (p_ticker_id, p_timespan, v_from, v_to);
+END;
+$$ LANGUAGE plpgsql;
+
+-- Moves the calling session's stg_write_back rows into fact_aggregate_bars.
+-- stg_write_back is a temp table, so read-through write-backs never share
+-- rows with quarry_main's stg_aggregates_results.
+CREATE OR REPLACE FUNCTION merge_write_back(
+  p_ticker_id VARCHAR,
+  p_request_id VARCHAR,
+  p_timespan VARCHAR
+) RETURNS VOID AS $$
+BEGIN
+  INSERT INTO dim_tickers (ticker_id, display_name, last_ingested_request_id)
+  VALUES (p_ticker_id, p_ticker_id, p_request_id)
+  ON CONFLICT (ticker_id) DO UPDATE
+    SET last_ingested_request_id = EXCLUDED.last_ingested_request_id,
+        updated_at = NOW();
+
+  INSERT INTO fact_aggregate_bars (
+    ticker_id,
+    timespan,
+    bar_timestamp,
+    open,
+    close,
+    high,
+    low,
+    transactions,
+    is_otc,
+    volume,
+    volume_weighted,
+    request_id
+  )
+  SELECT
+    p_ticker_id,
+    p_timespan,
+    t,
+    o,
+    c,
+    h,
+    l,
+    n,
+    otc,
+    v,
+    vw,
+    p_request_id
+  FROM pg_temp.stg_write_back
+  ON CONFLICT (ticker_id, timespan, bar_timestamp) DO UPDATE
+  SET open = EXCLUDED.open,
+      close = EXCLUDED.close,
+      high = EXCLUDED.high,
+      low = EXCLUDED.low,
+      transactions = EXCLUDED.transactions,
+      is_otc = EXCLUDED.is_otc,
+      volume = EXCLUDED.volume,
+      volume_weighted = EXCLUDED.volume_weighted,
+      request_id = EXCLUDED.request_id,
+      updated_at = NOW();
+END;
+$$ LANGUAGE plpgsql;
+
+-- Seed from what is already stored: each run of consecutive days with bars,
+-- minus a group's last day, which may have been loaded mid-session. Weekends
+-- split runs; the first read across one fetches it and closes the gap.
+INSERT INTO agg_coverage (ticker_id, timespan, from_day, to_day)
+SELECT ticker_id, timespan, MIN(day), MAX(day)
+FROM (
+  SELECT
+    ticker_id,
+    timespan,
+    day,
+    day - (ROW_NUMBER() OVER (PARTITION BY ticker_id, timespan
+                              ORDER BY day))::INT AS island,
+    MAX(day) OVER (PARTITION BY ticker_id, timespan) AS last_day
+  FROM (
+    SELECT DISTINCT
+      ticker_id,
+      timespan,
+      (TO_TIMESTAMP(bar_timestamp / 1000.0) AT TIME ZONE 'UTC')::DATE AS day
+    FROM fact_aggregate_bars
+  ) stored_days
+) days
+WHERE day < last_day
+GROUP BY ticker_id, timespan, island;
@@ -2,9 +2,11 @@
 #define BASE_ENDPOINT_H
 
 #include <array>
+#include <chrono>
 #include <concepts>
 #include <cstdint>
 #include <expected>
+#include <format>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -89,6 +91,29 @@ timespan_resolver(const uint8_t value) noexcept {
          is_digit(s[5]) && is_digit(s[6]) && is_digit(s[8]) && is_digit(s[9]);
 }
 
+/// @pre is_iso_date(s)
+[[nodiscard]] constexpr std::chrono::sys_days
+parse_iso_date(const std::string_view s) noexcept {
+  auto number = [&](std::size_t pos, std::size_t len) constexpr noexcept {
+    int value = 0;
+    for (std::size_t i = pos; i < pos + len; ++i) {
+      value = (value * 10) + (s[i] - '0');
+    }
+    return value;
+  };
+  return std::chrono::sys_days{
+      std::chrono::year{number(0, 4)} /
+      std::chrono::month{static_cast<unsigned>(number(5, 2))} /
+      std::chrono::day{static_cast<unsigned>(number(8, 2))}};
+}
+
+[[nodiscard]] inline std::string to_iso_date(std::chrono::sys_days days) {
+  const std::chrono::year_month_day ymd{days};
+  return std::format("{:04}-{:02}-{:02}", static_cast<int>(ymd.year()),
+                     static_cast<unsigned>(ymd.month()),
+                     static_cast<unsigned>(ymd.day()));
+}
+
 template <class T>
 concept endpoint_c = requires(const T &ep) {
   { ep.method() } -> std::same_as<method_type>;
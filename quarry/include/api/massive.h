@@ -6,11 +6,21 @@
 #include "logging.h"
 #include <glaze/glaze.hpp>
 #include <memory>
+#include <optional>
 #include <quill/LogMacros.h>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace quarry {
 
+/**
+ * The only field a paginating caller needs out of an otherwise unparsed page.
+ */
+struct PageCursor {
+  std::optional<std::string> next_url;
+};
+
 /**
  * Rule of zero - movable via unique_ptr, non-copyable.
  */
@@ -96,6 +106,44 @@ public:
     }
   };
 
+  /**
+   * @brief Raw JSON bodies of a paginated request.
+   *
+   * Only `next_url` is skimmed out of each page, the full parse is left to the
+   * caller so it can run elsewhere (e.g. a separate pipeline stage).
+   */
+  template <quarry::endpoint_c E>
+  auto fetch_pages(const E &ep) -> std::generator<std::string> {
+    std::string url = m_authenticate_url(ep);
+
+    while (!url.empty()) {
+      http::response<http::string_body> result;
+      if (ep.method() == quarry::method_type::GET) {
+        result = m_http->get(url);
+      } else {
+        result = m_http->post(url);
+      }
+
+      std::string body = std::move(result.body());
+
+      PageCursor cursor{};
+      constexpr glz::opts skim_opts{.error_on_unknown_keys = false};
+      if (auto ec = glz::read<skim_opts>(cursor, body); ec) {
+        auto *logger = quarry::logging::get_logger();
+        LOG_ERROR(logger, "JSON cursor parse failed {}",
+                  glz::format_error(ec, body));
+        throw std::runtime_error("parse failed");
+      }
+
+      url = cursor.next_url.value_or("");
+      if (!url.empty()) {
+        url = m_authenticate_url(url);
+      }
+
+      co_yield std::move(body);
+    }
+  };
+
 private:
   std::string m_api_key;
 
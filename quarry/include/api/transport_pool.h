@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <vector>
 
 namespace quarry {
@@ -37,7 +38,8 @@ public:
   TransportPool(TransportPool const &other) noexcept = delete;
   TransportPool &operator=(TransportPool const &other) = delete;
 
-  ~TransportPool() noexcept = default;
+  /// takes its connections off the capacity gauge
+  ~TransportPool() noexcept;
 
   void send_and_read(const http::request<http::string_body> &request,
                      http::response<http::string_body> &response);
@@ -0,0 +1,95 @@
+#ifndef QUARRY_BARS_BAR_COLUMNS_H
+#define QUARRY_BARS_BAR_COLUMNS_H
+
+#include "api/endpoints/aggregates.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace quarry {
+
+/**
+ * Rule of zero - column-major aggregate bars, one contiguous array per field.
+ *
+ * Field names follow ep::AggBar. `otc` is stored as bytes to keep it a real
+ * contiguous array (std::vector<bool> is bit-packed).
+ */
+struct BarColumns {
+  std::vector<double> o;
+  std::vector<double> c;
+  std::vector<double> h;
+  std::vector<double> l;
+  std::vector<std::int64_t> n;
+  std::vector<std::uint8_t> otc;
+  std::vector<std::int64_t> t;
+  std::vector<double> v;
+  std::vector<double> vw;
+
+  [[nodiscard]] std::size_t size() const noexcept { return t.size(); }
+  [[nodiscard]] bool empty() const noexcept { return t.empty(); }
+
+  void reserve(std::size_t rows) {
+    o.reserve(rows);
+    c.reserve(rows);
+    h.reserve(rows);
+    l.reserve(rows);
+    n.reserve(rows);
+    otc.reserve(rows);
+    t.reserve(rows);
+    v.reserve(rows);
+    vw.reserve(rows);
+  }
+
+  /// keeps capacity so a chunk buffer can be refilled without reallocating
+  void clear() noexcept {
+    o.clear();
+    c.clear();
+    h.clear();
+    l.clear();
+    n.clear();
+    otc.clear();
+    t.clear();
+    v.clear();
+    vw.clear();
+  }
+
+  void push_back(const ep::AggBar &bar) {
+    o.push_back(bar.o);
+    c.push_back(bar.c);
+    h.push_back(bar.h);
+    l.push_back(bar.l);
+    n.push_back(bar.n);
+    otc.push_back(static_cast<std::uint8_t>(bar.otc));
+    t.push_back(bar.t);
+    v.push_back(bar.v);
+    vw.push_back(bar.vw);
+  }
+
+  void append(const BarColumns &other) {
+    o.insert(o.end(), other.o.begin(), other.o.end());
+    c.insert(c.end(), other.c.begin(), other.c.end());
+    h.insert(h.end(), other.h.begin(), other.h.end());
+    l.insert(l.end(), other.l.begin(), other.l.end());
+    n.insert(n.end(), other.n.begin(), other.n.end());
+    otc.insert(otc.end(), other.otc.begin(), other.otc.end());
+    t.insert(t.end(), other.t.begin(), other.t.end());
+    v.insert(v.end(), other.v.begin(), other.v.end());
+    vw.insert(vw.end(), other.vw.begin(), other.vw.end());
+  }
+
+  [[nodiscard]] ep::AggBar bar(std::size_t i) const {
+    return ep::AggBar{.o = o[i],
+                      .c = c[i],
+                      .h = h[i],
+                      .l = l[i],
+                      .n = n[i],
+                      .otc = otc[i] != 0,
+                      .t = t[i],
+                      .v = v[i],
+                      .vw = vw[i]};
+  }
+};
+
+} // namespace quarry
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef QUARRY_BARS_DECIMATE_H
+#define QUARRY_BARS_DECIMATE_H
+
+#include "bars/bar_columns.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace quarry {
+
+enum class Decimation : std::uint8_t {
+  /// merge runs of consecutive bars into one bar each, candles stay honest
+  ohlc_buckets,
+  /// Largest-Triangle-Three-Buckets over close, keeps real bars, for lines
+  lttb
+};
+
+/**
+ * Downsamples `bars` to at most `max_points` rows into `out` (cleared first).
+ *
+ * ohlc_buckets splits the rows into `max_points` near-equal index runs and
+ * merges each run: first open and t, last close, max high, min low, summed
+ * volume and trades, volume-weighted vw, otc if any bar was. Every pass is a
+ * plain loop over one contiguous column so the compiler can vectorize it.
+ *
+ * lttb picks one bar per run, the one spanning the largest triangle with the
+ * previous pick and the next run's mean close. First and last bars are kept.
+ *
+ * `bars` is copied as-is when it already fits or `max_points` is 0.
+ */
+void decimate(const BarColumns &bars, std::size_t max_points, Decimation mode,
+              BarColumns &out);
+
+} // namespace quarry
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef QUARRY_BARS_RESAMPLE_H
+#define QUARRY_BARS_RESAMPLE_H
+
+#include "bars/bar_columns.h"
+#include "base_endpoint.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace quarry {
+
+/**
+ * Rule of zero - the exchange clock that bucket boundaries are drawn on.
+ *
+ * Defaults to US equities: New York time, US daylight saving rules (second
+ * Sunday of March to first Sunday of November since 2007), 09:30-16:00
+ * regular hours.
+ */
+struct Session {
+  std::chrono::minutes standard_offset{-5 * 60};
+  bool us_daylight_saving = true;
+  std::chrono::minutes open{9 * 60 + 30};
+  std::chrono::minutes close{16 * 60};
+  /// drop pre/post-market bars, intraday buckets then start at `open`
+  bool regular_hours_only = false;
+
+  /// offset from UTC in effect at `utc_ms`
+  [[nodiscard]] std::chrono::minutes offset_at(std::int64_t utc_ms) const;
+
+  /// first UTC ms after `utc_ms` where offset_at changes, INT64_MAX if never
+  [[nodiscard]] std::int64_t offset_until(std::int64_t utc_ms) const;
+};
+
+/**
+ * @brief Streams fine bars into coarser ones, e.g. MINUTE into 4 HOUR or
+ * WEEK bars.
+ *
+ * Buckets are drawn in exchange-local time: days start at local midnight,
+ * weeks on Sunday, months, quarters and years on the 1st; intraday buckets
+ * count from local midnight, or from the open when only regular hours are
+ * kept. Each output bar is stamped with its bucket start in UTC ms, like
+ * Massive's own bars.
+ *
+ * Per bucket: first open, last close, max high, min low, summed volume and
+ * transactions, volume-weighted vw, otc if any input bar was. Input must be
+ * in timestamp order; a bucket is emitted once a bar past it arrives, or on
+ * `flush`. `push` keys a whole chunk first, then folds each run of equal keys
+ * column by column, so the hot loops are branch-free passes over contiguous
+ * arrays. Keying does calendar math once per bucket, not per bar: it keeps
+ * the UTC span the current key holds for (up to the bucket's end, a session
+ * edge or a DST switch) and only compares timestamps against it.
+ *
+ * Rule of zero.
+ */
+class Resampler {
+public:
+  /// @throws std::invalid_argument for SECOND, which no stored bar can feed
+  Resampler(timespan_options timespan, std::uint32_t multiplier,
+            Session session = {});
+
+  /// appends every bucket `fine` completes to `out`
+  void push(const BarColumns &fine, BarColumns &out);
+
+  /// appends the open bucket, if any, to `out`
+  void flush(BarColumns &out);
+
+  /// start of the bucket holding `t_ms`, in UTC ms
+  [[nodiscard]] std::int64_t bucket_of(std::int64_t t_ms) const;
+
+private:
+  struct Partial {
+    std::int64_t t = 0;
+    double o = 0.0;
+    double c = 0.0;
+    double h = 0.0;
+    double l = 0.0;
+    double v = 0.0;
+    double traded = 0.0;
+    std::int64_t n = 0;
+    bool otc = false;
+    double last_vw = 0.0;
+  };
+
+  timespan_options m_timespan;
+  std::int64_t m_multiplier;
+  Session m_session;
+
+  bool m_open = false;
+  Partial m_partial;
+  // every t in [m_run_begin, m_run_end) keys to m_run_key
+  std::int64_t m_run_begin = 0;
+  std::int64_t m_run_end = 0;
+  std::int64_t m_run_key = 0;
+  // per chunk scratch, keeps its capacity
+  std::vector<std::int64_t> m_keys;
+
+  struct LocalBucket {
+    std::int64_t start;
+    std::int64_t end;
+  };
+
+  /// bounds of the bucket holding a local-time ms, in local ms
+  [[nodiscard]] LocalBucket local_bucket(std::int64_t local) const;
+  /// sets the run holding `t_ms`
+  void key_run(std::int64_t t_ms);
+  void fold(const BarColumns &fine, std::size_t begin, std::size_t end);
+  void emit(BarColumns &out) const;
+};
+
+/// one-shot Resampler over a whole range
+[[nodiscard]] BarColumns resample(const BarColumns &fine,
+                                  timespan_options timespan,
+                                  std::uint32_t multiplier,
+                                  const Session &session = {});
+
+} // namespace quarry
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef QUARRY_DB_BAR_READER_H
+#define QUARRY_DB_BAR_READER_H
+
+#include "bars/bar_columns.h"
+#include "base_endpoint.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <pqxx/pqxx>
+#include <string>
+
+namespace quarry {
+
+/// inclusive range of exchange days, the dates Massive takes
+struct DayRange {
+  std::chrono::sys_days from;
+  std::chrono::sys_days to;
+
+  bool operator==(const DayRange &) const = default;
+};
+
+struct BarQuery {
+  std::string ticker;
+  // epoch ms, both ends inclusive
+  std::int64_t from_ms;
+  std::int64_t to_ms;
+  timespan_options timespan = timespan_options::DAY;
+};
+
+/**
+ * @brief Streams fact_aggregate_bars rows in timestamp order straight into
+ * column arrays.
+ *
+ * Rows come through `COPY (...) TO STDOUT` via pqxx::stream, so neither a
+ * pqxx::result nor per-row pqxx::row objects are ever materialized. The chunk
+ * buffer is reused between callbacks, memory stays at `chunk_rows` bars no
+ * matter how long the range is.
+ *
+ * Rule of zero - non-owning view over a connection.
+ */
+class BarReader {
+public:
+  using chunk_callback = std::function<void(const BarColumns &)>;
+
+  // NOLINTNEXTLINE
+  static constexpr std::size_t DEFAULT_CHUNK_ROWS = 64 * 1024;
+
+  explicit BarReader(pqxx::connection &conn,
+                     std::size_t chunk_rows = DEFAULT_CHUNK_ROWS);
+
+  /**
+   * @param on_chunk called with at most `chunk_rows` bars at a time, the
+   * columns are only valid for the duration of the call
+   * @return total number of bars read
+   */
+  std::size_t read(const BarQuery &query, const chunk_callback &on_chunk);
+
+  [[nodiscard]] BarColumns read_all(const BarQuery &query);
+
+private:
+  pqxx::connection &m_conn;
+  std::size_t m_chunk_rows;
+};
+
+} // namespace quarry
+
+#endif
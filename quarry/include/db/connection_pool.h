@@ -0,0 +1,106 @@
+#ifndef QUARRY_DB_CONNECTION_POOL_H
+#define QUARRY_DB_CONNECTION_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <libpq-fe.h>
+#include <memory>
+#include <mutex>
+#include <pqxx/pqxx>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace quarry {
+
+inline constexpr std::string_view DEFAULT_PG_CONNINFO =
+    "host=localhost port=5432 dbname=marble user=user password=password";
+
+/**
+ * @brief Thread-safe pool of Postgres connections, each remembering which
+ * statements have already been prepared on it.
+ *
+ * Connections are opened on first use and reopened when found broken.
+ *
+ * Rule of 5: non-copyable, non-movable (mutex/cv, leases point back here).
+ */
+class ConnectionPool {
+public:
+  using Index = std::size_t;
+
+  /**
+   * Rule of 5: move ctor allowed, copy ops and move-assign deleted; returns
+   * its connection to the pool on destruction.
+   */
+  class Lease {
+  public:
+    Lease(ConnectionPool &pool, Index idx) noexcept;
+
+    Lease(Lease &&other) noexcept;
+    Lease &operator=(Lease &&) noexcept = delete;
+
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+
+    ~Lease() noexcept;
+
+    [[nodiscard]] pqxx::connection &conn();
+
+    /// prepares `name` on this connection unless it already was
+    void prepare(pqxx::zview name, pqxx::zview sql);
+
+    /**
+     * Hands this lease's session to raw libpq, e.g. for SqlPipeline. The
+     * session and its prepared statements survive, but conn() must not be
+     * called until restore_raw gives it back.
+     */
+    [[nodiscard]] PGconn *take_raw();
+
+    /**
+     * Wraps `raw` from take_raw again. A null `raw` means the caller had to
+     * close it: the next conn() opens a fresh session.
+     */
+    void restore_raw(PGconn *raw) noexcept;
+
+  private:
+    ConnectionPool *m_pool;
+    Index m_idx;
+  };
+
+  ConnectionPool(std::size_t max_connections,
+                 std::string_view conninfo = DEFAULT_PG_CONNINFO);
+
+  ConnectionPool(ConnectionPool &&) noexcept = delete;
+  ConnectionPool &operator=(ConnectionPool &&) noexcept = delete;
+
+  ConnectionPool(const ConnectionPool &) = delete;
+  ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+  /// takes its connections off the capacity gauge
+  ~ConnectionPool() noexcept;
+
+  /// blocks until a connection is free
+  [[nodiscard]] Lease acquire();
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return m_slots.size(); }
+
+private:
+  struct Slot {
+    std::unique_ptr<pqxx::connection> conn;
+    std::unordered_set<std::string> prepared;
+  };
+
+  std::string m_conninfo;
+  std::vector<Slot> m_slots;
+  std::vector<Index> m_free_list;
+  std::mutex m_free_mutex;
+  std::condition_variable m_free_cv;
+
+  void release(Index idx) noexcept;
+  Slot &open_slot(Index idx);
+};
+
+} // namespace quarry
+
+#endif
@@ -1,24 +1,37 @@
 #ifndef SQL_HANDLER_H
 #define SQL_HANDLER_H
 
+#include "connection_pool.h"
+#include <chrono>
 #include <filesystem>
-#include <memory>
+#include <map>
+#include <optional>
 #include <pqxx/pqxx>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <unordered_set>
 namespace fs = std::filesystem;
 
 namespace quarry {
 
+/**
+ * Monthly fact_aggregate_bars partition upkeep, see V03__agg_partition.sql.
+ */
+struct PartitionPolicy {
+  int months_behind = 1;
+  int months_ahead = 3;
+  // partitions older than this many months are dropped, kept forever if unset
+  std::optional<int> retention_months = std::nullopt;
+};
+
 /**
  Usage:
      int latest_version = get_last_applied_version();
      apply_migrations(latest_version);
 */
 class Migration {
-  using file_map = std::unordered_map<int, fs::path>;
+  // by version, applied in order
+  using file_map = std::map<int, fs::path>;
 
 public:
   Migration();
@@ -30,8 +43,13 @@ public:
   pqxx::result execute(std::string_view mig_script, const pqxx::params &p = {});
   void execute_script(std::string_view sql_script);
 
+  void create_partitions(std::chrono::year_month from,
+                         std::chrono::year_month to);
+  int drop_partitions_before(std::chrono::year_month cutoff);
+  void maintain_partitions(const PartitionPolicy &policy = {});
+
 private:
-  std::unique_ptr<pqxx::connection> m_conn;
+  ConnectionPool m_connections{1};
 };
 
 } // namespace quarry
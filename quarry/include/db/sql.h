@@ -1,26 +1,84 @@
 #ifndef QUARRY_SQL
 #define QUARRY_SQL
 #include "aggregates.h"
+#include "bar_reader.h"
+#include "connection_pool.h"
+#include "sql_pipeline.h"
+#include "statements.h"
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <pqxx/pqxx>
+#include <span>
+#include <string>
 #include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 namespace quarry {
 
 class Sql {
 private:
-  static std::unique_ptr<pqxx::connection> &get_connection();
+  static ConnectionPool &pool();
 
 public:
   static pqxx::result execute(std::string_view query);
+
+  /**
+   * Runs a registered statement, preparing it first if this pooled
+   * connection has not seen it yet.
+   *
+   * Example:
+   *   Sql::exec(statements::bar_coverage, ticker, std::string{"day"});
+   */
+  template <class... Args>
+  static pqxx::result exec(const Statement<Args...> &stmt,
+                           const std::type_identity_t<Args> &...args) {
+    auto lease = pool().acquire();
+    lease.prepare(stmt.name, stmt.sql);
+    pqxx::work txn(lease.conn());
+    pqxx::result result =
+        txn.exec(pqxx::prepped{stmt.name}, pqxx::params{args...});
+    txn.commit();
+    return result;
+  }
+
+  /**
+   * Runs what `fill` pushes as one pipelined batch on a pooled connection:
+   * one round trip and one implicit transaction, so the statements commit
+   * together or not at all.
+   *
+   * Example:
+   *   Sql::batch([&](SqlPipeline &batch) {
+   *     batch.push(statements::record_coverage, ticker, span, from, to);
+   *   });
+   *
+   * @throws std::runtime_error with the first failed statement's error
+   */
+  static void batch(const std::function<void(SqlPipeline &)> &fill);
+
   static void normalize_staged_aggregates(
       std::string_view ticker,
       std::optional<std::string_view> request_id = std::nullopt,
       std::optional<std::string_view> display_name = std::nullopt,
-      std::optional<std::string_view> source = std::nullopt);
+      std::optional<std::string_view> source = std::nullopt,
+      timespan_options timespan = timespan_options::DAY);
+
+  /**
+   * Small-range bar read through the prepared bar_range statement, for
+   * interactive requests. Use read_bars for long ranges.
+   */
+  static BarColumns fetch_bars(const BarQuery &query);
+
+  /**
+   * Streams stored bars for `query` in chunks, see BarReader.
+   *
+   * @return total number of bars read
+   */
+  static std::size_t
+  read_bars(const BarQuery &query, const BarReader::chunk_callback &on_chunk,
+            std::size_t chunk_rows = BarReader::DEFAULT_CHUNK_ROWS);
 
   /**
    * Bulk insert of raw structured data into a staging table.
@@ -40,8 +98,37 @@ public:
   static void bulk_insert(const std::vector<T> &rows,
                           const std::string &table_name,
                           const std::array<std::string, N> &columns) {
-    pqxx::work txn(*get_connection());
+    auto lease = pool().acquire();
+    pqxx::work txn(lease.conn());
+    stream_rows(txn, rows, table_name, columns);
+    txn.commit();
+  }
+
+  /// stored day intervals for a ticker and timespan, disjoint and in order
+  [[nodiscard]] static std::vector<DayRange>
+  coverage(const std::string &ticker, timespan_options timespan);
+
+  /// marks `days` as fully stored, see record_aggregate_coverage
+  static void record_coverage(std::string_view ticker,
+                              timespan_options timespan, DayRange days);
 
+  /**
+   * Upserts bars fetched for one ticker and timespan and marks `covered` as
+   * stored, in one transaction on one connection. Rows are staged in a temp
+   * table private to that connection, never in the stg_aggregates_results
+   * table quarry_main ingests through.
+   */
+  static void upsert_bars(std::string_view ticker, std::string_view request_id,
+                          timespan_options timespan,
+                          const std::vector<ep::AggBar> &bars,
+                          std::span<const DayRange> covered);
+
+private:
+  /// COPYs `rows` into `table_name` inside `txn`
+  template <quarry::bulk_uploadable_c T, std::size_t N>
+  static void stream_rows(pqxx::work &txn, const std::vector<T> &rows,
+                          const std::string &table_name,
+                          const std::array<std::string, N> &columns) {
     std::string columns_str;
     for (std::size_t i = 0; i < columns.size(); ++i) {
       if (i > 0) {
@@ -60,7 +147,6 @@ public:
     }
 
     pg_stream.complete();
-    txn.commit();
   }
 };
 } // namespace quarry
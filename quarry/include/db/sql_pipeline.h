@@ -0,0 +1,129 @@
+#ifndef QUARRY_DB_SQL_PIPELINE_H
+#define QUARRY_DB_SQL_PIPELINE_H
+
+#include "connection_pool.h"
+#include "statements.h"
+#include <cstddef>
+#include <cstdint>
+#include <libpq-fe.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace quarry {
+
+struct PgResultDeleter {
+  void operator()(PGresult *result) const noexcept { PQclear(result); }
+};
+
+/**
+ * Rule of zero - owns one statement result of a pipeline batch.
+ */
+class PipelineResult {
+public:
+  explicit PipelineResult(PGresult *result);
+
+  [[nodiscard]] bool ok() const noexcept;
+  [[nodiscard]] ExecStatusType status() const noexcept;
+  [[nodiscard]] std::string_view error() const noexcept;
+  [[nodiscard]] int rows() const noexcept;
+  [[nodiscard]] int columns() const noexcept;
+  [[nodiscard]] std::size_t affected_rows() const;
+  [[nodiscard]] std::optional<std::string_view> value(int row, int col) const;
+
+private:
+  std::unique_ptr<PGresult, PgResultDeleter> m_result;
+};
+
+/**
+ * @brief Batches parameterized statements over libpq pipeline mode, on a
+ * pooled connection borrowed for the pipeline's lifetime.
+ *
+ * Every `push` is written to the socket without waiting for the previous
+ * statement, `sync` then collects all results in one round trip. Statements
+ * between two syncs run in one implicit transaction: the first failure
+ * aborts the rest (reported as PGRES_PIPELINE_ABORTED) and nothing commits.
+ * An explicit BEGIN keeps the transaction open across syncs until COMMIT.
+ *
+ * The connection is non-blocking: each `push` also reads whatever results
+ * have already arrived, and `sync` interleaves flushing and reading, so a
+ * large batch never deadlocks with both socket buffers full.
+ *
+ * Statements pushed but never synced are abandoned with the session, and an
+ * open transaction is rolled back, before the lease gets its connection back.
+ *
+ * Rule of 5: non-copyable, non-movable (borrows the lease's session).
+ */
+class SqlPipeline {
+public:
+  using Param = std::optional<std::string>;
+
+  explicit SqlPipeline(ConnectionPool::Lease &lease);
+
+  SqlPipeline(SqlPipeline &&) noexcept = delete;
+  SqlPipeline &operator=(SqlPipeline &&) noexcept = delete;
+
+  SqlPipeline(const SqlPipeline &) = delete;
+  SqlPipeline &operator=(const SqlPipeline &) = delete;
+
+  ~SqlPipeline() noexcept;
+
+  /**
+   * @param params text-format parameters, std::nullopt binds NULL
+   * @return index of this statement's result in the next `sync`
+   */
+  std::size_t push(std::string_view query,
+                   const std::vector<Param> &params = {});
+
+  /// queues a registered statement, its arguments checked as in Sql::exec
+  template <class... Args>
+  std::size_t push(const Statement<Args...> &stmt,
+                   const std::type_identity_t<Args> &...args) {
+    return push(stmt.sql, {to_param(args)...});
+  }
+
+  /// @return one result per pushed statement, in push order
+  [[nodiscard]] std::vector<PipelineResult> sync();
+
+  /**
+   * Runs a multi-statement script between syncs, e.g. a migration inside a
+   * transaction the pipeline began. Pipeline mode only carries one statement
+   * per query, so this leaves it for the script and re-enters after.
+   *
+   * @throws std::runtime_error if the script fails
+   */
+  void run_script(std::string_view script);
+
+  [[nodiscard]] std::size_t pending() const noexcept { return m_pending; }
+
+private:
+  ConnectionPool::Lease &m_lease;
+  PGconn *m_conn;
+  std::size_t m_pending = 0;
+  // results read so far, one per statement since the last sync
+  std::vector<PipelineResult> m_results;
+  // got a statement's result, its terminating null result is still due
+  bool m_in_statement = false;
+
+  static Param to_param(const std::string &value) { return value; }
+  static Param to_param(const std::optional<std::string> &value) {
+    return value;
+  }
+  static Param to_param(std::int64_t value) { return std::to_string(value); }
+
+  /// switches the session into (true) or out of pipeline mode
+  void pipeline_mode(bool on);
+  /// @return true while output is still queued
+  bool flush();
+  /// reads what arrived without blocking, @return true at the sync point
+  bool collect();
+  /// blocks until the socket is readable (or writable, if asked)
+  void wait(bool writable) const;
+};
+
+} // namespace quarry
+
+#endif
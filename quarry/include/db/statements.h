@@ -0,0 +1,73 @@
+#ifndef QUARRY_DB_STATEMENTS_H
+#define QUARRY_DB_STATEMENTS_H
+
+#include <cstdint>
+#include <optional>
+#include <pqxx/pqxx>
+#include <string>
+
+namespace quarry {
+
+/**
+ * @brief A named statement prepared lazily on each pooled connection.
+ *
+ * @tparam Args parameter types, bound in order to $1..$N, checked at the
+ * call site by Sql::exec.
+ */
+template <class... Args> struct Statement {
+  pqxx::zview name;
+  pqxx::zview sql;
+};
+
+/**
+ * Registry of hot statements. Add new ones here rather than building query
+ * text at the call site, so the server plans them once per connection.
+ */
+namespace statements {
+
+// ticker, request_id, display_name, source, timespan
+inline constexpr Statement<std::string, std::optional<std::string>,
+                           std::optional<std::string>, std::string,
+                           std::string>
+    normalize_aggregates{
+        "normalize_aggregates",
+        "SELECT normalize_aggregate_stage($1, $2, $3, $4, $5)"};
+
+// ticker, timespan -> from_day, to_day per stored interval, in order
+inline constexpr Statement<std::string, std::string> bar_coverage{
+    "bar_coverage",
+    "SELECT from_day::TEXT, to_day::TEXT FROM agg_coverage "
+    "WHERE ticker_id = $1 AND timespan = $2 ORDER BY from_day"};
+
+// ticker, timespan, from day, to day (ISO, inclusive)
+inline constexpr Statement<std::string, std::string, std::string,
+                           std::string>
+    record_coverage{"record_coverage",
+                    "SELECT record_aggregate_coverage($1, $2, $3::DATE, "
+                    "$4::DATE)"};
+
+// ticker, request_id, timespan; reads the session's stg_write_back
+inline constexpr Statement<std::string, std::string, std::string>
+    merge_write_back{"merge_write_back",
+                     "SELECT merge_write_back($1, $2, $3)"};
+
+// ticker, timespan, from ms, to ms (inclusive)
+inline constexpr Statement<std::string, std::string, std::int64_t,
+                           std::int64_t>
+    bar_range{"bar_range",
+              "SELECT bar_timestamp, open, close, high, low, transactions, "
+              "is_otc, volume, volume_weighted "
+              "FROM fact_aggregate_bars "
+              "WHERE ticker_id = $1 AND timespan = $2 "
+              "AND bar_timestamp BETWEEN $3 AND $4 "
+              "ORDER BY bar_timestamp"};
+
+// any day of the month (ISO) -> its partition, see V03__agg_partition.sql
+inline constexpr Statement<std::string> create_partition{
+    "create_partition", "SELECT create_aggregate_bar_partition($1::DATE)"};
+
+} // namespace statements
+
+} // namespace quarry
+
+#endif
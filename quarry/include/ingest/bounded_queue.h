@@ -0,0 +1,98 @@
+#ifndef QUARRY_INGEST_BOUNDED_QUEUE_H
+#define QUARRY_INGEST_BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace quarry {
+
+/**
+ * @brief Blocking multi-producer multi-consumer FIFO with a fixed capacity.
+ *
+ * `push` blocks while full, which is what propagates backpressure from a slow
+ * stage to the ones feeding it. Items are moved in and out, never copied.
+ *
+ * Rule of 5: non-copyable, non-movable (mutex/cv).
+ */
+template <class T> class BoundedQueue {
+public:
+  explicit BoundedQueue(std::size_t capacity)
+      : m_capacity(capacity == 0 ? 1 : capacity) {}
+
+  BoundedQueue(BoundedQueue &&) noexcept = delete;
+  BoundedQueue &operator=(BoundedQueue &&) noexcept = delete;
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+  ~BoundedQueue() noexcept = default;
+
+  /// @return false if the queue was closed, `item` is then left untouched
+  bool push(T &&item) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_full.wait(lock,
+                    [&]() { return m_closed || m_items.size() < m_capacity; });
+    if (m_closed) {
+      return false;
+    }
+    m_items.push_back(std::move(item));
+    lock.unlock();
+    m_not_empty.notify_one();
+    return true;
+  }
+
+  /// non-blocking push, @return false if full or closed
+  bool try_push(T &&item) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_closed || m_items.size() >= m_capacity) {
+        return false;
+      }
+      m_items.push_back(std::move(item));
+    }
+    m_not_empty.notify_one();
+    return true;
+  }
+
+  /// @return std::nullopt once the queue is closed and drained
+  std::optional<T> pop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_empty.wait(lock, [&]() { return m_closed || !m_items.empty(); });
+    if (m_items.empty()) {
+      return std::nullopt;
+    }
+    std::optional<T> item{std::move(m_items.front())};
+    m_items.pop_front();
+    lock.unlock();
+    m_not_full.notify_one();
+    return item;
+  }
+
+  /// no more pushes accepted, consumers drain what is left
+  void close() noexcept {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closed = true;
+    }
+    m_not_empty.notify_all();
+    m_not_full.notify_all();
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return m_capacity; }
+
+private:
+  std::size_t m_capacity;
+  std::deque<T> m_items;
+  bool m_closed = false;
+  std::mutex m_mutex;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+};
+
+} // namespace quarry
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef QUARRY_INGEST_STAGE_H
+#define QUARRY_INGEST_STAGE_H
+
+#include "ingest/bounded_queue.h"
+#include "logging.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <quill/LogMacros.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace quarry {
+
+struct StageStats {
+  std::atomic<std::uint64_t> items{0};
+  std::atomic<std::uint64_t> rows{0};
+  std::atomic<std::uint64_t> errors{0};
+  std::atomic<std::uint64_t> busy_ns{0};
+  std::atomic<std::int64_t> wall_ns{0};
+};
+
+/**
+ * @brief A fixed number of workers draining one BoundedQueue.
+ *
+ * Each worker pops an item and hands it to `on_item`, which pushes whatever
+ * it produces into the next stage's queue and returns how many rows it
+ * handled (for throughput). When the input is closed and drained, the last
+ * worker out runs `on_drained`, normally closing the downstream queue.
+ *
+ * A throwing handler is logged and counted in `errors`, the worker carries on.
+ *
+ * Rule of 5: non-copyable, non-movable (workers hold `this`).
+ */
+template <class In> class Stage {
+public:
+  using handler = std::function<std::size_t(In &&)>;
+
+  Stage(std::string name, std::size_t workers, BoundedQueue<In> &input,
+        handler on_item, std::function<void()> on_drained = {})
+      : m_name(std::move(name)), m_input(input), m_on_item(std::move(on_item)),
+        m_on_drained(std::move(on_drained)),
+        m_started(std::chrono::steady_clock::now()) {
+    const std::size_t worker_count = workers == 0 ? 1 : workers;
+    m_live_workers.store(worker_count);
+    m_workers.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+      m_workers.emplace_back([this]() { run(); });
+    }
+  }
+
+  Stage(Stage &&) noexcept = delete;
+  Stage &operator=(Stage &&) noexcept = delete;
+
+  Stage(const Stage &) = delete;
+  Stage &operator=(const Stage &) = delete;
+
+  ~Stage() noexcept { join(); }
+
+  void join() noexcept {
+    for (auto &worker : m_workers) {
+      if (worker.joinable()) {
+        worker.join();
+      }
+    }
+  }
+
+  [[nodiscard]] const StageStats &stats() const noexcept { return m_stats; }
+  [[nodiscard]] const std::string &name() const noexcept { return m_name; }
+
+  void log_report() const {
+    using namespace std::chrono;
+    const double wall_s =
+        duration<double>(nanoseconds{m_stats.wall_ns.load()}).count();
+    const double busy_s =
+        duration<double>(nanoseconds{m_stats.busy_ns.load()}).count();
+    const double workers = static_cast<double>(m_workers.size());
+    const double rows = static_cast<double>(m_stats.rows.load());
+
+    auto *logger = quarry::logging::get_logger();
+    LOG_INFO(logger,
+             "stage {}: {} items, {} rows, {} errors, {:.1f} rows/s, "
+             "{:.0f}% busy",
+             m_name, m_stats.items.load(), m_stats.rows.load(),
+             m_stats.errors.load(), wall_s > 0 ? rows / wall_s : 0.0,
+             wall_s > 0 ? 100.0 * busy_s / (wall_s * workers) : 0.0);
+  }
+
+private:
+  std::string m_name;
+  BoundedQueue<In> &m_input;
+  handler m_on_item;
+  std::function<void()> m_on_drained;
+  std::chrono::steady_clock::time_point m_started;
+  std::atomic<std::size_t> m_live_workers{0};
+  StageStats m_stats;
+  std::vector<std::thread> m_workers;
+
+  void run() {
+    using namespace std::chrono;
+    while (auto item = m_input.pop()) {
+      const auto start = steady_clock::now();
+      try {
+        m_stats.rows += m_on_item(std::move(*item));
+      } catch (const std::exception &ex) {
+        ++m_stats.errors;
+        auto *logger = quarry::logging::get_logger();
+        LOG_ERROR(logger, "stage {} failed item: {}", m_name, ex.what());
+      }
+      ++m_stats.items;
+      m_stats.busy_ns += static_cast<std::uint64_t>(
+          duration_cast<nanoseconds>(steady_clock::now() - start).count());
+    }
+
+    if (m_live_workers.fetch_sub(1) == 1) {
+      m_stats.wall_ns = duration_cast<nanoseconds>(steady_clock::now() -
+                                                   m_started)
+                            .count();
+      if (m_on_drained) {
+        m_on_drained();
+      }
+    }
+  }
+};
+
+} // namespace quarry
+
+#endif
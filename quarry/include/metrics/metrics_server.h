@@ -0,0 +1,46 @@
+#ifndef QUARRY_METRICS_METRICS_SERVER_H
+#define QUARRY_METRICS_METRICS_SERVER_H
+
+#include "http_types.h"
+#include "metrics/registry.h"
+#include <thread>
+
+namespace quarry::metrics {
+
+/**
+ * @brief Serves `GET /metrics` from a Registry on its own port and thread.
+ *
+ * Scrapes are rare and tiny, so one io thread serves every connection
+ * asynchronously, each read and write under a timeout; nothing here shares a
+ * thread or a port with the gRPC server.
+ *
+ * Rule of 5: non-copyable, non-movable (the io thread holds `this`).
+ */
+class MetricsServer {
+public:
+  MetricsServer(Registry &registry, port_type port);
+
+  MetricsServer(MetricsServer &&) noexcept = delete;
+  MetricsServer &operator=(MetricsServer &&) noexcept = delete;
+
+  MetricsServer(const MetricsServer &) = delete;
+  MetricsServer &operator=(const MetricsServer &) = delete;
+
+  ~MetricsServer() noexcept;
+
+  [[nodiscard]] port_type port() const noexcept { return m_port; }
+
+private:
+  Registry &m_registry;
+  net::io_context m_ioc;
+  tcp::acceptor m_acceptor;
+  port_type m_port;
+  std::jthread m_thread;
+
+  void accept();
+  void serve(tcp::socket socket);
+};
+
+} // namespace quarry::metrics
+
+#endif
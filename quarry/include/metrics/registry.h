@@ -0,0 +1,215 @@
+#ifndef QUARRY_METRICS_REGISTRY_H
+#define QUARRY_METRICS_REGISTRY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace quarry::metrics {
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * Rule of 5: non-copyable, non-movable (handed out by reference).
+ */
+class Counter {
+public:
+  Counter() = default;
+
+  Counter(Counter &&) noexcept = delete;
+  Counter &operator=(Counter &&) noexcept = delete;
+
+  Counter(const Counter &) = delete;
+  Counter &operator=(const Counter &) = delete;
+
+  ~Counter() noexcept = default;
+
+  void inc(std::uint64_t n = 1) noexcept {
+    m_value.fetch_add(n, std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::uint64_t value() const noexcept {
+    return m_value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint64_t> m_value{0};
+};
+
+/**
+ * Rule of 5: non-copyable, non-movable (handed out by reference).
+ */
+class Gauge {
+public:
+  Gauge() = default;
+
+  Gauge(Gauge &&) noexcept = delete;
+  Gauge &operator=(Gauge &&) noexcept = delete;
+
+  Gauge(const Gauge &) = delete;
+  Gauge &operator=(const Gauge &) = delete;
+
+  ~Gauge() noexcept = default;
+
+  void set(std::int64_t value) noexcept {
+    m_value.store(value, std::memory_order_relaxed);
+  }
+  void add(std::int64_t n = 1) noexcept {
+    m_value.fetch_add(n, std::memory_order_relaxed);
+  }
+  void sub(std::int64_t n = 1) noexcept {
+    m_value.fetch_sub(n, std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::int64_t value() const noexcept {
+    return m_value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::int64_t> m_value{0};
+};
+
+/**
+ * @brief Fixed-bucket histogram, cumulative only when rendered.
+ *
+ * `observe` is a binary search over a dozen bounds and three relaxed atomic
+ * adds, no locks. The sum is kept in integer nanos-of-a-unit (value * 1e9)
+ * so it can be a plain fetch_add.
+ *
+ * Rule of 5: non-copyable, non-movable (handed out by reference).
+ */
+class Histogram {
+public:
+  explicit Histogram(std::span<const double> bounds);
+
+  Histogram(Histogram &&) noexcept = delete;
+  Histogram &operator=(Histogram &&) noexcept = delete;
+
+  Histogram(const Histogram &) = delete;
+  Histogram &operator=(const Histogram &) = delete;
+
+  ~Histogram() noexcept = default;
+
+  void observe(double value) noexcept;
+
+  void observe(std::chrono::steady_clock::duration elapsed) noexcept {
+    observe(std::chrono::duration<double>(elapsed).count());
+  }
+
+  [[nodiscard]] std::span<const double> bounds() const noexcept {
+    return m_bounds;
+  }
+  /// per-bucket (not cumulative), the last one is +Inf
+  [[nodiscard]] std::uint64_t bucket(std::size_t i) const noexcept {
+    return m_buckets[i].load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::uint64_t count() const noexcept {
+    return m_count.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] double sum() const noexcept;
+
+private:
+  std::vector<double> m_bounds;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> m_buckets;
+  std::atomic<std::uint64_t> m_count{0};
+  std::atomic<std::int64_t> m_sum_nanos{0};
+};
+
+/// seconds, 500us to 10s
+// NOLINTNEXTLINE
+inline constexpr double LATENCY_BUCKETS[] = {
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+    0.1,    0.25,  0.5,    1.0,   2.5,  5.0,   10.0};
+
+/**
+ * @brief Owns every metric and renders them in the Prometheus text format.
+ *
+ * Lookups lock and are meant for setup or rare paths: take the reference
+ * once and keep it, updates through it never lock. The same name and labels
+ * always give back the same metric. Metrics live as long as the registry.
+ *
+ * Rule of 5: non-copyable, non-movable (hands out references into itself).
+ */
+class Registry {
+public:
+  static Registry &global();
+
+  Registry() = default;
+
+  Registry(Registry &&) noexcept = delete;
+  Registry &operator=(Registry &&) noexcept = delete;
+
+  Registry(const Registry &) = delete;
+  Registry &operator=(const Registry &) = delete;
+
+  ~Registry() noexcept = default;
+
+  Counter &counter(std::string_view name, std::string_view help,
+                   const Labels &labels = {});
+  Gauge &gauge(std::string_view name, std::string_view help,
+               const Labels &labels = {});
+  Histogram &histogram(std::string_view name, std::string_view help,
+                       const Labels &labels = {},
+                       std::span<const double> bounds = LATENCY_BUCKETS);
+
+  /// text exposition format 0.0.4
+  [[nodiscard]] std::string render() const;
+
+private:
+  enum class Kind : std::uint8_t { counter, gauge, histogram };
+
+  struct Family {
+    Kind kind;
+    std::string help;
+    // rendered label set -> index into the kind's storage
+    std::map<std::string, std::size_t> series{};
+  };
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, Family, std::less<>> m_families;
+  // deques keep references stable as metrics are added
+  std::deque<Counter> m_counters;
+  std::deque<Gauge> m_gauges;
+  std::deque<Histogram> m_histograms;
+
+  std::size_t &series_slot(std::string_view name, std::string_view help,
+                           Kind kind, const Labels &labels, bool &created);
+};
+
+/**
+ * Observes the elapsed time into `histogram` when it goes out of scope.
+ *
+ * Rule of 5: non-copyable, non-movable (scope bound).
+ */
+class ScopedTimer {
+public:
+  explicit ScopedTimer(Histogram &histogram) noexcept
+      : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+
+  ScopedTimer(ScopedTimer &&) noexcept = delete;
+  ScopedTimer &operator=(ScopedTimer &&) noexcept = delete;
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  ~ScopedTimer() noexcept {
+    m_histogram.observe(std::chrono::steady_clock::now() - m_start);
+  }
+
+private:
+  Histogram &m_histogram;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace quarry::metrics
+
+#endif
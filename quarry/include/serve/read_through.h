@@ -0,0 +1,135 @@
+#ifndef QUARRY_SERVE_READ_THROUGH_H
+#define QUARRY_SERVE_READ_THROUGH_H
+
+#include "aggregates.h"
+#include "bars/bar_columns.h"
+#include "bars/resample.h"
+#include "db/bar_reader.h"
+#include "ingest/bounded_queue.h"
+#include "ingest/stage.h"
+#include "massive.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace quarry {
+
+/// one piece of a request, read from fact_aggregate_bars or upstream
+struct ReadSegment {
+  DayRange days;
+  bool local;
+
+  bool operator==(const ReadSegment &) const = default;
+};
+
+/// segments in day order, so their bars concatenate in timestamp order
+using ReadPlan = std::vector<ReadSegment>;
+
+/**
+ * Splits `requested` against the stored coverage: local where an interval
+ * covers it, upstream in every gap before, between and after them.
+ *
+ * @param covered disjoint intervals in day order, as Sql::coverage returns
+ */
+[[nodiscard]] ReadPlan plan_read(DayRange requested,
+                                 std::span<const DayRange> covered);
+
+/// epoch ms bounds, both inclusive
+struct MsWindow {
+  std::int64_t from_ms;
+  std::int64_t to_ms;
+
+  bool operator==(const MsWindow &) const = default;
+};
+
+/**
+ * The bars `days` hold: from the first exchange midnight to just before the
+ * one after the last day. Massive's from/to dates and agg_coverage both
+ * count exchange days, whose post-market runs past UTC midnight, so local
+ * reads use the same window upstream segments do.
+ */
+[[nodiscard]] MsWindow exchange_window(DayRange days,
+                                       const Session &session = {});
+
+struct BarFetch {
+  BarColumns bars;
+  std::string ticker;
+  std::string request_id;
+  std::size_t local_rows = 0;
+};
+
+/**
+ * @brief Serves aggregate bars from Postgres where stored, Massive otherwise.
+ *
+ * Only multiplier 1, adjusted bars are stored, and what counts as stored is
+ * the agg_coverage intervals, not whatever bars happen to exist. A request
+ * reads its own timespan's stored bars first; coarser bars for the days left
+ * are resampled from stored minute bars where those are covered, and only
+ * what remains goes upstream. Bars fetched upstream are queued for a
+ * write-back worker, which upserts them and records their days as covered in
+ * one transaction; resampled bars are never written back, so what is stored
+ * is always the provider's own. When the queue is full the write-back is
+ * dropped, never the response. A Postgres failure degrades to a full
+ * upstream fetch.
+ *
+ * Rule of 5: non-copyable, non-movable (worker holds the queue).
+ */
+class ReadThrough {
+public:
+  /// @param write_back_depth queued write-backs, 0 disables write-back
+  ReadThrough(Massive &massive, std::size_t write_back_depth);
+
+  ReadThrough(ReadThrough &&) noexcept = delete;
+  ReadThrough &operator=(ReadThrough &&) noexcept = delete;
+
+  ReadThrough(const ReadThrough &) = delete;
+  ReadThrough &operator=(const ReadThrough &) = delete;
+
+  ~ReadThrough() noexcept;
+
+  [[nodiscard]] BarFetch fetch(const ep::Aggregates &aggregate_ep);
+
+private:
+  struct WriteBack {
+    std::vector<ep::AggBar> bars{};
+    // fetched upstream, covered once written even if they held no bars
+    std::vector<DayRange> days{};
+    std::string ticker;
+    std::string request_id{};
+    timespan_options timespan;
+  };
+
+  Massive &m_massive;
+  bool m_write_back_enabled;
+  BoundedQueue<WriteBack> m_write_backs;
+  Stage<WriteBack> m_writer;
+
+  /// appends the stored bars of the request's own timespan for `days`
+  /// @return false to fall back, `out` is untouched then
+  bool fetch_local(const ep::Aggregates &aggregate_ep, DayRange days,
+                   BarFetch &out);
+
+  /**
+   * Appends coarser bars (HOUR and up, or MINUTE with a multiplier) for
+   * `days` built from stored minute bars. The caller checks those days
+   * against agg_coverage rather than the bars themselves, so a hole in them
+   * goes upstream instead of becoming a missing coarse bar.
+   *
+   * @return false to fall back, `out` is untouched then
+   */
+  bool fetch_resampled(const ep::Aggregates &aggregate_ep, DayRange days,
+                       BarFetch &out);
+
+  /// appends upstream bars for `days` to `out`, and to `written` if non-null
+  void fetch_remote(const ep::Aggregates &aggregate_ep, DayRange days,
+                    BarFetch &out, std::vector<ep::AggBar> *written);
+
+  static std::size_t write(WriteBack &&batch);
+};
+
+} // namespace quarry
+
+#endif
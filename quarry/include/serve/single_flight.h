@@ -0,0 +1,204 @@
+#ifndef QUARRY_SERVE_SINGLE_FLIGHT_H
+#define QUARRY_SERVE_SINGLE_FLIGHT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace quarry {
+
+struct SingleFlightStats {
+  /// served from a finished, unexpired result
+  std::atomic<std::uint64_t> hits{0};
+  /// waited on a fetch another caller had already started
+  std::atomic<std::uint64_t> joined{0};
+  /// ran the fetch themselves
+  std::atomic<std::uint64_t> misses{0};
+};
+
+/**
+ * @brief Collapses concurrent identical fetches into one and keeps the result
+ * for a short TTL.
+ *
+ * The first caller for a key runs `fetch`; everyone arriving while it runs
+ * queues a continuation on the entry and returns straight away, holding no
+ * thread. The leader hands the same immutable value (or the same exception)
+ * to its own continuation and then to every queued one, on its own thread.
+ * Successful results stay for `ttl` so back-to-back duplicates are free;
+ * failures are never cached. A zero TTL gives plain coalescing.
+ *
+ * At most `max_entries` finished results are kept, expired ones are swept on
+ * insert and a result that does not fit is simply not cached.
+ *
+ * Rule of 5: non-copyable, non-movable (mutex, leaders finish entries in it).
+ */
+template <class Key, class Value, class Hash = std::hash<Key>>
+class SingleFlight {
+public:
+  using value_ptr = std::shared_ptr<const Value>;
+  using clock = std::chrono::steady_clock;
+  /// exactly one of the two is set
+  using Done = std::function<void(value_ptr, std::exception_ptr)>;
+
+  SingleFlight(clock::duration ttl, std::size_t max_entries)
+      : m_ttl(ttl), m_max_entries(max_entries) {}
+
+  SingleFlight(SingleFlight &&) noexcept = delete;
+  SingleFlight &operator=(SingleFlight &&) noexcept = delete;
+
+  SingleFlight(const SingleFlight &) = delete;
+  SingleFlight &operator=(const SingleFlight &) = delete;
+
+  ~SingleFlight() noexcept = default;
+
+  /**
+   * Calls `done` exactly once: inline on a hit or for the leader, from the
+   * leader's thread for a joined caller. `done` must not throw, the callers
+   * queued behind it would never hear back.
+   *
+   * @param fetch callable returning a `Value` (or anything convertible), only
+   * invoked (synchronously) if this caller leads
+   */
+  template <class Fetch>
+  void get(const Key &key, Fetch &&fetch, Done done) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (auto it = m_entries.find(key); it != m_entries.end()) {
+        auto &entry = it->second;
+        if (!entry.ready) {
+          entry.waiters.push_back(std::move(done));
+          ++m_stats.joined;
+          return;
+        }
+        if (clock::now() < entry.expires) {
+          auto value = entry.value;
+          lock.unlock();
+          ++m_stats.hits;
+          done(std::move(value), nullptr);
+          return;
+        }
+        m_entries.erase(it);
+      }
+      m_entries.emplace(key, Entry{});
+    }
+    ++m_stats.misses;
+
+    value_ptr value;
+    std::exception_ptr error;
+    try {
+      value = std::make_shared<const Value>(std::forward<Fetch>(fetch)());
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    std::vector<Done> waiters;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto it = m_entries.find(key);
+      waiters = std::move(it->second.waiters);
+      if (error) {
+        m_entries.erase(it);
+      } else {
+        settle(it, value);
+      }
+    }
+
+    done(value, error);
+    for (auto &waiter : waiters) {
+      waiter(value, error);
+    }
+  }
+
+  /**
+   * Blocking form for callers that own their thread; a joined caller parks
+   * until the leader finishes.
+   *
+   * @throws whatever `fetch` threw, to the leader and every joined caller
+   */
+  template <class Fetch> value_ptr get(const Key &key, Fetch &&fetch) {
+    // shared: the leader may still be inside set_value when we wake
+    auto promise = std::make_shared<std::promise<value_ptr>>();
+    auto result = promise->get_future();
+    get(key, std::forward<Fetch>(fetch),
+        [promise](value_ptr value, std::exception_ptr error) {
+          if (error) {
+            promise->set_exception(error);
+          } else {
+            promise->set_value(std::move(value));
+          }
+        });
+    return result.get();
+  }
+
+  /// drops every finished result, in-flight fetches are left alone
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::erase_if(m_entries, [](const auto &kv) { return kv.second.ready; });
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+  }
+
+  [[nodiscard]] const SingleFlightStats &stats() const noexcept {
+    return m_stats;
+  }
+
+private:
+  struct Entry {
+    value_ptr value;
+    /// joined callers, only while the fetch runs
+    std::vector<Done> waiters;
+    clock::time_point expires{};
+    bool ready = false;
+  };
+  using iterator = typename std::unordered_map<Key, Entry, Hash>::iterator;
+
+  clock::duration m_ttl;
+  std::size_t m_max_entries;
+  mutable std::mutex m_mutex;
+  std::unordered_map<Key, Entry, Hash> m_entries;
+  SingleFlightStats m_stats;
+
+  /// leader finished: keep the entry as a cached result or drop it
+  void settle(iterator it, const value_ptr &value) {
+    const auto now = clock::now();
+    if (m_ttl <= clock::duration::zero()) {
+      m_entries.erase(it);
+      return;
+    }
+
+    // never the leader's own entry, it is not ready yet
+    std::erase_if(m_entries, [now](const auto &kv) {
+      return kv.second.ready && kv.second.expires <= now;
+    });
+
+    std::size_t cached = 0;
+    for (const auto &[_, entry] : m_entries) {
+      cached += entry.ready ? 1 : 0;
+    }
+    if (cached >= m_max_entries) {
+      m_entries.erase(it);
+      return;
+    }
+
+    auto &entry = it->second;
+    entry.value = value;
+    entry.ready = true;
+    entry.expires = now + m_ttl;
+  }
+};
+
+} // namespace quarry
+
+#endif
@@ -1,8 +1,17 @@
 #include "dns_cache.h"
+#include "metrics/registry.h"
 #include <shared_mutex>
 
 namespace quarry {
 
+namespace {
+metrics::Counter &lookups(std::string_view result) {
+  return metrics::Registry::global().counter(
+      "quarry_dns_cache_lookups_total", "DnsCache lookups by result",
+      {{"result", std::string{result}}});
+}
+} // namespace
+
 DnsCache &DnsCache::global_cache() {
   static DnsCache singleton{};
   return singleton;
@@ -26,6 +35,9 @@ DnsCache::DnsCache(DnsCache &&other) noexcept {
 const tcp_resolver_results &
 DnsCache::get(const DnsCacheContext &context) const {
 
+  static metrics::Counter &hits = lookups("hit");
+  static metrics::Counter &misses = lookups("miss");
+
   auto const key = ResolverKey{
       .host = context.host, .port = context.port, .is_tls = context.is_tls};
   // scoped read access
@@ -33,6 +45,7 @@ DnsCache::get(const DnsCacheContext &context) const {
     std::shared_lock<std::shared_mutex> rlock(m_cache_lock);
     if (auto it = m_cached_resolutions.find(key);
         it != m_cached_resolutions.end()) {
+      hits.inc();
       return it->second;
     }
   }
@@ -42,8 +55,10 @@ DnsCache::get(const DnsCacheContext &context) const {
     std::unique_lock<std::shared_mutex> wlock(m_cache_lock);
     if (auto it = m_cached_resolutions.find(key);
         it != m_cached_resolutions.end()) {
+      hits.inc();
       return it->second;
     }
+    misses.inc();
 
     net::io_context &ioc = context.ioc;
     tcp::resolver resolver(ioc);
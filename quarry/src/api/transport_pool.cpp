@@ -1,8 +1,43 @@
 #include "api/transport_pool.h"
+#include "metrics/registry.h"
 #include "retry_policy.h"
+#include <chrono>
 #include <cstdint>
+#include <string>
+#include <utility>
 
 namespace quarry {
+
+namespace {
+/// shared by every pool in the process
+struct PoolMetrics {
+  metrics::Gauge &capacity;
+  metrics::Gauge &in_use;
+  metrics::Histogram &wait;
+};
+
+PoolMetrics &pool_metrics() {
+  auto &registry = metrics::Registry::global();
+  static PoolMetrics pool{
+      .capacity = registry.gauge("quarry_transport_pool_capacity",
+                                 "Upstream HTTP connections across pools"),
+      .in_use = registry.gauge("quarry_transport_pool_in_use",
+                               "Upstream HTTP connections leased out"),
+      .wait = registry.histogram("quarry_transport_pool_wait_seconds",
+                                 "Time spent waiting for a free connection")};
+  return pool;
+}
+
+/// retries are rare, the labelled lookup is fine here
+void count_retry(unsigned int code) {
+  metrics::Registry::global()
+      .counter("quarry_http_retries_total", "Upstream HTTP retries by reason",
+               {{"reason", code == DEAD_STREAM_ERROR_CODE
+                               ? std::string{"dead_stream"}
+                               : std::to_string(code)}})
+      .inc();
+}
+} // namespace
 TransportPool::TransportPool(std::uint16_t max_connections,
                              const std::string &host, net::io_context &ioc,
                              ssl::context &ssl_ctx,
@@ -19,10 +54,12 @@ TransportPool::TransportPool(std::uint16_t max_connections,
     m_transports.push_back(std::move(t));
     m_free_list.push_back(i);
   }
+  pool_metrics().capacity.add(static_cast<std::int64_t>(m_max_connections));
 }
 
+// the moved-from pool counts for nothing on the capacity gauge
 TransportPool::TransportPool(TransportPool &&other) noexcept
-    : m_max_connections(other.m_max_connections),
+    : m_max_connections(std::exchange(other.m_max_connections, 0)),
       m_transports(std::move(other.m_transports)),
       m_free_list(std::move(other.m_free_list)),
       m_endpoints(std::move(other.m_endpoints)),
@@ -30,6 +67,10 @@ TransportPool::TransportPool(TransportPool &&other) noexcept
       m_ssl_ctx(other.m_ssl_ctx), m_is_tls(other.m_is_tls),
       m_retry_policy(other.m_retry_policy) {};
 
+TransportPool::~TransportPool() noexcept {
+  pool_metrics().capacity.sub(static_cast<std::int64_t>(m_max_connections));
+}
+
 void TransportPool::send_and_read(
     const http::request<http::string_body> &request,
     http::response<http::string_body> &response) {
@@ -37,6 +78,7 @@ void TransportPool::send_and_read(
   auto idx = acquire_index();
 
   auto release_on_exit = [&]() {
+    pool_metrics().in_use.sub();
     std::lock_guard<std::mutex> lock(m_free_mutex);
     m_free_list.push_back(idx);
     m_free_cv.notify_one();
@@ -48,6 +90,7 @@ void TransportPool::send_and_read(
     quarry::Transport &transport = *m_transports[idx];
     if (auto code = transport.write_and_read(request, response);
         code != 200 && m_retry_policy.should_retry(code)) {
+      count_retry(code);
       m_retry_policy.wait(attempt);
       restore_stream(idx);
       continue;
@@ -73,10 +116,17 @@ void TransportPool::restore_stream(TransportPool::Index idx) {
 }
 
 TransportPool::Index TransportPool::acquire_index() {
+  auto &pool = pool_metrics();
+  const auto start = std::chrono::steady_clock::now();
+
   std::unique_lock<std::mutex> lock(m_free_mutex);
   m_free_cv.wait(lock, [&]() { return !m_free_list.empty(); });
   auto idx = m_free_list.back();
   m_free_list.pop_back();
+  lock.unlock();
+
+  pool.wait.observe(std::chrono::steady_clock::now() - start);
+  pool.in_use.add();
   return idx;
 }
 
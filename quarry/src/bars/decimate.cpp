@@ -0,0 +1,140 @@
+#include "bars/decimate.h"
+#include <cmath>
+#include <vector>
+
+namespace quarry {
+
+namespace {
+/// run k of `runs` near-equal runs over `rows` rows is [begin(k), begin(k+1))
+std::size_t run_begin(std::size_t k, std::size_t rows, std::size_t runs) {
+  return k * rows / runs;
+}
+
+/// folds each run of `column` with `reduce`, one output per run
+template <typename T, typename Reduce>
+void reduce_runs(const std::vector<T> &column, std::size_t runs,
+                 std::vector<T> &out, Reduce reduce) {
+  const std::size_t rows = column.size();
+  out.reserve(runs);
+  for (std::size_t k = 0; k < runs; ++k) {
+    const std::size_t end = run_begin(k + 1, rows, runs);
+    std::size_t i = run_begin(k, rows, runs);
+    T acc = column[i];
+    for (++i; i < end; ++i) {
+      acc = reduce(acc, column[i]);
+    }
+    out.push_back(acc);
+  }
+}
+
+void ohlc_buckets(const BarColumns &bars, std::size_t runs, BarColumns &out) {
+  const std::size_t rows = bars.size();
+  const auto max = [](auto acc, auto x) { return acc < x ? x : acc; };
+  const auto min = [](auto acc, auto x) { return x < acc ? x : acc; };
+  const auto sum = [](auto acc, auto x) { return acc + x; };
+
+  reduce_runs(bars.h, runs, out.h, max);
+  reduce_runs(bars.l, runs, out.l, min);
+  reduce_runs(bars.v, runs, out.v, sum);
+  reduce_runs(bars.n, runs, out.n, sum);
+  reduce_runs(bars.otc, runs, out.otc,
+              [](std::uint8_t acc, std::uint8_t x) {
+                return static_cast<std::uint8_t>(acc | x);
+              });
+
+  out.o.reserve(runs);
+  out.c.reserve(runs);
+  out.t.reserve(runs);
+  out.vw.reserve(runs);
+  for (std::size_t k = 0; k < runs; ++k) {
+    const std::size_t begin = run_begin(k, rows, runs);
+    const std::size_t end = run_begin(k + 1, rows, runs);
+    out.o.push_back(bars.o[begin]);
+    out.c.push_back(bars.c[end - 1]);
+    out.t.push_back(bars.t[begin]);
+
+    double traded = 0.0;
+    for (std::size_t i = begin; i < end; ++i) {
+      traded += bars.vw[i] * bars.v[i];
+    }
+    // no volume in the run, the last bar's vw is the best guess
+    out.vw.push_back(out.v[k] > 0.0 ? traded / out.v[k] : bars.vw[end - 1]);
+  }
+}
+
+void lttb(const BarColumns &bars, std::size_t points, BarColumns &out) {
+  const std::size_t rows = bars.size();
+  out.reserve(points);
+  out.push_back(bars.bar(0));
+  if (points == 1) {
+    return;
+  }
+
+  // interior rows [1, rows - 1) split into points - 2 runs; t is taken
+  // relative to the first bar so the doubles keep their precision
+  const std::size_t inner = rows - 2;
+  const std::size_t runs = points - 2;
+  const auto x = [&](std::size_t i) {
+    return static_cast<double>(bars.t[i] - bars.t[0]);
+  };
+
+  std::size_t picked = 0;
+  for (std::size_t k = 0; k < runs; ++k) {
+    const std::size_t begin = 1 + run_begin(k, inner, runs);
+    const std::size_t end = 1 + run_begin(k + 1, inner, runs);
+
+    // the far corner is the next run's mean, or the last bar after the
+    // final run
+    const std::size_t next_begin = end;
+    const std::size_t next_end =
+        k + 1 < runs ? 1 + run_begin(k + 2, inner, runs) : rows;
+    double next_x = 0.0;
+    double next_y = 0.0;
+    for (std::size_t i = next_begin; i < next_end; ++i) {
+      next_x += x(i);
+      next_y += bars.c[i];
+    }
+    const auto next_rows = static_cast<double>(next_end - next_begin);
+    next_x /= next_rows;
+    next_y /= next_rows;
+
+    const double prev_x = x(picked);
+    const double prev_y = bars.c[picked];
+    double best_area = -1.0;
+    std::size_t best = begin;
+    for (std::size_t i = begin; i < end; ++i) {
+      const double area =
+          std::abs((prev_x - next_x) * (bars.c[i] - prev_y) -
+                   (prev_x - x(i)) * (next_y - prev_y));
+      if (area > best_area) {
+        best_area = area;
+        best = i;
+      }
+    }
+    out.push_back(bars.bar(best));
+    picked = best;
+  }
+
+  out.push_back(bars.bar(rows - 1));
+}
+} // namespace
+
+void decimate(const BarColumns &bars, std::size_t max_points, Decimation mode,
+              BarColumns &out) {
+  out.clear();
+  if (max_points == 0 || bars.size() <= max_points) {
+    out.append(bars);
+    return;
+  }
+
+  switch (mode) {
+  case Decimation::ohlc_buckets:
+    ohlc_buckets(bars, max_points, out);
+    break;
+  case Decimation::lttb:
+    lttb(bars, max_points, out);
+    break;
+  }
+}
+
+} // namespace quarry
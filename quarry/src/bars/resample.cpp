@@ -0,0 +1,288 @@
+#include "bars/resample.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace quarry {
+
+namespace {
+using namespace std::chrono;
+
+// NOLINTNEXTLINE
+constexpr std::int64_t MINUTE_MS = 60'000;
+// NOLINTNEXTLINE
+constexpr std::int64_t HOUR_MS = 60 * MINUTE_MS;
+// NOLINTNEXTLINE
+constexpr std::int64_t DAY_MS = 24 * HOUR_MS;
+// NOLINTNEXTLINE
+constexpr std::int64_t OUT_OF_SESSION =
+    std::numeric_limits<std::int64_t>::min();
+// NOLINTNEXTLINE
+constexpr std::int64_t NEVER = std::numeric_limits<std::int64_t>::max();
+
+std::int64_t floor_div(std::int64_t a, std::int64_t b) {
+  const std::int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+std::int64_t to_ms(minutes m) { return m.count() * MINUTE_MS; }
+
+std::int64_t day_ms(sys_days day) {
+  return static_cast<std::int64_t>(day.time_since_epoch().count()) * DAY_MS;
+}
+
+// both switches happen at 02:00 local, standard time in March and daylight
+// time in November
+std::int64_t dst_begins(year y, minutes standard_offset) {
+  return day_ms(sys_days{y / March / Sunday[2]}) + 2 * HOUR_MS -
+         to_ms(standard_offset);
+}
+
+std::int64_t dst_ends(year y, minutes standard_offset) {
+  return day_ms(sys_days{y / November / Sunday[1]}) + 2 * HOUR_MS -
+         to_ms(standard_offset) - HOUR_MS;
+}
+
+year local_year(std::int64_t utc_ms, minutes standard_offset) {
+  const sys_days local_day{
+      days{floor_div(utc_ms + to_ms(standard_offset), DAY_MS)}};
+  return year_month_day{local_day}.year();
+}
+
+/// local ms of the first of month `index`, counted from year 0 January
+std::int64_t month_start_ms(std::int64_t index) {
+  const std::int64_t y = floor_div(index, 12);
+  return day_ms(sys_days{year{static_cast<int>(y)} /
+                         month{static_cast<unsigned>(index - y * 12 + 1)} /
+                         1});
+}
+
+std::int64_t months_per_unit(timespan_options timespan) {
+  switch (timespan) {
+  case timespan_options::QUARTER:
+    return 3;
+  case timespan_options::YEAR:
+    return 12;
+  default:
+    return 1;
+  }
+}
+} // namespace
+
+minutes Session::offset_at(std::int64_t utc_ms) const {
+  if (!us_daylight_saving) {
+    return standard_offset;
+  }
+  const year y = local_year(utc_ms, standard_offset);
+  return dst_begins(y, standard_offset) <= utc_ms &&
+                 utc_ms < dst_ends(y, standard_offset)
+             ? standard_offset + hours{1}
+             : standard_offset;
+}
+
+std::int64_t Session::offset_until(std::int64_t utc_ms) const {
+  if (!us_daylight_saving) {
+    return NEVER;
+  }
+  const year y = local_year(utc_ms, standard_offset);
+  if (const std::int64_t begins = dst_begins(y, standard_offset);
+      utc_ms < begins) {
+    return begins;
+  }
+  if (const std::int64_t ends = dst_ends(y, standard_offset); utc_ms < ends) {
+    return ends;
+  }
+  return dst_begins(y + years{1}, standard_offset);
+}
+
+Resampler::Resampler(timespan_options timespan, std::uint32_t multiplier,
+                     Session session)
+    : m_timespan(timespan), m_multiplier(multiplier == 0 ? 1 : multiplier),
+      m_session(session) {
+  if (timespan == timespan_options::SECOND) {
+    throw std::invalid_argument("can't resample into SECOND bars");
+  }
+}
+
+Resampler::LocalBucket Resampler::local_bucket(std::int64_t local) const {
+  const std::int64_t day = floor_div(local, DAY_MS);
+
+  switch (m_timespan) {
+  case timespan_options::SECOND:
+  case timespan_options::MINUTE:
+  case timespan_options::HOUR: {
+    const std::int64_t width =
+        (m_timespan == timespan_options::HOUR ? HOUR_MS : MINUTE_MS) *
+        m_multiplier;
+    const std::int64_t anchor =
+        day * DAY_MS +
+        (m_session.regular_hours_only ? to_ms(m_session.open) : 0);
+    const std::int64_t start =
+        anchor + floor_div(local - anchor, width) * width;
+    // buckets restart every day, the last one is cut short at midnight
+    return {start, std::min(start + width, (day + 1) * DAY_MS)};
+  }
+  case timespan_options::DAY: {
+    const std::int64_t first = floor_div(day, m_multiplier) * m_multiplier;
+    return {first * DAY_MS, (first + m_multiplier) * DAY_MS};
+  }
+  case timespan_options::WEEK: {
+    // 1970-01-04 was the first Sunday after the epoch
+    const std::int64_t week = floor_div(day + 4, 7);
+    const std::int64_t first = floor_div(week, m_multiplier) * m_multiplier;
+    return {(first * 7 - 4) * DAY_MS,
+            ((first + m_multiplier) * 7 - 4) * DAY_MS};
+  }
+  case timespan_options::MONTH:
+  case timespan_options::QUARTER:
+  case timespan_options::YEAR: {
+    const std::int64_t width = months_per_unit(m_timespan) * m_multiplier;
+    const year_month_day ymd{sys_days{days{day}}};
+    const std::int64_t month_index =
+        static_cast<std::int64_t>(static_cast<int>(ymd.year())) * 12 +
+        static_cast<unsigned>(ymd.month()) - 1;
+    const std::int64_t first = floor_div(month_index, width) * width;
+    return {month_start_ms(first), month_start_ms(first + width)};
+  }
+  }
+  return {local, local + 1};
+}
+
+std::int64_t Resampler::bucket_of(std::int64_t t_ms) const {
+  const std::int64_t offset = to_ms(m_session.offset_at(t_ms));
+  const std::int64_t local_start = local_bucket(t_ms + offset).start;
+
+  // back to UTC with the offset in effect at the boundary, which differs
+  // from the bar's own for buckets spanning a DST switch
+  return local_start - to_ms(m_session.offset_at(local_start - offset));
+}
+
+void Resampler::key_run(std::int64_t t_ms) {
+  const std::int64_t offset = to_ms(m_session.offset_at(t_ms));
+  const std::int64_t local = t_ms + offset;
+  const std::int64_t day_start = floor_div(local, DAY_MS) * DAY_MS;
+
+  std::int64_t local_end = 0;
+  if (!m_session.regular_hours_only) {
+    m_run_key = bucket_of(t_ms);
+    local_end = local_bucket(local).end;
+  } else if (const std::int64_t of_day = local - day_start;
+             of_day < to_ms(m_session.open)) {
+    m_run_key = OUT_OF_SESSION;
+    local_end = day_start + to_ms(m_session.open);
+  } else if (of_day >= to_ms(m_session.close)) {
+    m_run_key = OUT_OF_SESSION;
+    local_end = day_start + DAY_MS + to_ms(m_session.open);
+  } else {
+    m_run_key = bucket_of(t_ms);
+    local_end = std::min(local_bucket(local).end,
+                         day_start + to_ms(m_session.close));
+  }
+
+  // the offset holds until the next switch, so local and UTC ends line up
+  // until then
+  m_run_begin = t_ms;
+  m_run_end = std::min(local_end - offset, m_session.offset_until(t_ms));
+}
+
+void Resampler::push(const BarColumns &fine, BarColumns &out) {
+  const std::size_t rows = fine.size();
+  m_keys.resize(rows);
+  for (std::size_t i = 0; i < rows; ++i) {
+    const std::int64_t t = fine.t[i];
+    if (t < m_run_begin || t >= m_run_end) {
+      key_run(t);
+    }
+    m_keys[i] = m_run_key;
+  }
+
+  std::size_t begin = 0;
+  while (begin < rows) {
+    const std::int64_t key = m_keys[begin];
+    std::size_t end = begin + 1;
+    while (end < rows && m_keys[end] == key) {
+      ++end;
+    }
+
+    if (key != OUT_OF_SESSION) {
+      if (m_open && m_partial.t != key) {
+        emit(out);
+        m_open = false;
+      }
+      if (!m_open) {
+        m_partial = Partial{.t = key,
+                            .o = fine.o[begin],
+                            .h = fine.h[begin],
+                            .l = fine.l[begin]};
+        m_open = true;
+      }
+      fold(fine, begin, end);
+    }
+    begin = end;
+  }
+}
+
+void Resampler::flush(BarColumns &out) {
+  if (m_open) {
+    emit(out);
+    m_open = false;
+  }
+}
+
+void Resampler::fold(const BarColumns &fine, std::size_t begin,
+                     std::size_t end) {
+  double h = m_partial.h;
+  double l = m_partial.l;
+  double v = 0.0;
+  double traded = 0.0;
+  std::int64_t n = 0;
+  std::uint8_t otc = 0;
+  for (std::size_t i = begin; i < end; ++i) {
+    h = h < fine.h[i] ? fine.h[i] : h;
+  }
+  for (std::size_t i = begin; i < end; ++i) {
+    l = fine.l[i] < l ? fine.l[i] : l;
+  }
+  for (std::size_t i = begin; i < end; ++i) {
+    v += fine.v[i];
+    traded += fine.vw[i] * fine.v[i];
+  }
+  for (std::size_t i = begin; i < end; ++i) {
+    n += fine.n[i];
+    otc |= fine.otc[i];
+  }
+
+  m_partial.h = h;
+  m_partial.l = l;
+  m_partial.c = fine.c[end - 1];
+  m_partial.v += v;
+  m_partial.traded += traded;
+  m_partial.n += n;
+  m_partial.otc = m_partial.otc || otc != 0;
+  m_partial.last_vw = fine.vw[end - 1];
+}
+
+void Resampler::emit(BarColumns &out) const {
+  const Partial &p = m_partial;
+  out.push_back(ep::AggBar{.o = p.o,
+                           .c = p.c,
+                           .h = p.h,
+                           .l = p.l,
+                           .n = p.n,
+                           .otc = p.otc,
+                           .t = p.t,
+                           .v = p.v,
+                           // no volume, the last bar's vw is the best guess
+                           .vw = p.v > 0.0 ? p.traded / p.v : p.last_vw});
+}
+
+BarColumns resample(const BarColumns &fine, timespan_options timespan,
+                    std::uint32_t multiplier, const Session &session) {
+  Resampler resampler(timespan, multiplier, session);
+  BarColumns out;
+  resampler.push(fine, out);
+  resampler.flush(out);
+  return out;
+}
+
+} // namespace quarry
@@ -7,6 +7,7 @@ int main() {
 
   int latest_version = migrator.get_last_applied_version();
   migrator.apply_migrations(latest_version);
+  migrator.maintain_partitions();
 
   return 0;
 }
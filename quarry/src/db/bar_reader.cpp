@@ -0,0 +1,63 @@
+#include "db/bar_reader.h"
+#include <algorithm>
+#include <format>
+
+namespace quarry {
+
+BarReader::BarReader(pqxx::connection &conn, std::size_t chunk_rows)
+    : m_conn(conn), m_chunk_rows(std::max<std::size_t>(chunk_rows, 1)) {}
+
+std::size_t BarReader::read(const BarQuery &query,
+                            const chunk_callback &on_chunk) {
+  pqxx::read_transaction txn(m_conn);
+
+  const std::string sql = std::format(
+      "SELECT bar_timestamp, open, close, high, low, transactions, is_otc, "
+      "volume, volume_weighted "
+      "FROM fact_aggregate_bars "
+      "WHERE ticker_id = {} AND timespan = {} "
+      "AND bar_timestamp BETWEEN {} AND {} "
+      "ORDER BY bar_timestamp",
+      txn.quote(query.ticker), txn.quote(timespan_resolver(query.timespan)),
+      query.from_ms, query.to_ms);
+
+  BarColumns chunk;
+  chunk.reserve(m_chunk_rows);
+  std::size_t total = 0;
+
+  for (auto [t, o, c, h, l, n, otc, v, vw] :
+       txn.stream<std::int64_t, double, double, double, double, std::int64_t,
+                  bool, double, double>(sql)) {
+    chunk.o.push_back(o);
+    chunk.c.push_back(c);
+    chunk.h.push_back(h);
+    chunk.l.push_back(l);
+    chunk.n.push_back(n);
+    chunk.otc.push_back(static_cast<std::uint8_t>(otc));
+    chunk.t.push_back(t);
+    chunk.v.push_back(v);
+    chunk.vw.push_back(vw);
+
+    if (chunk.size() == m_chunk_rows) {
+      total += chunk.size();
+      on_chunk(chunk);
+      chunk.clear();
+    }
+  }
+
+  if (!chunk.empty()) {
+    total += chunk.size();
+    on_chunk(chunk);
+  }
+
+  txn.commit();
+  return total;
+}
+
+BarColumns BarReader::read_all(const BarQuery &query) {
+  BarColumns all;
+  read(query, [&all](const BarColumns &chunk) { all.append(chunk); });
+  return all;
+}
+
+} // namespace quarry
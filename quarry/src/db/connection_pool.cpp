@@ -0,0 +1,128 @@
+#include "db/connection_pool.h"
+#include "metrics/registry.h"
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+namespace quarry {
+
+namespace {
+struct PgPoolMetrics {
+  metrics::Gauge &capacity;
+  metrics::Gauge &in_use;
+  metrics::Histogram &wait;
+};
+
+PgPoolMetrics &pg_pool_metrics() {
+  auto &registry = metrics::Registry::global();
+  static PgPoolMetrics pool{
+      .capacity = registry.gauge("quarry_pg_pool_capacity",
+                                 "Postgres connections across pools"),
+      .in_use = registry.gauge("quarry_pg_pool_in_use",
+                               "Postgres connections leased out"),
+      .wait = registry.histogram("quarry_pg_pool_wait_seconds",
+                                 "Time spent waiting for a Postgres lease")};
+  return pool;
+}
+} // namespace
+
+ConnectionPool::Lease::Lease(ConnectionPool &pool, Index idx) noexcept
+    : m_pool(&pool), m_idx(idx) {}
+
+ConnectionPool::Lease::Lease(Lease &&other) noexcept
+    : m_pool(std::exchange(other.m_pool, nullptr)), m_idx(other.m_idx) {}
+
+ConnectionPool::Lease::~Lease() noexcept {
+  if (m_pool != nullptr) {
+    m_pool->release(m_idx);
+  }
+}
+
+pqxx::connection &ConnectionPool::Lease::conn() {
+  return *m_pool->open_slot(m_idx).conn;
+}
+
+void ConnectionPool::Lease::prepare(pqxx::zview name, pqxx::zview sql) {
+  auto &slot = m_pool->open_slot(m_idx);
+  if (slot.prepared.contains(std::string{name})) {
+    return;
+  }
+  slot.conn->prepare(name, sql);
+  slot.prepared.emplace(name);
+}
+
+PGconn *ConnectionPool::Lease::take_raw() {
+  return std::move(*m_pool->open_slot(m_idx).conn).release_raw_connection();
+}
+
+/**
+ * Writes the slot directly: conn() would find the released connection closed
+ * and open a new one in its place.
+ */
+void ConnectionPool::Lease::restore_raw(PGconn *raw) noexcept {
+  auto &slot = m_pool->m_slots[m_idx];
+  if (raw != nullptr) {
+    try {
+      slot.conn = std::make_unique<pqxx::connection>(
+          pqxx::connection::seize_raw_connection(raw));
+      return;
+    } catch (const std::exception &) {
+      PQfinish(raw);
+    }
+  }
+  slot.conn.reset();
+  slot.prepared.clear();
+}
+
+ConnectionPool::ConnectionPool(std::size_t max_connections,
+                               std::string_view conninfo)
+    : m_conninfo(conninfo),
+      m_slots(max_connections == 0 ? 1 : max_connections) {
+  m_free_list.reserve(m_slots.size());
+  for (Index i = 0; i < m_slots.size(); ++i) {
+    m_free_list.push_back(i);
+  }
+  pg_pool_metrics().capacity.add(static_cast<std::int64_t>(m_slots.size()));
+}
+
+ConnectionPool::~ConnectionPool() noexcept {
+  pg_pool_metrics().capacity.sub(static_cast<std::int64_t>(m_slots.size()));
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+  auto &pool_stats = pg_pool_metrics();
+  const auto start = std::chrono::steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(m_free_mutex);
+  m_free_cv.wait(lock, [&]() { return !m_free_list.empty(); });
+  auto idx = m_free_list.back();
+  m_free_list.pop_back();
+  lock.unlock();
+
+  pool_stats.wait.observe(std::chrono::steady_clock::now() - start);
+  pool_stats.in_use.add();
+  return Lease{*this, idx};
+}
+
+void ConnectionPool::release(Index idx) noexcept {
+  pg_pool_metrics().in_use.sub();
+  std::lock_guard<std::mutex> lock(m_free_mutex);
+  m_free_list.push_back(idx);
+  m_free_cv.notify_one();
+}
+
+/**
+ * Only the lease holder touches its slot, no locking needed. A reopened
+ * connection starts with no prepared statements.
+ */
+ConnectionPool::Slot &ConnectionPool::open_slot(Index idx) {
+  auto &slot = m_slots[idx];
+  if (!slot.conn || !slot.conn->is_open()) {
+    slot.prepared.clear();
+    slot.conn = std::make_unique<pqxx::connection>(m_conninfo);
+  }
+  return slot;
+}
+
+} // namespace quarry
@@ -1,26 +1,56 @@
 
 
 #include "db/migration.h"
+#include "db/connection_pool.h"
+#include "db/sql_pipeline.h"
 #include "logging.h"
+#include <chrono>
+#include <format>
 #include <fstream>
-#include <memory>
 #include <pqxx/pqxx>
 #include <regex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace quarry {
 
-Migration::Migration() {
-  m_conn = std::make_unique<pqxx::connection>(
-      "host=localhost port=5432 dbname=marble user=user password=password");
-  setup_migration_table();
-};
+namespace {
+std::string month_start_iso(std::chrono::year_month month) {
+  return std::format("{:04}-{:02}-01", static_cast<int>(month.year()),
+                     static_cast<unsigned>(month.month()));
+}
 
-void Migration::apply_migrations(int last_applied_version) {
-  file_map files_to_apply = get_files_to_apply(last_applied_version);
+void throw_on_failure(const std::vector<PipelineResult> &results,
+                      std::string_view what) {
+  for (const auto &result : results) {
+    if (!result.ok()) {
+      throw std::runtime_error(std::format("{} failed: {}", what,
+                                           result.error()));
+    }
+  }
+}
+
+std::chrono::year_month current_month() {
+  const auto today = std::chrono::floor<std::chrono::days>(
+      std::chrono::system_clock::now());
+  const std::chrono::year_month_day ymd{today};
+  return ymd.year() / ymd.month();
+}
+} // namespace
 
-  for (const auto &[version, path] : files_to_apply) {
+Migration::Migration() { setup_migration_table(); };
+
+/**
+ * Every pending script and its schema_migrations row commit together. The
+ * rows go out pipelined right after BEGIN, one round trip however many there
+ * are; the scripts, many statements each, then run inside that transaction.
+ */
+void Migration::apply_migrations(int last_applied_version) {
+  std::vector<std::pair<int, std::string>> scripts;
+  for (const auto &[version, path] : get_files_to_apply(last_applied_version)) {
     std::ifstream sql_file(path);
     if (!sql_file.is_open()) {
       auto *logger = quarry::logging::get_logger();
@@ -30,11 +60,29 @@ void Migration::apply_migrations(int last_applied_version) {
 
     std::stringstream buffer;
     buffer << sql_file.rdbuf();
-    std::string sql_content = buffer.str();
+    scripts.emplace_back(version, buffer.str());
+  }
+  if (scripts.empty()) {
+    return;
+  }
 
-    execute_script(sql_content);
-    execute("INSERT INTO schema_migrations (version) VALUES ($1)", version);
-    auto *logger = quarry::logging::get_logger();
+  auto lease = m_connections.acquire();
+  SqlPipeline pipeline(lease);
+  pipeline.push("BEGIN");
+  for (const auto &[version, script] : scripts) {
+    pipeline.push("INSERT INTO schema_migrations (version) VALUES ($1)",
+                  {std::to_string(version)});
+  }
+  throw_on_failure(pipeline.sync(), "migration bookkeeping");
+
+  for (const auto &[version, script] : scripts) {
+    pipeline.run_script(script);
+  }
+  pipeline.push("COMMIT");
+  throw_on_failure(pipeline.sync(), "migration commit");
+
+  auto *logger = quarry::logging::get_logger();
+  for (const auto &[version, script] : scripts) {
     LOG_INFO(logger, "Applied Migration {}", version);
   }
 }
@@ -51,18 +99,59 @@ void Migration::setup_migration_table() {
 
 pqxx::result Migration::execute(std::string_view mig_script,
                                 const pqxx::params &p) {
-  pqxx::work write_tsx(*m_conn);
+  auto lease = m_connections.acquire();
+  pqxx::work write_tsx(lease.conn());
   pqxx::result result = write_tsx.exec(mig_script, p);
   write_tsx.commit();
   return result;
 }
 
 void Migration::execute_script(std::string_view sql_script) {
-  pqxx::work txn(*m_conn);
+  auto lease = m_connections.acquire();
+  pqxx::work txn(lease.conn());
   txn.exec(std::string{sql_script}).no_rows();
   txn.commit();
 }
 
+/**
+ * All months go out as one pipelined batch, a single round trip and a single
+ * implicit transaction however wide the range is.
+ */
+void Migration::create_partitions(std::chrono::year_month from,
+                                  std::chrono::year_month to) {
+  auto lease = m_connections.acquire();
+  SqlPipeline pipeline(lease);
+  for (auto month = from; month <= to; month += std::chrono::months{1}) {
+    pipeline.push(statements::create_partition, month_start_iso(month));
+  }
+
+  throw_on_failure(pipeline.sync(), "partition creation");
+}
+
+int Migration::drop_partitions_before(std::chrono::year_month cutoff) {
+  pqxx::result dropped =
+      execute("SELECT drop_aggregate_bar_partitions_before($1::date);",
+              pqxx::params{month_start_iso(cutoff)});
+  return dropped.one_field().as<int>();
+}
+
+/**
+ * Keeps partitions pre-created around the current month so ingest never lands
+ * in the default partition, and applies retention when configured.
+ */
+void Migration::maintain_partitions(const PartitionPolicy &policy) {
+  const auto now = current_month();
+  create_partitions(now - std::chrono::months{policy.months_behind},
+                    now + std::chrono::months{policy.months_ahead});
+
+  if (policy.retention_months.has_value()) {
+    const int dropped = drop_partitions_before(
+        now - std::chrono::months{*policy.retention_months});
+    auto *logger = quarry::logging::get_logger();
+    LOG_INFO(logger, "Dropped {} expired aggregate partitions", dropped);
+  }
+}
+
 int Migration::get_last_applied_version() {
   pqxx::result select = execute("SELECT version FROM schema_migrations;");
   int latest_resolved = 0;
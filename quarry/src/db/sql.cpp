@@ -1,46 +1,136 @@
 #include "sql.h"
+#include <format>
+#include <stdexcept>
 
 namespace quarry {
+// NOLINTNEXTLINE
+constexpr std::size_t DEFAULT_PG_POOL_SIZE = 8;
 
-std::unique_ptr<pqxx::connection> &Sql::get_connection() {
-  static std::unique_ptr<pqxx::connection> m_conn;
-  if (!m_conn) {
-    m_conn = std::make_unique<pqxx::connection>(
-        "host=localhost port=5432 dbname=marble user=user password=password");
-  }
-  return m_conn;
+namespace {
+// per connection, emptied by every commit; created on first use so a
+// connection that never writes back never has one
+constexpr std::string_view WRITE_BACK_STAGE_DDL =
+    "CREATE TEMP TABLE IF NOT EXISTS stg_write_back "
+    "(LIKE stg_aggregates_results INCLUDING ALL) ON COMMIT DELETE ROWS";
+} // namespace
+
+ConnectionPool &Sql::pool() {
+  static ConnectionPool connections{DEFAULT_PG_POOL_SIZE};
+  return connections;
 }
 
 pqxx::result Sql::execute(std::string_view query) {
-  pqxx::work w(*get_connection());
+  auto lease = pool().acquire();
+  pqxx::work w(lease.conn());
   pqxx::result result = w.exec(query);
   w.commit();
   return result;
 }
 
+void Sql::batch(const std::function<void(SqlPipeline &)> &fill) {
+  auto lease = pool().acquire();
+  SqlPipeline pipeline(lease);
+  fill(pipeline);
+  for (const auto &result : pipeline.sync()) {
+    if (!result.ok()) {
+      throw std::runtime_error(
+          std::format("batch statement failed: {}", result.error()));
+    }
+  }
+}
+
 void Sql::normalize_staged_aggregates(
     std::string_view ticker, std::optional<std::string_view> request_id,
     std::optional<std::string_view> display_name,
-    std::optional<std::string_view> source) {
-  pqxx::work txn(*get_connection());
-  pqxx::params params;
-  params.append(std::string{ticker});
+    std::optional<std::string_view> source, timespan_options timespan) {
+  std::optional<std::string> request;
   if (request_id.has_value()) {
-    params.append(std::string{request_id.value()});
-  } else {
-    params.append();
+    request.emplace(*request_id);
   }
+  std::optional<std::string> name;
   if (display_name.has_value()) {
-    params.append(std::string{display_name.value()});
-  } else {
-    params.append();
+    name.emplace(*display_name);
+  }
+
+  exec(statements::normalize_aggregates, std::string{ticker}, request, name,
+       std::string{source.value_or("massive")},
+       std::string{timespan_resolver(timespan)});
+}
+
+BarColumns Sql::fetch_bars(const BarQuery &query) {
+  const pqxx::result rows =
+      exec(statements::bar_range, query.ticker,
+           std::string{timespan_resolver(query.timespan)}, query.from_ms,
+           query.to_ms);
+
+  BarColumns bars;
+  bars.reserve(static_cast<std::size_t>(rows.size()));
+  for (const auto &row : rows) {
+    auto [t, o, c, h, l, n, otc, v, vw] =
+        row.as<std::int64_t, double, double, double, double, std::int64_t,
+               bool, double, double>();
+    bars.push_back(ep::AggBar{
+        .o = o, .c = c, .h = h, .l = l, .n = n, .otc = otc, .t = t, .v = v,
+        .vw = vw});
+  }
+  return bars;
+}
+
+std::size_t Sql::read_bars(const BarQuery &query,
+                           const BarReader::chunk_callback &on_chunk,
+                           std::size_t chunk_rows) {
+  auto lease = pool().acquire();
+  BarReader reader(lease.conn(), chunk_rows);
+  return reader.read(query, on_chunk);
+}
+
+std::vector<DayRange> Sql::coverage(const std::string &ticker,
+                                    timespan_options timespan) {
+  const pqxx::result rows = exec(statements::bar_coverage, ticker,
+                                 std::string{timespan_resolver(timespan)});
+  std::vector<DayRange> covered;
+  covered.reserve(static_cast<std::size_t>(rows.size()));
+  for (const auto &row : rows) {
+    auto [from, to] = row.as<std::string, std::string>();
+    covered.push_back(DayRange{parse_iso_date(from), parse_iso_date(to)});
+  }
+  return covered;
+}
+
+void Sql::record_coverage(std::string_view ticker, timespan_options timespan,
+                          DayRange days) {
+  exec(statements::record_coverage, std::string{ticker},
+       std::string{timespan_resolver(timespan)}, to_iso_date(days.from),
+       to_iso_date(days.to));
+}
+
+void Sql::upsert_bars(std::string_view ticker, std::string_view request_id,
+                      timespan_options timespan,
+                      const std::vector<ep::AggBar> &bars,
+                      std::span<const DayRange> covered) {
+  const std::string ticker_id{ticker};
+  const std::string timespan_name{timespan_resolver(timespan)};
+
+  auto lease = pool().acquire();
+  lease.prepare(statements::merge_write_back.name,
+                statements::merge_write_back.sql);
+  lease.prepare(statements::record_coverage.name,
+                statements::record_coverage.sql);
+
+  pqxx::work txn(lease.conn());
+  if (!bars.empty()) {
+    txn.exec(WRITE_BACK_STAGE_DDL).no_rows();
+    stream_rows(txn, bars, "stg_write_back", ep::AggBar::col_names());
+    txn.exec(pqxx::prepped{statements::merge_write_back.name},
+             pqxx::params{ticker_id, std::string{request_id}, timespan_name})
+        .one_row();
   }
-  if (source.has_value()) {
-    params.append(std::string{source.value()});
-  } else {
-    params.append("massive");
+  for (const DayRange &days : covered) {
+    txn.exec(pqxx::prepped{statements::record_coverage.name},
+             pqxx::params{ticker_id, timespan_name, to_iso_date(days.from),
+                          to_iso_date(days.to)})
+        .one_row();
   }
-  txn.exec("SELECT normalize_aggregate_stage($1, $2, $3, $4);", params);
   txn.commit();
 }
 
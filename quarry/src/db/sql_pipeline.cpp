@@ -0,0 +1,212 @@
+#include "db/sql_pipeline.h"
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <poll.h>
+#include <stdexcept>
+#include <utility>
+
+namespace quarry {
+
+PipelineResult::PipelineResult(PGresult *result) : m_result(result) {}
+
+bool PipelineResult::ok() const noexcept {
+  const auto code = status();
+  return code == PGRES_COMMAND_OK || code == PGRES_TUPLES_OK;
+}
+
+ExecStatusType PipelineResult::status() const noexcept {
+  return PQresultStatus(m_result.get());
+}
+
+std::string_view PipelineResult::error() const noexcept {
+  return PQresultErrorMessage(m_result.get());
+}
+
+int PipelineResult::rows() const noexcept { return PQntuples(m_result.get()); }
+
+int PipelineResult::columns() const noexcept {
+  return PQnfields(m_result.get());
+}
+
+std::size_t PipelineResult::affected_rows() const {
+  const std::string_view tuples = PQcmdTuples(m_result.get());
+  std::size_t affected = 0;
+  std::from_chars(tuples.data(), tuples.data() + tuples.size(), affected);
+  return affected;
+}
+
+std::optional<std::string_view> PipelineResult::value(int row, int col) const {
+  if (PQgetisnull(m_result.get(), row, col) != 0) {
+    return std::nullopt;
+  }
+  return std::string_view{PQgetvalue(m_result.get(), row, col),
+                          static_cast<std::size_t>(
+                              PQgetlength(m_result.get(), row, col))};
+}
+
+SqlPipeline::SqlPipeline(ConnectionPool::Lease &lease)
+    : m_lease(lease), m_conn(lease.take_raw()) {
+  try {
+    pipeline_mode(true);
+  } catch (const std::exception &) {
+    PQfinish(m_conn);
+    m_lease.restore_raw(nullptr);
+    throw;
+  }
+}
+
+/**
+ * Unsynced statements may already be executing in the implicit transaction,
+ * a sync would commit them; closing the session is the only way to drop
+ * them. Anything else that leaves the session in doubt closes it too.
+ */
+SqlPipeline::~SqlPipeline() noexcept {
+  bool healthy = m_pending == 0;
+  if (healthy) {
+    try {
+      pipeline_mode(false);
+    } catch (const std::exception &) {
+      healthy = false;
+    }
+  }
+  if (healthy && PQtransactionStatus(m_conn) != PQTRANS_IDLE) {
+    PipelineResult rollback{PQexec(m_conn, "ROLLBACK")};
+    healthy = rollback.ok();
+  }
+
+  if (!healthy) {
+    PQfinish(m_conn);
+    m_conn = nullptr;
+  }
+  m_lease.restore_raw(m_conn);
+}
+
+void SqlPipeline::pipeline_mode(bool on) {
+  if (on) {
+    if (PQsetnonblocking(m_conn, 1) != 0 || PQenterPipelineMode(m_conn) != 1) {
+      throw std::runtime_error(std::format("pipeline mode unavailable: {}",
+                                           PQerrorMessage(m_conn)));
+    }
+    return;
+  }
+  if (PQexitPipelineMode(m_conn) != 1 || PQsetnonblocking(m_conn, 0) != 0) {
+    throw std::runtime_error(
+        std::format("pipeline exit failed: {}", PQerrorMessage(m_conn)));
+  }
+}
+
+/**
+ * Results already on the socket are read after every send, so the server's
+ * output buffer never fills while we are still writing.
+ */
+std::size_t SqlPipeline::push(std::string_view query,
+                              const std::vector<Param> &params) {
+  std::vector<const char *> values;
+  values.reserve(params.size());
+  for (const auto &param : params) {
+    values.push_back(param.has_value() ? param->c_str() : nullptr);
+  }
+
+  const int sent = PQsendQueryParams(
+      m_conn, std::string{query}.c_str(), static_cast<int>(values.size()),
+      nullptr, values.data(), nullptr, nullptr, 0);
+  if (sent != 1) {
+    throw std::runtime_error(
+        std::format("pipeline send failed: {}", PQerrorMessage(m_conn)));
+  }
+
+  flush();
+  collect();
+  return m_pending++;
+}
+
+std::vector<PipelineResult> SqlPipeline::sync() {
+  if (PQpipelineSync(m_conn) != 1) {
+    throw std::runtime_error(
+        std::format("pipeline sync failed: {}", PQerrorMessage(m_conn)));
+  }
+
+  bool unsent = flush();
+  while (!collect()) {
+    wait(unsent);
+    unsent = flush();
+  }
+
+  if (m_results.size() != m_pending) {
+    throw std::runtime_error(
+        std::format("pipeline lost results: {} of {}", m_results.size(),
+                    m_pending));
+  }
+  m_pending = 0;
+  return std::exchange(m_results, {});
+}
+
+void SqlPipeline::run_script(std::string_view script) {
+  if (m_pending != 0) {
+    throw std::logic_error("run_script with statements awaiting sync");
+  }
+
+  pipeline_mode(false);
+  // PQexec takes the simple protocol, which runs every statement in turn
+  PipelineResult result{PQexec(m_conn, std::string{script}.c_str())};
+  pipeline_mode(true);
+  if (!result.ok()) {
+    throw std::runtime_error(
+        std::format("pipeline script failed: {}", result.error()));
+  }
+}
+
+bool SqlPipeline::flush() {
+  const int unsent = PQflush(m_conn);
+  if (unsent < 0) {
+    throw std::runtime_error(
+        std::format("pipeline flush failed: {}", PQerrorMessage(m_conn)));
+  }
+  return unsent == 1;
+}
+
+bool SqlPipeline::collect() {
+  if (PQconsumeInput(m_conn) != 1) {
+    throw std::runtime_error(
+        std::format("pipeline read failed: {}", PQerrorMessage(m_conn)));
+  }
+
+  while (PQisBusy(m_conn) == 0) {
+    PGresult *result = PQgetResult(m_conn);
+    if (result == nullptr) {
+      // each statement's results are terminated by a null result
+      if (!m_in_statement) {
+        return false;
+      }
+      m_in_statement = false;
+      continue;
+    }
+
+    if (PQresultStatus(result) == PGRES_PIPELINE_SYNC) {
+      PQclear(result);
+      return true;
+    }
+    if (m_in_statement) {
+      PQclear(result);
+    } else {
+      m_results.emplace_back(result);
+      m_in_statement = true;
+    }
+  }
+  return false;
+}
+
+void SqlPipeline::wait(bool writable) const {
+  pollfd fd{.fd = PQsocket(m_conn),
+            .events = static_cast<short>(POLLIN | (writable ? POLLOUT : 0)),
+            .revents = 0};
+  if (::poll(&fd, 1, -1) < 0 && errno != EINTR) {
+    throw std::runtime_error(
+        std::format("pipeline poll failed: {}", std::strerror(errno)));
+  }
+}
+
+} // namespace quarry
@@ -1,93 +1,788 @@
 #include "aggregates.h"
+#include "bars/bar_columns.h"
+#include "bars/decimate.h"
 #include "base_endpoint.h"
+#include "ingest/bounded_queue.h"
+#include "ingest/stage.h"
 #include "logging.h"
 #include "massive.h"
+#include "metrics/metrics_server.h"
+#include "metrics/registry.h"
+#include "serve/read_through.h"
+#include "serve/single_flight.h"
 #include "utils.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <quill/LogMacros.h>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include <google/protobuf/arena.h>
 #include <grpcpp/ext/proto_server_reflection_plugin.h>
 #include <grpcpp/grpcpp.h>
+#include <grpcpp/support/message_allocator.h>
 
 #include "aggregates.grpc.pb.h"
 
 namespace {
 using Aggregates = quarry::ep::Aggregates;
-using AggBar = quarry::ep::AggBar;
 
-class AggregatesServiceImpl final : public marble::AggregatesService::Service {
+// NOLINTNEXTLINE
+constexpr std::size_t FETCH_WORKERS = 16;
+// NOLINTNEXTLINE
+constexpr std::size_t MAX_QUEUED_FETCHES = 4096;
+// NOLINTNEXTLINE
+constexpr std::size_t STREAM_CHUNK_BARS = 2000;
+// NOLINTNEXTLINE
+constexpr std::size_t STREAM_BUFFERED_CHUNKS = 4;
+// NOLINTNEXTLINE
+constexpr std::size_t ARENA_INITIAL_BLOCK = 1 << 20;
+// NOLINTNEXTLINE
+constexpr std::size_t ARENA_POOLED_HOLDERS = 64;
+// NOLINTNEXTLINE
+constexpr std::chrono::seconds AGGREGATE_CACHE_TTL{5};
+// NOLINTNEXTLINE
+constexpr std::size_t AGGREGATE_CACHE_ENTRIES = 256;
+// NOLINTNEXTLINE
+constexpr std::size_t WRITE_BACK_QUEUE_DEPTH = 32;
+// NOLINTNEXTLINE
+constexpr quarry::port_type METRICS_PORT = 9464;
 
+/**
+ * @brief Runs blocking Massive fetches off the gRPC callback threads.
+ *
+ * A thread-pool offload, not async I/O: the HTTP layer is synchronous, and
+ * each fetch (Postgres reads included) holds one worker until its last page
+ * is in. Upstream concurrency is therefore bounded by the worker count (and
+ * the TLS pool behind it). Requests beyond that wait in the queue holding no
+ * thread, and are refused once the queue is full.
+ *
+ * Rule of 5: non-copyable, non-movable (workers hold the queue).
+ */
+class FetchExecutor {
 public:
-  grpc::Status GetAggregate(grpc::ServerContext * /*unused*/,
-                            const marble::AggregatesRequest *request,
-                            marble::AggregatesResponse *response) override {
+  using Task = std::function<void()>;
 
-    if (request->ticker().empty()) {
-      return {grpc::StatusCode::INVALID_ARGUMENT, "ticker is required"};
+  FetchExecutor(std::size_t workers, std::size_t max_queued)
+      : m_tasks(max_queued), m_workers("grpc_fetch", workers, m_tasks,
+                                       [](Task &&task) {
+                                         task();
+                                         return std::size_t{1};
+                                       }) {}
+
+  FetchExecutor(FetchExecutor &&) noexcept = delete;
+  FetchExecutor &operator=(FetchExecutor &&) noexcept = delete;
+
+  FetchExecutor(const FetchExecutor &) = delete;
+  FetchExecutor &operator=(const FetchExecutor &) = delete;
+
+  ~FetchExecutor() noexcept { m_tasks.close(); }
+
+  /// @return false if the queue is full, `task` will never run
+  [[nodiscard]] bool submit(Task task) {
+    return m_tasks.try_push(std::move(task));
+  }
+
+private:
+  quarry::BoundedQueue<Task> m_tasks;
+  quarry::Stage<Task> m_workers;
+};
+
+/**
+ * @brief Builds GetAggregate request/response pairs on pooled protobuf arenas.
+ *
+ * Each holder owns a pre-sized initial block, so a typical response (a few
+ * thousand bars) is carved out of memory allocated once instead of one
+ * malloc/free per AggregateBar. On release the arena is reset, keeping the
+ * initial block, and the holder goes back on the free list for the next
+ * request. At most `max_pooled` idle holders are kept.
+ *
+ * Rule of 5: non-copyable, non-movable (holders point back at the pool).
+ */
+class ArenaMessageAllocator final
+    : public grpc::MessageAllocator<marble::AggregatesRequest,
+                                    marble::AggregatesResponse> {
+public:
+  using Holder = grpc::MessageHolder<marble::AggregatesRequest,
+                                     marble::AggregatesResponse>;
+
+  ArenaMessageAllocator(std::size_t initial_block, std::size_t max_pooled)
+      : m_initial_block(initial_block), m_max_pooled(max_pooled) {
+    m_free.reserve(m_max_pooled);
+  }
+
+  ArenaMessageAllocator(ArenaMessageAllocator &&) noexcept = delete;
+  ArenaMessageAllocator &operator=(ArenaMessageAllocator &&) noexcept = delete;
+
+  ArenaMessageAllocator(const ArenaMessageAllocator &) = delete;
+  ArenaMessageAllocator &operator=(const ArenaMessageAllocator &) = delete;
+
+  ~ArenaMessageAllocator() noexcept override = default;
+
+  Holder *AllocateMessages() override {
+    std::unique_ptr<ArenaHolder> holder;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_free.empty()) {
+        holder = std::move(m_free.back());
+        m_free.pop_back();
+      }
     }
-    if (request->from_date().empty() || request->to_date().empty()) {
-      return {grpc::StatusCode::INVALID_ARGUMENT,
-              "from_date and to_date are required"};
+    if (!holder) {
+      holder = std::make_unique<ArenaHolder>(*this, m_initial_block);
     }
+    holder->reset_messages();
+    return holder.release();
+  }
 
-    try {
-      auto aggregate_ep =
-          Aggregates::with_ticker(request->ticker())
-              .time_span(quarry::timespan_resolver(request->time_span()))
-              .from_date(request->from_date())
-              .to_date(request->to_date());
+private:
+  class ArenaHolder final : public Holder {
+  public:
+    ArenaHolder(ArenaMessageAllocator &pool, std::size_t initial_block)
+        : m_pool(pool),
+          m_block(std::make_unique_for_overwrite<char[]>(initial_block)),
+          m_arena(arena_options(m_block.get(), initial_block)) {}
+
+    /// fresh messages on the (reset) arena
+    void reset_messages() {
+      set_request(google::protobuf::Arena::Create<marble::AggregatesRequest>(
+          &m_arena));
+      set_response(google::protobuf::Arena::Create<marble::AggregatesResponse>(
+          &m_arena));
+    }
+
+    void Release() override {
+      // frees everything past the initial block, messages included
+      m_arena.Reset();
+      m_pool.recycle(std::unique_ptr<ArenaHolder>{this});
+    }
+
+  private:
+    ArenaMessageAllocator &m_pool;
+    std::unique_ptr<char[]> m_block;
+    google::protobuf::Arena m_arena;
+
+    static google::protobuf::ArenaOptions arena_options(char *block,
+                                                        std::size_t size) {
+      google::protobuf::ArenaOptions options;
+      options.initial_block = block;
+      options.initial_block_size = size;
+      // grow in large steps once a response outgrows the initial block
+      options.max_block_size = size;
+      return options;
+    }
+  };
+
+  std::size_t m_initial_block;
+  std::size_t m_max_pooled;
+  std::mutex m_mutex;
+  std::vector<std::unique_ptr<ArenaHolder>> m_free;
+
+  void recycle(std::unique_ptr<ArenaHolder> holder) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_free.size() < m_max_pooled) {
+      m_free.push_back(std::move(holder));
+    }
+  }
+};
+
+grpc::Status validate(const marble::AggregatesRequest &request) {
+  if (request.ticker().empty()) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, "ticker is required"};
+  }
+  if (request.from_date().empty() || request.to_date().empty()) {
+    return {grpc::StatusCode::INVALID_ARGUMENT,
+            "from_date and to_date are required"};
+  }
+  return grpc::Status::OK;
+}
+
+Aggregates make_endpoint(const marble::AggregatesRequest &request) {
+  return Aggregates::with_ticker(request.ticker())
+      .time_span(quarry::timespan_resolver(request.time_span()))
+      .multiplier(request.multiplier())
+      .adjusted(!request.has_adjusted() || request.adjusted())
+      .from_date(request.from_date())
+      .to_date(request.to_date());
+}
+
+/// everything that changes which bars upstream returns
+struct AggregateKey {
+  std::string ticker;
+  std::string from_date;
+  std::string to_date;
+  int time_span;
+  unsigned int multiplier;
+  bool adjusted;
+
+  bool operator==(const AggregateKey &) const = default;
+
+  static AggregateKey of(const marble::AggregatesRequest &request) {
+    return {.ticker = request.ticker(),
+            .from_date = request.from_date(),
+            .to_date = request.to_date(),
+            .time_span = request.time_span(),
+            .multiplier = request.multiplier() == 0 ? 1U : request.multiplier(),
+            .adjusted = !request.has_adjusted() || request.adjusted()};
+  }
+};
+
+struct AggregateKeyHasher {
+  auto operator()(const AggregateKey &key) const -> size_t {
+    std::size_t seed = std::hash<std::string>{}(key.ticker);
+    auto combine = [&seed](std::size_t value) {
+      seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6U) + (seed >> 2U);
+    };
+    combine(std::hash<std::string>{}(key.from_date));
+    combine(std::hash<std::string>{}(key.to_date));
+    combine(std::hash<int>{}(key.time_span));
+    combine(std::hash<unsigned int>{}(key.multiplier));
+    combine(std::hash<bool>{}(key.adjusted));
+    return seed;
+  }
+};
+
+using AggregateFlight =
+    quarry::SingleFlight<AggregateKey, quarry::BarFetch, AggregateKeyHasher>;
+
+void append_bars(const quarry::BarColumns &bars,
+                 marble::AggregatesResponse &response) {
+  auto *proto_bars = response.mutable_aggregate_bars();
+  proto_bars->Reserve(proto_bars->size() + static_cast<int>(bars.size()));
+  for (std::size_t i = 0; i < bars.size(); ++i) {
+    auto *proto_bar = proto_bars->Add();
+    proto_bar->set_open(bars.o[i]);
+    proto_bar->set_close(bars.c[i]);
+    proto_bar->set_high(bars.h[i]);
+    proto_bar->set_low(bars.l[i]);
+    proto_bar->set_n(bars.n[i]);
+    proto_bar->set_otc(bars.otc[i] != 0);
+    proto_bar->set_t(bars.t[i]);
+    proto_bar->set_volume(bars.v[i]);
+    proto_bar->set_volume_weighted(bars.vw[i]);
+  }
+}
+
+/// column to column copies; t_delta starts from zero in every message
+void append_columns(const quarry::BarColumns &bars,
+                    marble::AggregateBarColumns &columns) {
+  auto copy = [](const auto &from, auto *to) {
+    to->Reserve(to->size() + static_cast<int>(from.size()));
+    to->Add(from.begin(), from.end());
+  };
+  copy(bars.o, columns.mutable_open());
+  copy(bars.c, columns.mutable_close());
+  copy(bars.h, columns.mutable_high());
+  copy(bars.l, columns.mutable_low());
+  copy(bars.n, columns.mutable_n());
+  copy(bars.otc, columns.mutable_otc());
+  copy(bars.v, columns.mutable_volume());
+  copy(bars.vw, columns.mutable_volume_weighted());
+
+  auto *t_delta = columns.mutable_t_delta();
+  t_delta->Reserve(t_delta->size() + static_cast<int>(bars.size()));
+  std::int64_t prev_t = 0;
+  for (const std::int64_t t : bars.t) {
+    t_delta->AddAlreadyReserved(t - prev_t);
+    prev_t = t;
+  }
+}
+
+void append_layout(const quarry::BarColumns &bars, bool columnar,
+                   marble::AggregatesResponse &response) {
+  if (columnar) {
+    append_columns(bars, *response.mutable_bar_columns());
+  } else {
+    append_bars(bars, response);
+  }
+}
+
+quarry::Decimation decimation_of(marble::decimation_options option) {
+  switch (option) {
+  case marble::LTTB:
+    return quarry::Decimation::lttb;
+  default:
+    return quarry::Decimation::ohlc_buckets;
+  }
+}
+
+grpc::Status status_of(const std::exception_ptr &error) {
+  try {
+    std::rethrow_exception(error);
+  } catch (const std::invalid_argument &ex) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, ex.what()};
+  } catch (const std::exception &ex) {
+    return {grpc::StatusCode::INTERNAL, ex.what()};
+  } catch (...) {
+    return {grpc::StatusCode::UNKNOWN, "unknown error"};
+  }
+}
+
+/**
+ * Copies the shared bars into this caller's response in the layout it asked
+ * for. Downsampling to max_points happens here, after the flight, so callers
+ * asking for different resolutions of the same range still share one fetch.
+ */
+grpc::Status fill_aggregates(const quarry::BarFetch &fetched,
+                             const marble::AggregatesRequest &request,
+                             marble::AggregatesResponse &response) {
+  try {
+    const quarry::BarColumns *bars = &fetched.bars;
+    // per handler thread, keeps its capacity across requests
+    thread_local quarry::BarColumns decimated;
+    if (request.max_points() != 0 && bars->size() > request.max_points()) {
+      quarry::decimate(*bars, request.max_points(),
+                       decimation_of(request.decimation()), decimated);
+      bars = &decimated;
+    }
+
+    append_layout(*bars, request.columnar(), response);
+
+    response.set_ticker(fetched.ticker);
+    response.set_query_count(-1); //@todo
+    response.set_request_id(fetched.request_id);
+    response.set_results_count(static_cast<int>(bars->size()));
+    response.set_source_count(static_cast<int>(fetched.bars.size()));
+    response.set_count(-1);
+    response.set_status("ok");
+    return grpc::Status::OK;
+  } catch (...) {
+    return status_of(std::current_exception());
+  }
+}
+
+std::string_view status_code_name(grpc::StatusCode code) {
+  switch (code) {
+  case grpc::StatusCode::OK:
+    return "OK";
+  case grpc::StatusCode::CANCELLED:
+    return "CANCELLED";
+  case grpc::StatusCode::INVALID_ARGUMENT:
+    return "INVALID_ARGUMENT";
+  case grpc::StatusCode::DEADLINE_EXCEEDED:
+    return "DEADLINE_EXCEEDED";
+  case grpc::StatusCode::NOT_FOUND:
+    return "NOT_FOUND";
+  case grpc::StatusCode::ALREADY_EXISTS:
+    return "ALREADY_EXISTS";
+  case grpc::StatusCode::PERMISSION_DENIED:
+    return "PERMISSION_DENIED";
+  case grpc::StatusCode::RESOURCE_EXHAUSTED:
+    return "RESOURCE_EXHAUSTED";
+  case grpc::StatusCode::FAILED_PRECONDITION:
+    return "FAILED_PRECONDITION";
+  case grpc::StatusCode::ABORTED:
+    return "ABORTED";
+  case grpc::StatusCode::OUT_OF_RANGE:
+    return "OUT_OF_RANGE";
+  case grpc::StatusCode::UNIMPLEMENTED:
+    return "UNIMPLEMENTED";
+  case grpc::StatusCode::INTERNAL:
+    return "INTERNAL";
+  case grpc::StatusCode::UNAVAILABLE:
+    return "UNAVAILABLE";
+  case grpc::StatusCode::DATA_LOSS:
+    return "DATA_LOSS";
+  case grpc::StatusCode::UNAUTHENTICATED:
+    return "UNAUTHENTICATED";
+  default:
+    return "UNKNOWN";
+  }
+}
+
+/**
+ * @brief In-flight gauge and latency histogram by status code for one method.
+ *
+ * The histogram for a code is looked up in the registry the first time that
+ * code is seen and cached, so recording never locks after warm-up.
+ *
+ * Rule of 5: non-copyable, non-movable (atomics).
+ */
+class RpcMetrics {
+public:
+  explicit RpcMetrics(std::string method)
+      : m_method(std::move(method)),
+        m_in_flight(quarry::metrics::Registry::global().gauge(
+            "quarry_rpc_in_flight", "RPCs started and not yet finished",
+            {{"method", m_method}})) {}
 
-      std::string last_request_id;
-      std::string last_ticker;
+  RpcMetrics(RpcMetrics &&) noexcept = delete;
+  RpcMetrics &operator=(RpcMetrics &&) noexcept = delete;
 
-      for (const auto &aggregate_bar_batch :
-           m_massive.execute_with_pagination(aggregate_ep)) {
+  RpcMetrics(const RpcMetrics &) = delete;
+  RpcMetrics &operator=(const RpcMetrics &) = delete;
 
-        if (!aggregate_bar_batch.results.has_value() ||
-            aggregate_bar_batch.results->empty()) {
-          continue;
+  ~RpcMetrics() noexcept = default;
+
+  /// @return the start time to hand back to `finished`
+  [[nodiscard]] std::chrono::steady_clock::time_point started() noexcept {
+    m_in_flight.add();
+    return std::chrono::steady_clock::now();
+  }
+
+  void finished(std::chrono::steady_clock::time_point start,
+                const grpc::Status &status) {
+    m_in_flight.sub();
+    duration(status.error_code())
+        .observe(std::chrono::steady_clock::now() - start);
+  }
+
+private:
+  // NOLINTNEXTLINE
+  static constexpr std::size_t CODES = 17;
+
+  std::string m_method;
+  quarry::metrics::Gauge &m_in_flight;
+  std::array<std::atomic<quarry::metrics::Histogram *>, CODES> m_by_code{};
+
+  quarry::metrics::Histogram &duration(grpc::StatusCode code) {
+    auto idx = static_cast<std::size_t>(code);
+    if (idx >= CODES) {
+      idx = static_cast<std::size_t>(grpc::StatusCode::UNKNOWN);
+      code = grpc::StatusCode::UNKNOWN;
+    }
+    auto *histogram = m_by_code[idx].load(std::memory_order_acquire);
+    if (histogram == nullptr) {
+      // racing first lookups get the same series back from the registry
+      histogram = &quarry::metrics::Registry::global().histogram(
+          "quarry_rpc_duration_seconds", "RPC latency by method and status",
+          {{"method", m_method},
+           {"code", std::string{status_code_name(code)}}});
+      m_by_code[idx].store(histogram, std::memory_order_release);
+    }
+    return *histogram;
+  }
+};
+
+/**
+ * @brief Streams bars to the client in fixed-size chunks.
+ *
+ * The bars come the way GetAggregate gets them: through the flight, so an
+ * identical in-flight request (unary or streamed) shares one read through,
+ * which serves what Postgres holds and fetches the rest upstream. The result
+ * is decimated to max_points if asked, then cut into chunks.
+ *
+ * A producer task on the FetchExecutor hands chunks over through a small
+ * buffer. Once the buffer is full the task parks: it returns its worker,
+ * keeping its offset, and OnWriteDone submits it again when a chunk has gone
+ * out. A slow reader holds no thread while it drains.
+ *
+ * Finish is called once, with no write outstanding and no producer task
+ * queued or running, and always outside the lock since OnDone deletes the
+ * reactor.
+ */
+class AggregatesStreamReactor final
+    : public grpc::ServerWriteReactor<marble::AggregatesResponse> {
+public:
+  AggregatesStreamReactor(quarry::ReadThrough &read_through,
+                          AggregateFlight &flight, FetchExecutor &executor,
+                          RpcMetrics &metrics,
+                          const marble::AggregatesRequest &request)
+      : m_read_through(read_through), m_flight(flight), m_executor(executor),
+        m_metrics(metrics), m_started(metrics.started()), m_request(request) {
+    if (auto status = validate(request); !status.ok()) {
+      finish(status);
+      return;
+    }
+    m_producing = true;
+    if (!m_executor.submit([this]() { produce(); })) {
+      finish({grpc::StatusCode::RESOURCE_EXHAUSTED,
+              "too many aggregate requests in flight"});
+    }
+  }
+
+  void OnWriteDone(bool ok) override {
+    const marble::AggregatesResponse *next = nullptr;
+    bool resume = false;
+    std::optional<grpc::Status> finish_status;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_chunks.pop_front();
+      m_writing = false;
+      if (!ok) {
+        m_cancelled = true;
+        m_chunks.clear();
+      }
+      if (!m_cancelled && !m_chunks.empty()) {
+        m_writing = true;
+        next = &m_chunks.front();
+      }
+      resume = !m_producing && !m_done && !m_cancelled;
+      m_producing = m_producing || resume;
+      finish_status = finishable();
+    }
+
+    if (next != nullptr) {
+      StartWrite(next);
+    }
+    if (resume && !m_executor.submit([this]() { produce(); })) {
+      complete({grpc::StatusCode::RESOURCE_EXHAUSTED,
+                "too many aggregate requests in flight"});
+    }
+    if (finish_status.has_value()) {
+      finish(*finish_status);
+    }
+  }
+
+  void OnCancel() override {
+    std::optional<grpc::Status> finish_status;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_cancelled = true;
+      // a parked producer has no task to notice, finish for it
+      finish_status = finishable();
+    }
+    if (finish_status.has_value()) {
+      finish(*finish_status);
+    }
+  }
+
+  void OnDone() override { delete this; }
+
+private:
+  enum class Enqueued : std::uint8_t { more, parked, cancelled };
+
+  quarry::ReadThrough &m_read_through;
+  AggregateFlight &m_flight;
+  FetchExecutor &m_executor;
+  RpcMetrics &m_metrics;
+  std::chrono::steady_clock::time_point m_started;
+  const marble::AggregatesRequest &m_request;
+
+  // producer-only, kept across parks; m_bars points into m_fetched or at
+  // m_decimated once the flight has landed
+  AggregateFlight::value_ptr m_fetched;
+  quarry::BarColumns m_decimated;
+  const quarry::BarColumns *m_bars = nullptr;
+  std::size_t m_offset = 0;
+  // scratch, reused for every chunk
+  quarry::BarColumns m_chunk_columns;
+
+  std::mutex m_mutex;
+  // front is the chunk being written while m_writing
+  std::deque<marble::AggregatesResponse> m_chunks;
+  bool m_writing = false;
+  // a producer task is queued or running
+  bool m_producing = false;
+  bool m_cancelled = false;
+  bool m_done = false;
+  bool m_finished = false;
+  grpc::Status m_status;
+
+  /**
+   * First run joins the flight and returns; its continuation lands the bars
+   * and resubmits, since the flight's other callers wait on that thread.
+   * Later runs go until the buffer fills, the bars run out or the call is
+   * cancelled.
+   */
+  void produce() {
+    try {
+      if (m_fetched == nullptr) {
+        m_flight.get(
+            AggregateKey::of(m_request),
+            [this]() {
+              return m_read_through.fetch(make_endpoint(m_request));
+            },
+            [this](AggregateFlight::value_ptr fetched,
+                   const std::exception_ptr &error) {
+              if (error) {
+                complete(status_of(error));
+                return;
+              }
+              m_fetched = std::move(fetched);
+              if (!m_executor.submit([this]() { produce(); })) {
+                complete({grpc::StatusCode::RESOURCE_EXHAUSTED,
+                          "too many aggregate requests in flight"});
+              }
+            });
+        return;
+      }
+
+      if (m_bars == nullptr) {
+        m_bars = &m_fetched->bars;
+        if (m_request.max_points() != 0 &&
+            m_bars->size() > m_request.max_points()) {
+          quarry::decimate(*m_bars, m_request.max_points(),
+                           decimation_of(m_request.decimation()),
+                           m_decimated);
+          m_bars = &m_decimated;
         }
+      }
 
-        const auto &bar_batch = *aggregate_bar_batch.results;
-        for (const auto &bar : bar_batch) {
-          auto *proto_bar = response->add_aggregate_bars();
-          proto_bar->set_open(bar.o);
-          proto_bar->set_close(bar.c);
-          proto_bar->set_high(bar.h);
-          proto_bar->set_low(bar.l);
-          proto_bar->set_n(bar.n);
-          proto_bar->set_otc(bar.otc);
-          proto_bar->set_t(bar.t);
-          proto_bar->set_volume(bar.v);
-          proto_bar->set_volume_weighted(bar.vw);
+      while (m_offset < m_bars->size()) {
+        const std::size_t end =
+            std::min(m_offset + STREAM_CHUNK_BARS, m_bars->size());
+        m_chunk_columns.clear();
+        for (std::size_t i = m_offset; i < end; ++i) {
+          m_chunk_columns.push_back(m_bars->bar(i));
         }
+        m_offset = end;
 
-        last_ticker = aggregate_bar_batch.ticker;
-        last_request_id = aggregate_bar_batch.request_id;
-      }
+        marble::AggregatesResponse chunk;
+        chunk.set_ticker(m_fetched->ticker);
+        chunk.set_request_id(m_fetched->request_id);
+        chunk.set_results_count(static_cast<int>(m_chunk_columns.size()));
+        chunk.set_source_count(static_cast<int>(m_fetched->bars.size()));
+        chunk.set_status("ok");
+        // every chunk decodes on its own, deltas restart from zero
+        append_layout(m_chunk_columns, m_request.columnar(), chunk);
 
-      response->set_ticker(last_ticker);
-      response->set_query_count(-1); //@todo
-      response->set_request_id(last_request_id);
-      response->set_results_count(-1);
-      response->set_count(-1);
-      response->set_status("ok");
-      return grpc::Status::OK;
+        switch (enqueue(std::move(chunk))) {
+        case Enqueued::more:
+          break;
+        case Enqueued::parked:
+          // OnWriteDone may already be resuming us on another worker
+          return;
+        case Enqueued::cancelled:
+          complete(grpc::Status::CANCELLED);
+          return;
+        }
+      }
+      complete(grpc::Status::OK);
     } catch (const std::invalid_argument &ex) {
-      return {grpc::StatusCode::INVALID_ARGUMENT, ex.what()};
+      complete({grpc::StatusCode::INVALID_ARGUMENT, ex.what()});
     } catch (const std::exception &ex) {
-      return {grpc::StatusCode::INTERNAL, ex.what()};
+      complete({grpc::StatusCode::INTERNAL, ex.what()});
     }
   }
-  explicit AggregatesServiceImpl(quarry::Massive &massive)
-      : m_massive(massive) {}
+
+  /// parks the producer once the buffer is full
+  Enqueued enqueue(marble::AggregatesResponse &&chunk) {
+    const marble::AggregatesResponse *next = nullptr;
+    bool parked = false;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_cancelled) {
+        return Enqueued::cancelled;
+      }
+      m_chunks.push_back(std::move(chunk));
+      if (!m_writing) {
+        m_writing = true;
+        next = &m_chunks.front();
+      }
+      parked = m_chunks.size() >= STREAM_BUFFERED_CHUNKS;
+      m_producing = !parked;
+    }
+
+    if (next != nullptr) {
+      StartWrite(next);
+    }
+    return parked ? Enqueued::parked : Enqueued::more;
+  }
+
+  void complete(grpc::Status status) {
+    std::optional<grpc::Status> finish_status;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_done = true;
+      m_producing = false;
+      m_status = std::move(status);
+      finish_status = finishable();
+    }
+    if (finish_status.has_value()) {
+      finish(*finish_status);
+    }
+  }
+
+  /// under the lock; @return the status to finish with, at most once
+  std::optional<grpc::Status> finishable() {
+    if (m_finished || m_writing || m_producing || !(m_done || m_cancelled)) {
+      return std::nullopt;
+    }
+    m_finished = true;
+    return m_cancelled ? grpc::Status::CANCELLED : m_status;
+  }
+
+  void finish(const grpc::Status &status) {
+    m_metrics.finished(m_started, status);
+    Finish(status);
+  }
+};
+
+class AggregatesServiceImpl final
+    : public marble::AggregatesService::CallbackService {
+
+public:
+  /**
+   * Returns straight away; the fetch blocks an executor thread instead of a
+   * gRPC one and finishes the reactor from there. Identical in-flight
+   * requests share one read through the flight, which serves what Postgres
+   * holds and fetches the rest upstream.
+   */
+  grpc::ServerUnaryReactor *
+  GetAggregate(grpc::CallbackServerContext *context,
+               const marble::AggregatesRequest *request,
+               marble::AggregatesResponse *response) override {
+    auto *reactor = context->DefaultReactor();
+    const auto started = m_get_metrics.started();
+    auto finish = [this, reactor, started](const grpc::Status &status) {
+      m_get_metrics.finished(started, status);
+      reactor->Finish(status);
+    };
+
+    if (auto status = validate(*request); !status.ok()) {
+      finish(status);
+      return reactor;
+    }
+
+    const bool queued =
+        m_executor.submit([this, context, request, response, finish]() {
+          if (context->IsCancelled()) {
+            finish(grpc::Status::CANCELLED);
+            return;
+          }
+          // a duplicate of an in-flight request returns at once; the leader
+          // finishes it from its own worker once the bars are in
+          m_flight.get(
+              AggregateKey::of(*request),
+              [this, request]() {
+                return m_read_through.fetch(make_endpoint(*request));
+              },
+              [request, response, finish](
+                  AggregateFlight::value_ptr fetched,
+                  const std::exception_ptr &error) {
+                finish(error ? status_of(error)
+                             : fill_aggregates(*fetched, *request, *response));
+              });
+        });
+
+    if (!queued) {
+      finish({grpc::StatusCode::RESOURCE_EXHAUSTED,
+              "too many aggregate requests in flight"});
+    }
+    return reactor;
+  }
+
+  grpc::ServerWriteReactor<marble::AggregatesResponse> *
+  StreamAggregates(grpc::CallbackServerContext * /*unused*/,
+                   const marble::AggregatesRequest *request) override {
+    return new AggregatesStreamReactor(m_read_through, m_flight, m_executor,
+                                       m_stream_metrics, *request);
+  }
+
+  AggregatesServiceImpl(quarry::ReadThrough &read_through,
+                        FetchExecutor &executor, AggregateFlight &flight)
+      : m_read_through(read_through), m_executor(executor), m_flight(flight) {}
 
 private:
-  quarry::Massive &m_massive;
+  quarry::ReadThrough &m_read_through;
+  FetchExecutor &m_executor;
+  AggregateFlight &m_flight;
+  RpcMetrics m_get_metrics{"GetAggregate"};
+  RpcMetrics m_stream_metrics{"StreamAggregates"};
 };
 
 } // namespace
@@ -108,16 +803,28 @@ int main(int argc, char **argv) {
   }
 
   quarry::Massive massive{api_key};
+  quarry::ReadThrough read_through{massive, WRITE_BACK_QUEUE_DEPTH};
+  FetchExecutor executor{FETCH_WORKERS, MAX_QUEUED_FETCHES};
+  ArenaMessageAllocator allocator{ARENA_INITIAL_BLOCK, ARENA_POOLED_HOLDERS};
+  AggregateFlight flight{AGGREGATE_CACHE_TTL, AGGREGATE_CACHE_ENTRIES};
 
   // grpc setup
   std::string server_address = "0.0.0.0:50051";
   if (argc > 1) {
     server_address = argv[1];
   }
+  quarry::port_type metrics_port = METRICS_PORT;
+  if (argc > 2) {
+    metrics_port = static_cast<quarry::port_type>(std::stoul(argv[2]));
+  }
+  quarry::metrics::MetricsServer metrics_server{
+      quarry::metrics::Registry::global(), metrics_port};
+  LOG_INFO(logger, "metrics on :{}/metrics", metrics_server.port());
 
   grpc::reflection::InitProtoReflectionServerBuilderPlugin();
 
-  AggregatesServiceImpl service{massive};
+  AggregatesServiceImpl service{read_through, executor, flight};
+  service.SetMessageAllocatorFor_GetAggregate(&allocator);
   grpc::ServerBuilder builder;
   builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
 
@@ -1,58 +1,230 @@
 #include "aggregates.h"
 #include "base_endpoint.h"
+#include "ingest/bounded_queue.h"
+#include "ingest/stage.h"
+#include "logging.h"
 #include "massive.h"
 #include "sql.h"
 #include "utils.h"
-#include <future>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
 #include <optional>
+#include <stdexcept>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
-int main() {
-  using Aggregates = quarry::ep::Aggregates;
-  using AggBar = quarry::ep::AggBar;
-  quarry::load_dotenv();
-  quarry::Massive massive(std::getenv("MASSIVE_API_KEY"));
+namespace {
+using Aggregates = quarry::ep::Aggregates;
+using AggBar = quarry::ep::AggBar;
+using AggregatesR = quarry::ep::AggregatesR;
 
-  auto aapl_daily_agg = Aggregates::with_ticker("AAPL")
-                            .time_span(quarry::timespan_options::DAY)
-                            .from_date("2025-01-01")
-                            .to_date("2025-01-05");
+/**
+ * Workers per stage and queue depth between stages. In-flight memory is
+ * bounded by roughly (queue depth + workers) pages per stage.
+ */
+struct IngestConfig {
+  std::size_t fetch_workers = 4;
+  std::size_t parse_workers = 2;
+  std::size_t copy_workers = 2;
+  std::size_t queue_depth = 8;
+  std::chrono::days window{30};
+};
+
+struct BarBatch {
+  std::vector<AggBar> bars;
+  std::string ticker;
+  std::string request_id;
+};
+
+/**
+ * Runs `on_exit` when it goes out of scope, however that happens.
+ *
+ * Rule of 5: non-copyable, non-movable.
+ */
+template <class F> class ScopeExit {
+public:
+  explicit ScopeExit(F on_exit) : m_on_exit(std::move(on_exit)) {}
+
+  ScopeExit(ScopeExit &&) noexcept = delete;
+  ScopeExit &operator=(ScopeExit &&) noexcept = delete;
+
+  ScopeExit(const ScopeExit &) = delete;
+  ScopeExit &operator=(const ScopeExit &) = delete;
+
+  ~ScopeExit() noexcept { m_on_exit(); }
 
+private:
+  F m_on_exit;
+};
+
+/**
+ * Splits the endpoint's date range into windows fetched independently, so
+ * the fetch stage has parallel work.
+ */
+std::vector<Aggregates> split_windows(const Aggregates &ep,
+                                      std::chrono::days window) {
+  const auto from = quarry::parse_iso_date(ep.m_from_date);
+  const auto to = quarry::parse_iso_date(ep.m_to_date);
+
+  std::vector<Aggregates> windows;
+  for (auto start = from; start <= to; start += window) {
+    const auto end = std::min(to, start + window - std::chrono::days{1});
+    auto part = ep;
+    part.m_from_date = quarry::to_iso_date(start);
+    part.m_to_date = quarry::to_iso_date(end);
+    windows.push_back(std::move(part));
+  }
+  return windows;
+}
+
+/**
+ * Creates the month partitions the endpoint's range falls in, in one batch.
+ * Backfills reach far outside the months bootstrap keeps ready, and rows
+ * parked in the default partition are scanned and moved again when their
+ * month is created later.
+ */
+void create_partitions(const Aggregates &ep) {
+  const std::chrono::year_month_day from{
+      quarry::parse_iso_date(ep.m_from_date)};
+  const std::chrono::year_month_day to{quarry::parse_iso_date(ep.m_to_date)};
+
+  quarry::Sql::batch([&](quarry::SqlPipeline &batch) {
+    for (auto month = from.year() / from.month();
+         month <= to.year() / to.month(); month += std::chrono::months{1}) {
+      batch.push(quarry::statements::create_partition,
+                 quarry::to_iso_date(
+                     std::chrono::sys_days{month / std::chrono::day{1}}));
+    }
+  });
+}
+
+/**
+ * fetch (HTTP pages) -> parse (glaze) -> copy (COPY into staging), each with
+ * fixed workers and a bounded queue in front, then one batch normalizing
+ * the staged rows and recording their coverage.
+ */
+void ingest(quarry::Massive &massive, const Aggregates &ep,
+            const IngestConfig &config) {
   const std::string table_name = "stg_aggregates_results";
 
-  std::vector<std::future<void>> futures;
+  // before any worker starts, a bad date throws with nothing to unwind
+  auto windows = split_windows(ep, config.window);
+  create_partitions(ep);
+
+  quarry::BoundedQueue<Aggregates> jobs{config.queue_depth};
+  quarry::BoundedQueue<std::string> pages{config.queue_depth};
+  quarry::BoundedQueue<BarBatch> batches{config.queue_depth};
+
+  std::mutex last_mutex;
   std::optional<std::string> last_request_id;
   std::string last_ticker;
-  bool staged_rows = false;
 
-  for (const auto &aggregate_bar_batch :
-       massive.execute_with_pagination(aapl_daily_agg)) {
-    if (!aggregate_bar_batch.results.has_value() ||
-        aggregate_bar_batch.results->empty()) {
-      continue;
+  {
+    quarry::Stage<BarBatch> copy_stage{
+        "copy", config.copy_workers, batches, [&](BarBatch &&batch) {
+          quarry::Sql::bulk_insert<AggBar, AggBar::n_cols()>(
+              batch.bars, table_name, AggBar::col_names());
+
+          std::lock_guard<std::mutex> lock(last_mutex);
+          last_ticker = std::move(batch.ticker);
+          last_request_id = std::move(batch.request_id);
+          return batch.bars.size();
+        }};
+
+    quarry::Stage<std::string> parse_stage{
+        "parse", config.parse_workers, pages,
+        [&](std::string &&body) -> std::size_t {
+          auto parsed = glz::read_json<AggregatesR>(body);
+          if (!parsed) {
+            throw std::runtime_error(glz::format_error(parsed, body));
+          }
+          if (!parsed->results.has_value() || parsed->results->empty()) {
+            return 0;
+          }
+
+          const std::size_t rows = parsed->results->size();
+          batches.push(BarBatch{.bars = std::move(*parsed->results),
+                                .ticker = std::move(parsed->ticker),
+                                .request_id = std::move(parsed->request_id)});
+          return rows;
+        },
+        [&]() { batches.close(); }};
+
+    quarry::Stage<Aggregates> fetch_stage{
+        "fetch", config.fetch_workers, jobs,
+        [&](Aggregates &&window) -> std::size_t {
+          std::size_t page_count = 0;
+          for (auto &&body : massive.fetch_pages(window)) {
+            pages.push(std::move(body));
+            ++page_count;
+          }
+          return page_count;
+        },
+        [&]() { pages.close(); }};
+
+    // destroyed before the stages: a throw below still closes every queue,
+    // so their destructors never join workers blocked on an open one
+    const ScopeExit close_queues{[&]() noexcept {
+      jobs.close();
+      pages.close();
+      batches.close();
+    }};
+
+    for (auto &window : windows) {
+      jobs.push(std::move(window));
     }
+    jobs.close();
 
-    const auto &bar_batch = *aggregate_bar_batch.results;
-    last_ticker = aggregate_bar_batch.ticker;
-    last_request_id = aggregate_bar_batch.request_id;
-    staged_rows = true;
+    fetch_stage.join();
+    parse_stage.join();
+    copy_stage.join();
 
-    futures.push_back(std::async(
-        std::launch::async, quarry::Sql::bulk_insert<AggBar, AggBar::n_cols()>,
-        bar_batch, table_name, AggBar::col_names()));
-  }
+    fetch_stage.log_report();
+    parse_stage.log_report();
+    copy_stage.log_report();
 
-  for (auto &fut : futures) {
-    fut.get();
+    if (fetch_stage.stats().errors + parse_stage.stats().errors +
+            copy_stage.stats().errors !=
+        0) {
+      auto *logger = quarry::logging::get_logger();
+      LOG_ERROR(logger, "Ingest incomplete, leaving rows staged for {}",
+                ep.m_ticker);
+      return;
+    }
   }
 
-  if (staged_rows && !last_ticker.empty()) {
-    std::optional<std::string_view> req_id_view = std::nullopt;
-    if (last_request_id.has_value()) {
-      req_id_view = std::string_view{*last_request_id};
+  const std::string timespan{quarry::timespan_resolver(ep.m_timespan)};
+  // one batch: the coverage commits only with the bars it vouches for
+  quarry::Sql::batch([&](quarry::SqlPipeline &batch) {
+    if (!last_ticker.empty()) {
+      batch.push(quarry::statements::normalize_aggregates, last_ticker,
+                 last_request_id, std::optional<std::string>{last_ticker},
+                 std::string{"massive"}, timespan);
     }
-    quarry::Sql::normalize_staged_aggregates(last_ticker, req_id_view,
-                                             std::string_view{last_ticker});
-  }
+
+    // every window landed, so the read-through path may serve the range;
+    // only multiplier 1 adjusted bars are what it stores
+    if (ep.m_multiplier == 1 && ep.m_adjusted) {
+      batch.push(quarry::statements::record_coverage, ep.m_ticker, timespan,
+                 ep.m_from_date, ep.m_to_date);
+    }
+  });
+}
+
+} // namespace
+
+int main() {
+  quarry::load_dotenv();
+  quarry::Massive massive(std::getenv("MASSIVE_API_KEY"));
+
+  auto aapl_daily_agg = Aggregates::with_ticker("AAPL")
+                            .time_span(quarry::timespan_options::DAY)
+                            .from_date("2025-01-01")
+                            .to_date("2025-01-05");
+
+  ingest(massive, aapl_daily_agg, IngestConfig{});
 }
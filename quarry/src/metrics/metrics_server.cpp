@@ -0,0 +1,110 @@
+#include "metrics/metrics_server.h"
+#include "logging.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <quill/LogMacros.h>
+#include <utility>
+
+namespace quarry::metrics {
+
+namespace {
+
+// NOLINTNEXTLINE
+constexpr std::chrono::seconds SCRAPE_TIMEOUT{10};
+
+/**
+ * @brief One request per connection, read and answered asynchronously.
+ *
+ * Every read and write runs under SCRAPE_TIMEOUT, so an idle or slow client
+ * only ever costs its own connection, never the io thread.
+ *
+ * Rule of zero: kept alive by the handlers through shared_from_this.
+ */
+class ScrapeSession : public std::enable_shared_from_this<ScrapeSession> {
+public:
+  ScrapeSession(tcp::socket socket, Registry &registry)
+      : m_stream(std::move(socket)), m_registry(registry) {}
+
+  void start() {
+    m_stream.expires_after(SCRAPE_TIMEOUT);
+    http::async_read(
+        m_stream, m_buffer, m_request,
+        [self = shared_from_this()](beast::error_code ec, std::size_t) {
+          if (!ec) {
+            self->respond();
+          }
+        });
+  }
+
+private:
+  beast::tcp_stream m_stream;
+  Registry &m_registry;
+  beast::flat_buffer m_buffer;
+  http::request<http::empty_body> m_request;
+  http::response<http::string_body> m_response;
+
+  void respond() {
+    m_response.version(m_request.version());
+    m_response.keep_alive(false);
+    if (m_request.method() == http::verb::get &&
+        m_request.target() == "/metrics") {
+      m_response.result(http::status::ok);
+      m_response.set(http::field::content_type,
+                     "text/plain; version=0.0.4; charset=utf-8");
+      m_response.body() = m_registry.render();
+    } else {
+      m_response.result(http::status::not_found);
+      m_response.set(http::field::content_type, "text/plain");
+      m_response.body() = "not found\n";
+    }
+    m_response.prepare_payload();
+
+    m_stream.expires_after(SCRAPE_TIMEOUT);
+    http::async_write(
+        m_stream, m_response,
+        [self = shared_from_this()](beast::error_code ec, std::size_t) {
+          if (ec) {
+            auto *logger = quarry::logging::get_logger();
+            LOG_WARNING(logger, "metrics scrape write failed: {}",
+                        ec.message());
+          }
+          self->m_stream.socket().shutdown(tcp::socket::shutdown_send, ec);
+        });
+  }
+};
+
+} // namespace
+
+MetricsServer::MetricsServer(Registry &registry, port_type port)
+    : m_registry(registry),
+      m_acceptor(m_ioc, tcp::endpoint{tcp::v4(), port}),
+      m_port(m_acceptor.local_endpoint().port()) {
+  accept();
+  m_thread = std::jthread([this]() { m_ioc.run(); });
+}
+
+MetricsServer::~MetricsServer() noexcept {
+  m_ioc.stop();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void MetricsServer::accept() {
+  m_acceptor.async_accept(
+      [this](beast::error_code ec, tcp::socket socket) {
+        if (!ec) {
+          serve(std::move(socket));
+        }
+        if (m_acceptor.is_open()) {
+          accept();
+        }
+      });
+}
+
+void MetricsServer::serve(tcp::socket socket) {
+  std::make_shared<ScrapeSession>(std::move(socket), m_registry)->start();
+}
+
+} // namespace quarry::metrics
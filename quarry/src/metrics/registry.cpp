@@ -0,0 +1,212 @@
+#include "metrics/registry.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+
+namespace quarry::metrics {
+
+namespace {
+// NOLINTNEXTLINE
+constexpr double NANOS = 1e9;
+
+void append_escaped(std::string &out, std::string_view value) {
+  for (const char ch : value) {
+    switch (ch) {
+    case '\\':
+      out += "\\\\";
+      break;
+    case '"':
+      out += "\\\"";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    default:
+      out += ch;
+    }
+  }
+}
+
+/// `k="v",k2="v2"`, also the series key within a family
+std::string render_labels(const Labels &labels) {
+  std::string out;
+  for (const auto &[key, value] : labels) {
+    if (!out.empty()) {
+      out += ',';
+    }
+    out += key;
+    out += "=\"";
+    append_escaped(out, value);
+    out += '"';
+  }
+  return out;
+}
+
+void append_sample(std::string &out, std::string_view name,
+                   std::string_view labels, std::string_view value) {
+  out += name;
+  if (!labels.empty()) {
+    out += '{';
+    out += labels;
+    out += '}';
+  }
+  out += ' ';
+  out += value;
+  out += '\n';
+}
+
+std::string with_le(std::string_view labels, std::string_view le) {
+  std::string out{labels};
+  if (!out.empty()) {
+    out += ',';
+  }
+  out += "le=\"";
+  out += le;
+  out += '"';
+  return out;
+}
+} // namespace
+
+Histogram::Histogram(std::span<const double> bounds)
+    : m_bounds(bounds.begin(), bounds.end()),
+      m_buckets(std::make_unique<std::atomic<std::uint64_t>[]>(bounds.size() +
+                                                               1)) {
+  if (!std::ranges::is_sorted(m_bounds)) {
+    throw std::invalid_argument("histogram bounds must be ascending");
+  }
+}
+
+void Histogram::observe(double value) noexcept {
+  // le is inclusive: the first bound >= value
+  const auto it = std::ranges::lower_bound(m_bounds, value);
+  const auto idx =
+      static_cast<std::size_t>(std::distance(m_bounds.begin(), it));
+  m_buckets[idx].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_sum_nanos.fetch_add(std::llround(value * NANOS),
+                        std::memory_order_relaxed);
+}
+
+double Histogram::sum() const noexcept {
+  return static_cast<double>(m_sum_nanos.load(std::memory_order_relaxed)) /
+         NANOS;
+}
+
+Registry &Registry::global() {
+  static Registry registry;
+  return registry;
+}
+
+std::size_t &Registry::series_slot(std::string_view name,
+                                   std::string_view help, Kind kind,
+                                   const Labels &labels, bool &created) {
+  auto family = m_families.find(name);
+  if (family == m_families.end()) {
+    family = m_families
+                 .emplace(std::string{name},
+                          Family{.kind = kind, .help = std::string{help}})
+                 .first;
+  } else if (family->second.kind != kind) {
+    throw std::logic_error(std::format(
+        "metric {} already registered with another type", name));
+  }
+
+  auto [series, inserted] =
+      family->second.series.try_emplace(render_labels(labels), 0);
+  created = inserted;
+  return series->second;
+}
+
+Counter &Registry::counter(std::string_view name, std::string_view help,
+                           const Labels &labels) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  bool created = false;
+  auto &slot = series_slot(name, help, Kind::counter, labels, created);
+  if (created) {
+    slot = m_counters.size();
+    m_counters.emplace_back();
+  }
+  return m_counters[slot];
+}
+
+Gauge &Registry::gauge(std::string_view name, std::string_view help,
+                       const Labels &labels) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  bool created = false;
+  auto &slot = series_slot(name, help, Kind::gauge, labels, created);
+  if (created) {
+    slot = m_gauges.size();
+    m_gauges.emplace_back();
+  }
+  return m_gauges[slot];
+}
+
+Histogram &Registry::histogram(std::string_view name, std::string_view help,
+                               const Labels &labels,
+                               std::span<const double> bounds) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  bool created = false;
+  auto &slot = series_slot(name, help, Kind::histogram, labels, created);
+  if (created) {
+    slot = m_histograms.size();
+    m_histograms.emplace_back(bounds);
+  }
+  return m_histograms[slot];
+}
+
+std::string Registry::render() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::string out;
+  out.reserve(m_families.size() * 256);
+
+  for (const auto &[name, family] : m_families) {
+    out += std::format("# HELP {} {}\n", name, family.help);
+
+    switch (family.kind) {
+    case Kind::counter:
+      out += std::format("# TYPE {} counter\n", name);
+      for (const auto &[labels, idx] : family.series) {
+        append_sample(out, name, labels,
+                      std::to_string(m_counters[idx].value()));
+      }
+      break;
+
+    case Kind::gauge:
+      out += std::format("# TYPE {} gauge\n", name);
+      for (const auto &[labels, idx] : family.series) {
+        append_sample(out, name, labels,
+                      std::to_string(m_gauges[idx].value()));
+      }
+      break;
+
+    case Kind::histogram:
+      out += std::format("# TYPE {} histogram\n", name);
+      for (const auto &[labels, idx] : family.series) {
+        const auto &histogram = m_histograms[idx];
+        const auto bounds = histogram.bounds();
+        const std::string bucket_name = name + "_bucket";
+
+        std::uint64_t cumulative = 0;
+        for (std::size_t i = 0; i < bounds.size(); ++i) {
+          cumulative += histogram.bucket(i);
+          append_sample(out, bucket_name,
+                        with_le(labels, std::format("{}", bounds[i])),
+                        std::to_string(cumulative));
+        }
+        cumulative += histogram.bucket(bounds.size());
+        append_sample(out, bucket_name, with_le(labels, "+Inf"),
+                      std::to_string(cumulative));
+        append_sample(out, name + "_sum", labels,
+                      std::format("{}", histogram.sum()));
+        append_sample(out, name + "_count", labels,
+                      std::to_string(cumulative));
+      }
+      break;
+    }
+  }
+  return out;
+}
+
+} // namespace quarry::metrics
@@ -0,0 +1,246 @@
+#include "serve/read_through.h"
+#include "bars/resample.h"
+#include "logging.h"
+#include "sql.h"
+#include <algorithm>
+#include <exception>
+#include <quill/LogMacros.h>
+#include <utility>
+
+namespace quarry {
+
+namespace {
+std::int64_t day_start_ms(std::chrono::sys_days day) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             day.time_since_epoch())
+      .count();
+}
+/// coarser than a minute bar, so buildable from stored ones
+bool resamplable(const ep::Aggregates &aggregate_ep) {
+  const auto timespan = aggregate_ep.m_timespan;
+  const bool coarser = timespan > timespan_options::MINUTE ||
+                       (timespan == timespan_options::MINUTE &&
+                        aggregate_ep.m_multiplier > 1);
+  return coarser && aggregate_ep.m_adjusted;
+}
+
+/// no bucket reaches past its exchange day (intraday ones restart at
+/// midnight), so day ranges resampled apart join without splitting a bar
+bool day_bounded(const ep::Aggregates &aggregate_ep) {
+  return aggregate_ep.m_timespan < timespan_options::DAY ||
+         (aggregate_ep.m_timespan == timespan_options::DAY &&
+          aggregate_ep.m_multiplier == 1);
+}
+
+bool spans(DayRange requested, std::span<const DayRange> covered) {
+  const ReadPlan plan = plan_read(requested, covered);
+  return plan.size() == 1 && plan.front().local;
+}
+} // namespace
+
+MsWindow exchange_window(DayRange days, const Session &session) {
+  const auto local_midnight = [&session](std::chrono::sys_days day) {
+    const std::int64_t ms = day_start_ms(day);
+    return ms - std::chrono::duration_cast<std::chrono::milliseconds>(
+                    session.offset_at(ms))
+                    .count();
+  };
+  return {.from_ms = local_midnight(days.from),
+          .to_ms = local_midnight(days.to + std::chrono::days{1}) - 1};
+}
+
+ReadPlan plan_read(DayRange requested, std::span<const DayRange> covered) {
+  ReadPlan plan;
+  if (requested.to < requested.from) {
+    return plan;
+  }
+
+  // first day not planned yet
+  auto next = requested.from;
+  for (const DayRange &stored : covered) {
+    if (stored.to < next) {
+      continue;
+    }
+    if (stored.from > requested.to) {
+      break;
+    }
+    if (next < stored.from) {
+      plan.push_back({.days = {next, stored.from - std::chrono::days{1}},
+                      .local = false});
+    }
+    const auto local_to = std::min(stored.to, requested.to);
+    plan.push_back(
+        {.days = {std::max(next, stored.from), local_to}, .local = true});
+    next = local_to + std::chrono::days{1};
+  }
+  if (next <= requested.to) {
+    plan.push_back({.days = {next, requested.to}, .local = false});
+  }
+  return plan;
+}
+
+ReadThrough::ReadThrough(Massive &massive, std::size_t write_back_depth)
+    : m_massive(massive), m_write_back_enabled(write_back_depth != 0),
+      m_write_backs(write_back_depth), m_writer("write_back", 1, m_write_backs,
+                                                &ReadThrough::write) {}
+
+ReadThrough::~ReadThrough() noexcept {
+  m_write_backs.close();
+  m_writer.join();
+}
+
+BarFetch ReadThrough::fetch(const ep::Aggregates &aggregate_ep) {
+  auto *logger = quarry::logging::get_logger();
+  const DayRange requested{parse_iso_date(aggregate_ep.m_from_date),
+                           parse_iso_date(aggregate_ep.m_to_date)};
+
+  BarFetch out;
+  out.ticker = aggregate_ep.m_ticker;
+
+  const bool storable =
+      aggregate_ep.m_multiplier == 1 && aggregate_ep.m_adjusted;
+  std::vector<DayRange> covered;
+  std::vector<DayRange> minute_days;
+  try {
+    if (storable) {
+      covered = Sql::coverage(aggregate_ep.m_ticker, aggregate_ep.m_timespan);
+    }
+    if (resamplable(aggregate_ep)) {
+      minute_days =
+          Sql::coverage(aggregate_ep.m_ticker, timespan_options::MINUTE);
+    }
+  } catch (const std::exception &ex) {
+    LOG_WARNING(logger, "Coverage lookup failed for {}, going upstream: {}",
+                aggregate_ep.m_ticker, ex.what());
+    fetch_remote(aggregate_ep, requested, out, nullptr);
+    return out;
+  }
+
+  // a bucket longer than a day can't be cut where one source hands over to
+  // the next, so those are resampled for the whole range or not at all
+  if (!day_bounded(aggregate_ep)) {
+    if (spans(requested, minute_days) && !spans(requested, covered)) {
+      covered.clear();
+    } else {
+      minute_days.clear();
+    }
+  }
+
+  // stored bars of this timespan first, then stored minute bars resampled,
+  // upstream for what's left; only the provider's own bars are written back
+  WriteBack write_back{.ticker = aggregate_ep.m_ticker,
+                       .timespan = aggregate_ep.m_timespan};
+  auto *sink =
+      storable && m_write_back_enabled ? &write_back.bars : nullptr;
+
+  for (const ReadSegment &segment : plan_read(requested, covered)) {
+    if (segment.local) {
+      if (!fetch_local(aggregate_ep, segment.days, out)) {
+        fetch_remote(aggregate_ep, segment.days, out, nullptr);
+      }
+      continue;
+    }
+    for (const ReadSegment &piece : plan_read(segment.days, minute_days)) {
+      if (piece.local && fetch_resampled(aggregate_ep, piece.days, out)) {
+        continue;
+      }
+      fetch_remote(aggregate_ep, piece.days, out, sink);
+      if (sink != nullptr) {
+        write_back.days.push_back(piece.days);
+      }
+    }
+  }
+
+  LOG_DEBUG(logger, "{} {}..{}: {} bars local, {} upstream",
+            aggregate_ep.m_ticker, aggregate_ep.m_from_date,
+            aggregate_ep.m_to_date, out.local_rows,
+            out.bars.size() - out.local_rows);
+
+  if (!write_back.days.empty()) {
+    const std::size_t written_rows = write_back.bars.size();
+    write_back.request_id = out.request_id;
+    if (!m_write_backs.try_push(std::move(write_back))) {
+      LOG_WARNING(logger, "Write-back queue full, dropping {} bars for {}",
+                  written_rows, aggregate_ep.m_ticker);
+    }
+  }
+  return out;
+}
+
+bool ReadThrough::fetch_local(const ep::Aggregates &aggregate_ep,
+                              DayRange days, BarFetch &out) {
+  try {
+    const MsWindow window = exchange_window(days);
+    const auto local =
+        Sql::fetch_bars(BarQuery{.ticker = aggregate_ep.m_ticker,
+                                 .from_ms = window.from_ms,
+                                 .to_ms = window.to_ms,
+                                 .timespan = aggregate_ep.m_timespan});
+    out.local_rows += local.size();
+    out.bars.append(local);
+    return true;
+  } catch (const std::exception &ex) {
+    LOG_WARNING(quarry::logging::get_logger(),
+                "Local read failed for {}, going upstream: {}",
+                aggregate_ep.m_ticker, ex.what());
+    return false;
+  }
+}
+
+bool ReadThrough::fetch_resampled(const ep::Aggregates &aggregate_ep,
+                                  DayRange days, BarFetch &out) {
+  auto *logger = quarry::logging::get_logger();
+  try {
+    const Session session;
+    const MsWindow window = exchange_window(days, session);
+    const auto fine =
+        Sql::fetch_bars(BarQuery{.ticker = aggregate_ep.m_ticker,
+                                 .from_ms = window.from_ms,
+                                 .to_ms = window.to_ms,
+                                 .timespan = timespan_options::MINUTE});
+
+    const BarColumns coarse = resample(fine, aggregate_ep.m_timespan,
+                                       aggregate_ep.m_multiplier, session);
+    out.local_rows += coarse.size();
+    out.bars.append(coarse);
+    LOG_DEBUG(logger, "{} {}..{}: {} {} bars from {} stored minute bars",
+              aggregate_ep.m_ticker, to_iso_date(days.from),
+              to_iso_date(days.to), coarse.size(),
+              timespan_resolver(aggregate_ep.m_timespan), fine.size());
+    return true;
+  } catch (const std::exception &ex) {
+    LOG_WARNING(logger, "Resampling failed for {}, going upstream: {}",
+                aggregate_ep.m_ticker, ex.what());
+    return false;
+  }
+}
+
+void ReadThrough::fetch_remote(const ep::Aggregates &aggregate_ep,
+                               DayRange days, BarFetch &out,
+                               std::vector<ep::AggBar> *written) {
+  auto part = aggregate_ep;
+  part.m_from_date = to_iso_date(days.from);
+  part.m_to_date = to_iso_date(days.to);
+
+  for (auto &&page : m_massive.execute_with_pagination(part)) {
+    if (!page.results.has_value() || page.results->empty()) {
+      continue;
+    }
+    for (const auto &bar : *page.results) {
+      out.bars.push_back(bar);
+    }
+    if (written != nullptr) {
+      written->insert(written->end(), page.results->begin(),
+                      page.results->end());
+    }
+    out.request_id = std::move(page.request_id);
+  }
+}
+
+std::size_t ReadThrough::write(WriteBack &&batch) {
+  Sql::upsert_bars(batch.ticker, batch.request_id, batch.timespan, batch.bars,
+                   batch.days);
+  return batch.bars.size();
+}
+
+} // namespace quarry
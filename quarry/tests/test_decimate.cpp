@@ -0,0 +1,89 @@
+#include "bars/decimate.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cstdint>
+
+namespace {
+// NOLINTNEXTLINE
+constexpr std::int64_t MINUTE_MS = 60'000;
+
+quarry::BarColumns minute_bars(std::size_t rows) {
+  quarry::BarColumns bars;
+  for (std::size_t i = 0; i < rows; ++i) {
+    const auto x = static_cast<double>(i);
+    bars.push_back({.o = 100.0 + x,
+                    .c = 100.5 + x,
+                    .h = 101.0 + x,
+                    .l = 99.0 + x,
+                    .n = 10,
+                    .otc = i == 3,
+                    .t = static_cast<std::int64_t>(i) * MINUTE_MS,
+                    .v = 1.0 + x,
+                    .vw = 100.0 + x});
+  }
+  return bars;
+}
+} // namespace
+
+TEST_CASE("decimate") {
+  quarry::BarColumns out;
+
+  SECTION("Fits already or disabled, copied as-is") {
+    const auto bars = minute_bars(10);
+    quarry::decimate(bars, 10, quarry::Decimation::ohlc_buckets, out);
+    REQUIRE(out.size() == 10);
+    quarry::decimate(bars, 0, quarry::Decimation::lttb, out);
+    REQUIRE(out.size() == 10);
+    REQUIRE(out.t == bars.t);
+  }
+
+  SECTION("OHLC buckets merge each run") {
+    const auto bars = minute_bars(10);
+    quarry::decimate(bars, 3, quarry::Decimation::ohlc_buckets, out);
+    // runs of 3, 3, 4 rows
+    REQUIRE(out.size() == 3);
+    REQUIRE(out.t ==
+            std::vector<std::int64_t>{0, 3 * MINUTE_MS, 6 * MINUTE_MS});
+    REQUIRE(out.o[0] == 100.0);
+    REQUIRE(out.c[0] == 102.5);
+    REQUIRE(out.h[0] == 103.0);
+    REQUIRE(out.l[0] == 99.0);
+    REQUIRE(out.n[0] == 30);
+    REQUIRE(out.v[0] == 6.0);
+    // (100*1 + 101*2 + 102*3) / 6
+    REQUIRE_THAT(out.vw[0], Catch::Matchers::WithinRel(608.0 / 6.0));
+    REQUIRE(out.otc == std::vector<std::uint8_t>{0, 1, 0});
+    REQUIRE(out.c[2] == 109.5);
+    REQUIRE(out.h[2] == 110.0);
+    REQUIRE(out.n[2] == 40);
+  }
+
+  SECTION("LTTB keeps real bars, first and last included") {
+    auto bars = minute_bars(100);
+    // a spike the line must not lose
+    bars.c[42] = 500.0;
+    quarry::decimate(bars, 10, quarry::Decimation::lttb, out);
+    REQUIRE(out.size() == 10);
+    REQUIRE(out.t.front() == 0);
+    REQUIRE(out.t.back() == 99 * MINUTE_MS);
+    bool spike = false;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+      const auto row = static_cast<std::size_t>(out.t[i] / MINUTE_MS);
+      REQUIRE(out.c[i] == bars.c[row]);
+      REQUIRE(out.o[i] == bars.o[row]);
+      spike = spike || row == 42;
+      if (i > 0) {
+        REQUIRE(out.t[i - 1] < out.t[i]);
+      }
+    }
+    REQUIRE(spike);
+  }
+
+  SECTION("LTTB with fewer than three points") {
+    const auto bars = minute_bars(5);
+    quarry::decimate(bars, 2, quarry::Decimation::lttb, out);
+    REQUIRE(out.t == std::vector<std::int64_t>{0, 4 * MINUTE_MS});
+    quarry::decimate(bars, 1, quarry::Decimation::lttb, out);
+    REQUIRE(out.t == std::vector<std::int64_t>{0});
+  }
+}
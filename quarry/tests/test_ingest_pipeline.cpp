@@ -0,0 +1,122 @@
+#include "ingest/bounded_queue.h"
+#include "ingest/stage.h"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("BoundedQueue") {
+  SECTION("Items come out in push order") {
+    quarry::BoundedQueue<int> queue{4};
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(queue.push(int{i}));
+    }
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(queue.pop() == i);
+    }
+  }
+
+  SECTION("Closed queue drains then reports empty") {
+    quarry::BoundedQueue<int> queue{2};
+    REQUIRE(queue.push(1));
+    queue.close();
+    REQUIRE_FALSE(queue.push(2));
+    REQUIRE(queue.pop() == 1);
+    REQUIRE_FALSE(queue.pop().has_value());
+  }
+
+  SECTION("try_push refuses instead of blocking when full") {
+    quarry::BoundedQueue<int> queue{1};
+    REQUIRE(queue.try_push(1));
+    REQUIRE_FALSE(queue.try_push(2));
+    REQUIRE(queue.pop() == 1);
+    REQUIRE(queue.try_push(3));
+  }
+
+  SECTION("Move-only items are moved through") {
+    quarry::BoundedQueue<std::unique_ptr<int>> queue{1};
+    REQUIRE(queue.push(std::make_unique<int>(7)));
+    auto item = queue.pop();
+    REQUIRE(item.has_value());
+    REQUIRE(**item == 7);
+  }
+
+  SECTION("Full queue blocks the producer until a pop") {
+    quarry::BoundedQueue<int> queue{1};
+    REQUIRE(queue.push(1));
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&]() {
+      queue.push(2);
+      pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE_FALSE(pushed.load());
+    REQUIRE(queue.pop() == 1);
+    producer.join();
+    REQUIRE(pushed.load());
+    REQUIRE(queue.pop() == 2);
+  }
+}
+
+TEST_CASE("Stage") {
+  SECTION("Chained stages process every item and close downstream") {
+    constexpr int item_count = 1000;
+    quarry::BoundedQueue<int> input{8};
+    quarry::BoundedQueue<int> doubled{8};
+    std::atomic<long> sum{0};
+
+    {
+      quarry::Stage<int> sink{"sink", 2, doubled, [&](int &&value) {
+                                sum += value;
+                                return std::size_t{1};
+                              }};
+      quarry::Stage<int> doubler{"double", 3, input,
+                                 [&](int &&value) {
+                                   doubled.push(value * 2);
+                                   return std::size_t{1};
+                                 },
+                                 [&]() { doubled.close(); }};
+
+      for (int i = 0; i < item_count; ++i) {
+        input.push(int{i});
+      }
+      input.close();
+
+      doubler.join();
+      sink.join();
+
+      REQUIRE(doubler.stats().items == item_count);
+      REQUIRE(sink.stats().rows == item_count);
+    }
+
+    std::vector<int> values(item_count);
+    std::iota(values.begin(), values.end(), 0);
+    REQUIRE(sum == 2L * std::accumulate(values.begin(), values.end(), 0L));
+  }
+
+  SECTION("Handler failures are counted without stopping the stage") {
+    quarry::BoundedQueue<int> input{4};
+    quarry::Stage<int> stage{"flaky", 1, input, [](int &&value) {
+                               if (value % 2 == 0) {
+                                 throw std::runtime_error("even");
+                               }
+                               return std::size_t{1};
+                             }};
+    for (int i = 0; i < 6; ++i) {
+      input.push(int{i});
+    }
+    input.close();
+    stage.join();
+
+    REQUIRE(stage.stats().items == 6);
+    REQUIRE(stage.stats().errors == 3);
+    REQUIRE(stage.stats().rows == 3);
+  }
+}
@@ -0,0 +1,64 @@
+#include "metrics/registry.h"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Metrics registry") {
+  quarry::metrics::Registry registry;
+
+  SECTION("Same name and labels give back the same series") {
+    auto &first = registry.counter("requests_total", "requests",
+                                   {{"method", "get"}});
+    auto &again = registry.counter("requests_total", "requests",
+                                   {{"method", "get"}});
+    auto &other = registry.counter("requests_total", "requests",
+                                   {{"method", "put"}});
+    REQUIRE(&first == &again);
+    REQUIRE(&first != &other);
+  }
+
+  SECTION("A name can't change type") {
+    registry.counter("things", "things");
+    REQUIRE_THROWS_AS(registry.gauge("things", "things"), std::logic_error);
+  }
+
+  SECTION("Concurrent increments are not lost") {
+    auto &counter = registry.counter("hits_total", "hits");
+    {
+      std::vector<std::jthread> threads;
+      for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counter]() {
+          for (int i = 0; i < 10000; ++i) {
+            counter.inc();
+          }
+        });
+      }
+    }
+    REQUIRE(counter.value() == 40000);
+  }
+
+  SECTION("Rendered in the Prometheus text format") {
+    registry.counter("hits_total", "Cache hits", {{"result", "a\"b"}}).inc(3);
+    registry.gauge("in_use", "Leased").set(2);
+    constexpr double bounds[] = {0.1, 1.0};
+    auto &latency = registry.histogram("latency_seconds", "Latency",
+                                       {{"method", "get"}}, bounds);
+    latency.observe(0.05);
+    latency.observe(0.1);
+    latency.observe(5.0);
+
+    const std::string text = registry.render();
+    REQUIRE(text.contains("# TYPE hits_total counter\n"));
+    REQUIRE(text.contains("hits_total{result=\"a\\\"b\"} 3\n"));
+    REQUIRE(text.contains("# TYPE in_use gauge\nin_use 2\n"));
+    REQUIRE(text.contains(
+        "latency_seconds_bucket{method=\"get\",le=\"0.1\"} 2\n"));
+    REQUIRE(text.contains(
+        "latency_seconds_bucket{method=\"get\",le=\"1\"} 2\n"));
+    REQUIRE(text.contains(
+        "latency_seconds_bucket{method=\"get\",le=\"+Inf\"} 3\n"));
+    REQUIRE(text.contains("latency_seconds_count{method=\"get\"} 3\n"));
+    REQUIRE(text.contains("latency_seconds_sum{method=\"get\"} 5.15\n"));
+  }
+}
@@ -0,0 +1,121 @@
+#include "serve/read_through.h"
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace {
+using namespace std::chrono;
+
+quarry::DayRange range(year_month_day from, year_month_day to) {
+  return {sys_days{from}, sys_days{to}};
+}
+
+quarry::ReadSegment local(quarry::DayRange days) {
+  return {.days = days, .local = true};
+}
+
+quarry::ReadSegment upstream(quarry::DayRange days) {
+  return {.days = days, .local = false};
+}
+} // namespace
+
+TEST_CASE("plan_read") {
+  const std::vector<quarry::DayRange> stored{
+      range(2025y / January / 10, 2025y / January / 20)};
+
+  SECTION("Nothing stored goes upstream whole") {
+    const auto requested = range(2025y / January / 1, 2025y / January / 5);
+    REQUIRE(quarry::plan_read(requested, {}) ==
+            quarry::ReadPlan{upstream(requested)});
+  }
+
+  SECTION("Fully covered stays local") {
+    const auto requested = range(2025y / January / 12, 2025y / January / 15);
+    REQUIRE(quarry::plan_read(requested, stored) ==
+            quarry::ReadPlan{local(requested)});
+  }
+
+  SECTION("Overhang on both sides is fetched around the stored span") {
+    const auto requested = range(2025y / January / 1, 2025y / January / 31);
+    REQUIRE(quarry::plan_read(requested, stored) ==
+            quarry::ReadPlan{
+                upstream(range(2025y / January / 1, 2025y / January / 9)),
+                local(stored.front()),
+                upstream(range(2025y / January / 21, 2025y / January / 31))});
+  }
+
+  SECTION("Gaps between stored intervals go upstream") {
+    // Feb 1-3 written back after Jan 10-20 leaves Jan 21-31 unstored
+    const std::vector<quarry::DayRange> disjoint{
+        stored.front(), range(2025y / February / 1, 2025y / February / 3)};
+
+    const auto gap = range(2025y / January / 21, 2025y / January / 31);
+    REQUIRE(quarry::plan_read(gap, disjoint) ==
+            quarry::ReadPlan{upstream(gap)});
+
+    const auto across = range(2025y / January / 15, 2025y / February / 2);
+    REQUIRE(quarry::plan_read(across, disjoint) ==
+            quarry::ReadPlan{
+                local(range(2025y / January / 15, 2025y / January / 20)),
+                upstream(gap),
+                local(range(2025y / February / 1, 2025y / February / 2))});
+  }
+
+  SECTION("Intervals outside the request are skipped") {
+    const std::vector<quarry::DayRange> around{
+        range(2024y / December / 1, 2024y / December / 5), stored.front(),
+        range(2025y / March / 1, 2025y / March / 5)};
+    const auto requested = range(2025y / January / 15, 2025y / January / 25);
+    REQUIRE(quarry::plan_read(requested, around) ==
+            quarry::ReadPlan{
+                local(range(2025y / January / 15, 2025y / January / 20)),
+                upstream(range(2025y / January / 21, 2025y / January / 25))});
+  }
+
+  SECTION("An inverted request plans nothing") {
+    const auto inverted = range(2025y / January / 5, 2025y / January / 1);
+    REQUIRE(quarry::plan_read(inverted, stored).empty());
+  }
+}
+
+TEST_CASE("exchange_window") {
+  // 2025-01-21 00:00 UTC
+  constexpr std::int64_t jan21_utc = 1'737'417'600'000;
+  constexpr std::int64_t hour_ms = 3'600'000;
+
+  SECTION("A stored span meets the upstream span after it") {
+    const std::vector<quarry::DayRange> stored{
+        range(2025y / January / 10, 2025y / January / 20)};
+    const auto plan = quarry::plan_read(
+        range(2025y / January / 15, 2025y / January / 25), stored);
+    REQUIRE(plan.size() == 2);
+
+    const auto kept = quarry::exchange_window(plan[0].days);
+    const auto fetched = quarry::exchange_window(plan[1].days);
+    // no gap and no overlap where the local read hands over to Massive
+    REQUIRE(kept.to_ms + 1 == fetched.from_ms);
+    // Jan 21 starts at 00:00 New York time, 05:00 UTC
+    REQUIRE(fetched.from_ms == jan21_utc + 5 * hour_ms);
+
+    // Jan 20 19:30 EST is past UTC midnight but still Jan 20's bar
+    const std::int64_t post_market = jan21_utc + 30 * 60'000;
+    REQUIRE(post_market >= kept.from_ms);
+    REQUIRE(post_market <= kept.to_ms);
+    REQUIRE(post_market < fetched.from_ms);
+  }
+
+  SECTION("Days across a DST switch keep their own midnights") {
+    // clocks went forward on 2025-03-09, New York midnight is 04:00 UTC after
+    const auto window =
+        quarry::exchange_window(range(2025y / March / 8, 2025y / March / 10));
+    REQUIRE(window.from_ms ==
+            duration_cast<milliseconds>(
+                (sys_days{2025y / March / 8} + 5h).time_since_epoch())
+                .count());
+    REQUIRE(window.to_ms + 1 ==
+            duration_cast<milliseconds>(
+                (sys_days{2025y / March / 11} + 4h).time_since_epoch())
+                .count());
+  }
+}
@@ -0,0 +1,173 @@
+#include "bars/resample.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+using namespace std::chrono;
+using quarry::timespan_options;
+
+std::int64_t utc(year_month_day day, int hour, int minute = 0) {
+  return duration_cast<milliseconds>(sys_days{day}.time_since_epoch() +
+                                     hours{hour} + minutes{minute})
+      .count();
+}
+
+quarry::BarColumns minute_bars(std::int64_t from_ms, std::size_t rows) {
+  quarry::BarColumns bars;
+  for (std::size_t i = 0; i < rows; ++i) {
+    const auto x = static_cast<double>(i);
+    bars.push_back({.o = 10.0 + x,
+                    .c = 10.5 + x,
+                    .h = 11.0 + x,
+                    .l = 9.0 + x,
+                    .n = 2,
+                    .otc = false,
+                    .t = from_ms + static_cast<std::int64_t>(i) * 60'000,
+                    .v = 1.0 + x,
+                    .vw = 10.0 + x});
+  }
+  return bars;
+}
+} // namespace
+
+TEST_CASE("Session offsets follow US daylight saving") {
+  const quarry::Session session;
+  REQUIRE(session.offset_at(utc(2024y / March / 10, 6, 59)) == -5h);
+  REQUIRE(session.offset_at(utc(2024y / March / 10, 7)) == -4h);
+  REQUIRE(session.offset_at(utc(2024y / November / 3, 5, 59)) == -4h);
+  REQUIRE(session.offset_at(utc(2024y / November / 3, 6)) == -5h);
+}
+
+TEST_CASE("Resampler buckets") {
+  SECTION("Five minute bars aggregate OHLCV and VWAP") {
+    const auto bars = minute_bars(utc(2024y / January / 2, 15), 7);
+    const auto out = quarry::resample(bars, timespan_options::MINUTE, 5);
+    REQUIRE(out.size() == 2);
+    REQUIRE(out.t[0] == utc(2024y / January / 2, 15));
+    REQUIRE(out.t[1] == utc(2024y / January / 2, 15, 5));
+    REQUIRE(out.o[0] == 10.0);
+    REQUIRE(out.c[0] == 14.5);
+    REQUIRE(out.h[0] == 15.0);
+    REQUIRE(out.l[0] == 9.0);
+    REQUIRE(out.v[0] == 15.0);
+    REQUIRE(out.n[0] == 10);
+    // sum(vw * v) / sum(v) = (10 + 22 + 36 + 52 + 70) / 15
+    REQUIRE_THAT(out.vw[0], Catch::Matchers::WithinRel(190.0 / 15.0));
+    REQUIRE(out.n[1] == 4);
+  }
+
+  SECTION("Regular hours start hour buckets at the open") {
+    const quarry::Session rth{.regular_hours_only = true};
+    quarry::Resampler resampler(timespan_options::HOUR, 1, rth);
+    // 09:30 and 10:29 EST share a bucket, 10:30 starts the next
+    REQUIRE(resampler.bucket_of(utc(2024y / January / 2, 14, 30)) ==
+            utc(2024y / January / 2, 14, 30));
+    REQUIRE(resampler.bucket_of(utc(2024y / January / 2, 15, 29)) ==
+            utc(2024y / January / 2, 14, 30));
+    REQUIRE(resampler.bucket_of(utc(2024y / January / 2, 15, 30)) ==
+            utc(2024y / January / 2, 15, 30));
+
+    // 08:00-10:59 EST, pre-market is dropped
+    const auto bars = minute_bars(utc(2024y / January / 2, 13), 180);
+    quarry::BarColumns out;
+    resampler.push(bars, out);
+    resampler.flush(out);
+    REQUIRE(out.size() == 2);
+    REQUIRE(out.t[0] == utc(2024y / January / 2, 14, 30));
+    REQUIRE(out.o[0] == bars.o[90]);
+    REQUIRE(out.t[1] == utc(2024y / January / 2, 15, 30));
+    REQUIRE(out.c[1] == bars.c[179]);
+  }
+
+  SECTION("Days are exchange days, not UTC days") {
+    const quarry::Resampler day(timespan_options::DAY, 1);
+    // 19:30 EST on Jan 1
+    REQUIRE(day.bucket_of(utc(2024y / January / 2, 0, 30)) ==
+            utc(2024y / January / 1, 5));
+    // 23:00 EDT on Jun 30
+    REQUIRE(day.bucket_of(utc(2024y / July / 1, 3)) ==
+            utc(2024y / June / 30, 4));
+  }
+
+  SECTION("Weeks start Sunday, months on the 1st across DST") {
+    const quarry::Resampler week(timespan_options::WEEK, 1);
+    REQUIRE(week.bucket_of(utc(2024y / January / 3, 15)) ==
+            utc(2023y / December / 31, 5));
+
+    const quarry::Resampler month(timespan_options::MONTH, 1);
+    REQUIRE(month.bucket_of(utc(2024y / March / 20, 15)) ==
+            utc(2024y / March / 1, 5));
+
+    const quarry::Resampler quarter(timespan_options::QUARTER, 1);
+    REQUIRE(quarter.bucket_of(utc(2024y / May / 15, 15)) ==
+            utc(2024y / April / 1, 4));
+
+    const quarry::Resampler year(timespan_options::YEAR, 1);
+    REQUIRE(year.bucket_of(utc(2024y / July / 1, 15)) ==
+            utc(2024y / January / 1, 5));
+  }
+
+  SECTION("Chunked pushes match one pass") {
+    const auto bars = minute_bars(utc(2024y / January / 2, 15), 100);
+    const auto whole = quarry::resample(bars, timespan_options::MINUTE, 15);
+
+    quarry::Resampler resampler(timespan_options::MINUTE, 15);
+    quarry::BarColumns chunked;
+    quarry::BarColumns chunk;
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+      chunk.push_back(bars.bar(i));
+      if (chunk.size() == 7) {
+        resampler.push(chunk, chunked);
+        chunk.clear();
+      }
+    }
+    resampler.push(chunk, chunked);
+    resampler.flush(chunked);
+
+    REQUIRE(chunked.t == whole.t);
+    REQUIRE(chunked.o == whole.o);
+    REQUIRE(chunked.c == whole.c);
+    REQUIRE(chunked.v == whole.v);
+    REQUIRE(chunked.n == whole.n);
+  }
+
+  SECTION("Nothing feeds SECOND bars") {
+    REQUIRE_THROWS_AS(quarry::Resampler(timespan_options::SECOND, 1),
+                      std::invalid_argument);
+  }
+}
+
+TEST_CASE("Resampler keys bars like bucket_of across DST and month ends") {
+  // minute bars over the March switch and the end of the month, pushed in
+  // uneven chunks
+  const auto from = utc(2024y / March / 8, 12);
+  const auto bars = minute_bars(from, 60 * 24 * 25);
+  for (const auto timespan :
+       {timespan_options::MINUTE, timespan_options::HOUR,
+        timespan_options::DAY, timespan_options::WEEK,
+        timespan_options::MONTH}) {
+    quarry::Resampler resampler(timespan, 7);
+    quarry::BarColumns out;
+    quarry::BarColumns chunk;
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+      chunk.push_back(bars.bar(i));
+      if (chunk.size() == 997) {
+        resampler.push(chunk, out);
+        chunk.clear();
+      }
+    }
+    resampler.push(chunk, out);
+    resampler.flush(out);
+
+    std::vector<std::int64_t> expected;
+    for (const auto t : bars.t) {
+      const auto key = resampler.bucket_of(t);
+      if (expected.empty() || expected.back() != key) {
+        expected.push_back(key);
+      }
+    }
+    REQUIRE(out.t == expected);
+  }
+}
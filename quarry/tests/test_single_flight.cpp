@@ -0,0 +1,121 @@
+#include "serve/single_flight.h"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <latch>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("SingleFlight") {
+  SECTION("Concurrent callers share one fetch") {
+    quarry::SingleFlight<std::string, int> flight{0s, 16};
+    std::atomic<int> fetches{0};
+    std::latch release{1};
+    constexpr std::size_t callers = 8;
+
+    std::vector<std::jthread> threads;
+    std::vector<int> results(callers, 0);
+    for (std::size_t i = 0; i < callers; ++i) {
+      threads.emplace_back([&, i]() {
+        results[i] = *flight.get("AAPL", [&]() {
+          ++fetches;
+          release.wait();
+          return 42;
+        });
+      });
+    }
+
+    while (flight.stats().joined.load() + flight.stats().misses.load() <
+           callers) {
+      std::this_thread::yield();
+    }
+    release.count_down();
+    threads.clear();
+
+    REQUIRE(fetches.load() == 1);
+    REQUIRE(flight.stats().joined.load() == callers - 1);
+    for (const int result : results) {
+      REQUIRE(result == 42);
+    }
+    // zero TTL caches nothing
+    REQUIRE(flight.size() == 0);
+  }
+
+  SECTION("Joined callers are answered from the leader's thread") {
+    quarry::SingleFlight<std::string, int> flight{0s, 16};
+    std::latch started{1};
+    std::latch release{1};
+
+    std::jthread leader([&]() {
+      flight.get("AAPL", [&]() {
+        started.count_down();
+        release.wait();
+        return 42;
+      });
+    });
+    started.wait();
+
+    int joined = 0;
+    std::exception_ptr joined_error;
+    std::thread::id answered_on;
+    // returns without waiting on the fetch still running in `leader`
+    flight.get(
+        "AAPL", []() { return -1; },
+        [&](auto value, const std::exception_ptr &error) {
+          joined_error = error;
+          joined = value ? *value : -1;
+          answered_on = std::this_thread::get_id();
+        });
+    REQUIRE(flight.stats().joined.load() == 1);
+    REQUIRE(joined == 0);
+
+    const auto leader_id = leader.get_id();
+    release.count_down();
+    leader.join();
+    REQUIRE_FALSE(joined_error);
+    REQUIRE(joined == 42);
+    REQUIRE(answered_on == leader_id);
+  }
+
+  SECTION("Results are reused until the TTL runs out") {
+    quarry::SingleFlight<std::string, int> flight{50ms, 16};
+    int fetches = 0;
+    auto fetch = [&]() { return ++fetches; };
+
+    REQUIRE(*flight.get("AAPL", fetch) == 1);
+    REQUIRE(*flight.get("AAPL", fetch) == 1);
+    REQUIRE(*flight.get("MSFT", fetch) == 2);
+    REQUIRE(flight.stats().hits.load() == 1);
+
+    std::this_thread::sleep_for(60ms);
+    REQUIRE(*flight.get("AAPL", fetch) == 3);
+  }
+
+  SECTION("Failures reach every caller and are not cached") {
+    quarry::SingleFlight<std::string, int> flight{1s, 16};
+    REQUIRE_THROWS_AS(
+        flight.get("AAPL", []() -> int { throw std::runtime_error("down"); }),
+        std::runtime_error);
+    REQUIRE(flight.size() == 0);
+    REQUIRE(*flight.get("AAPL", []() { return 7; }) == 7);
+  }
+
+  SECTION("A full cache stops keeping new results") {
+    quarry::SingleFlight<int, int> flight{1s, 2};
+    int fetches = 0;
+    auto fetch = [&]() { return ++fetches; };
+
+    flight.get(1, fetch);
+    flight.get(2, fetch);
+    flight.get(3, fetch);
+    REQUIRE(flight.size() == 2);
+    flight.get(3, fetch);
+    REQUIRE(fetches == 4);
+  }
+}